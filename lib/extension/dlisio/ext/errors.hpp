@@ -0,0 +1,98 @@
+#ifndef DLISIO_EXT_ERRORS_HPP
+#define DLISIO_EXT_ERRORS_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <dlisio/ext/types.hpp>
+
+namespace dl {
+
+/*
+ * An error handler that collects problems, rather than acting on them.
+ *
+ * Problems are de-duplicated, so a file with the same broken segment layout
+ * in every record gives a single entry with a count, and the offsets of the
+ * first few occurrences. Known problems (error_handler::report) are stored
+ * as their code and numbers, and are only rendered by problems(), so a file
+ * with a warning for every record costs a lookup and an increment per
+ * record. Problems passed to log() are stored as-is.
+ *
+ * Logged problems often include the offset of the record, so every record
+ * can give a distinct problem. Only the first max_problems distinct logged
+ * problems are kept, the rest are counted in a single entry per severity
+ * and context.
+ *
+ * Critical problems are still raised by default, like the default python
+ * ErrorHandler, after being recorded.
+ *
+ * The sink is safe to use from multiple threads.
+ */
+class error_sink : public error_handler {
+public:
+    explicit error_sink(bool raise_critical = true,
+                        std::size_t max_tells = 64,
+                        std::size_t max_problems = 1024) noexcept (true);
+
+    void log(const error_severity& level,
+             const std::string& context,
+             const std::string& problem,
+             const std::string& specification,
+             const std::string& action) const noexcept (false) override;
+
+    void report(const error_report&) const noexcept (false) override;
+
+    struct problem {
+        error_severity severity;
+        std::string context;
+        std::string problem;
+        std::string specification;
+        std::string action;
+        std::size_t count;
+        /* offsets of the first max_tells occurrences, if known */
+        std::vector< long long > tells;
+    };
+
+    /* all distinct problems, rendered, in the order they first happened */
+    std::vector< problem > problems() const noexcept (false);
+
+    /* number of distinct problems, and the total number of occurrences */
+    std::size_t size() const noexcept (true);
+    std::size_t count() const noexcept (true);
+
+    void clear() noexcept (true);
+
+private:
+    struct entry {
+        bool reported;
+        error_report first;    // if reported
+        std::string context;   // if logged
+        dlis_error error;      // if logged
+        std::size_t count;
+        std::vector< long long > tells;
+    };
+
+    void raise(const error_severity&,
+               const std::string& context,
+               const std::string& problem) const noexcept (false);
+
+    /* the entry at key, or a new entry made by make() */
+    template < typename Make >
+    entry& find(const std::string& key, Make make) const noexcept (false);
+
+    bool raise_critical;
+    std::size_t max_tells;
+    std::size_t max_problems;
+    mutable std::mutex lock;
+    mutable std::vector< entry > entries;
+    /* index of every entry in entries, by severity, context and problem */
+    mutable std::unordered_map< std::string, std::size_t > index;
+    mutable std::size_t logged = 0;
+};
+
+}
+
+#endif // DLISIO_EXT_ERRORS_HPP
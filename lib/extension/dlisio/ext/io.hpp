@@ -2,6 +2,8 @@
 #define DLISIO_PYTHON_IO_HPP
 
 #include <array>
+#include <limits>
+#include <memory>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -55,30 +57,352 @@ private:
 };
 
 
+/* In-memory visible records
+ *
+ * An rp66 file that is already in memory, e.g. mmap'd, is read without
+ * copying by indexing the visible records up-front. data must point to the
+ * first visible record of the logical file, and tells are the same as for a
+ * stream that is opened with open_rp66 at that visible record, so the
+ * offsets from findoffsets can be used with both.
+ *
+ * The bytes are not copied, and owner (if any) is handed to every
+ * record_view, to keep the source alive. Tapeimage files are not supported.
+ */
+class memory_file {
+public:
+    memory_file(const char* data,
+                std::size_t size,
+                std::shared_ptr< const void > owner = nullptr)
+    noexcept (false);
+
+    /*
+     * Pointer to the n bytes at tell, or nullptr if they are not contiguous
+     * (i.e. span a visible record header) or are out of range
+     */
+    const char* contiguous(long long tell, std::size_t n) const noexcept (true);
+
+    /* Copy up to n bytes at tell, return the number of bytes copied */
+    std::size_t read(long long tell, char* dst, std::size_t n)
+    const noexcept (true);
+
+    const std::shared_ptr< const void >& owner() const noexcept (true);
+
+private:
+    struct visible_record {
+        long long tell;
+        const char* begin;
+        std::size_t size;
+    };
+
+    std::vector< visible_record > vrs;
+    std::shared_ptr< const void > keepalive;
+
+    std::vector< visible_record >::const_iterator find(long long tell)
+    const noexcept (true);
+};
+
+/*
+ * Where the visible records of a logical file are in the raw file, i.e. the
+ * mapping from logical tells (like on a stream opened with open_rp66) to
+ * physical offsets. It is built for free by findoffsets on the raw file, and
+ * makes it possible to read any record without going through the rp66
+ * protocol, see batch_reader.
+ *
+ * Visible records are usually all of the same length, so consecutive
+ * records of the same length are stored as a single run, and a file of any
+ * size is a handful of runs. Empty visible records are not stored.
+ */
+class vr_index {
+public:
+    struct extent {
+        long long tell;     /* logical tell of the first byte */
+        long long offset;   /* physical offset of the first byte */
+        std::size_t size;
+    };
+
+    /*
+     * Add the visible record at offset (of the header), of length bytes
+     * (header included). Records must be added in file order, and records
+     * that are already indexed are ignored.
+     */
+    void append(long long offset, int length) noexcept (false);
+
+    /*
+     * Add the visible records of other with headers before until, as if they
+     * were added one by one
+     */
+    void append(const vr_index& other,
+                long long until = std::numeric_limits< long long >::max())
+    noexcept (false);
+
+    /* The body of the visible record that holds tell, false if none does */
+    bool find(long long tell, extent& vr) const noexcept (true);
+
+    /* The number of visible records, and the logical tell of the end */
+    std::size_t size() const noexcept (true);
+    long long end() const noexcept (true);
+
+private:
+    struct run {
+        long long tell;
+        long long offset;   /* of the first header */
+        int length;
+        long long count;
+    };
+
+    std::vector< run > runs;
+};
+
 struct stream_offsets {
     std::vector< long long > explicits;
     std::vector< long long > implicits;
     std::vector< long long > broken;
+    /*
+     * Records with at least one segment that failed checksum verification.
+     * Only populated when findoffsets is asked to verify checksums
+     */
+    std::vector< long long > corrupt;
 };
 
 stream open(const std::string&, std::int64_t) noexcept (false);
+
+/*
+ * Open a file that is already in memory, e.g. fetched from object storage,
+ * like open. The bytes are read in-place and not copied, so they must outlive
+ * the stream, and all streams opened on top of it (open_rp66 and
+ * open_tapeimage). On platforms without fmemopen (Windows and macOS), the
+ * bytes are copied.
+ */
+stream open_memory(const char* data, std::size_t size, std::int64_t offset = 0)
+noexcept (false);
+
 stream open_rp66(const stream&) noexcept (false);
 stream open_tapeimage(const stream&) noexcept (false);
 
 long long findsul(stream&) noexcept (false);
 long long findvrl(stream&, long long) noexcept (false);
+
+/*
+ * Find the next sound visible record at or after from, for recovering from
+ * corrupted files. Unlike findvrl, the rest of the file is searched, and a
+ * candidate is only accepted if it, and the (chain - 1) visible records after
+ * it, are structurally intact. Throws not_found if there are none.
+ */
+long long resyncvrl(stream&, long long from, int chain = 3) noexcept (false);
 bool hastapemark(stream&) noexcept (false);
 
-dl::record extract(stream&, long long, dl::error_handler&) noexcept (false);
+/*
+ * Read the logical record at tell. With verify, the checksums of segments
+ * that have them are computed and compared to the trailer, and mismatches are
+ * reported to the error handler. The record is returned either way.
+ */
+dl::record extract(stream&, long long, dl::error_handler&,
+    bool verify = false) noexcept (false);
 dl::record& extract(stream&, long long, long long, dl::record&,
-    dl::error_handler&) noexcept (false);
+    dl::error_handler&, bool verify = false) noexcept (false);
 
-stream_offsets findoffsets(dl::stream&, dl::error_handler&) noexcept (false);
+dl::record_view extract(const memory_file&, long long, dl::error_handler&)
+    noexcept (false);
+
+/*
+ * Index the logical records of a logical file. With verify, the segments with
+ * checksums are read in full and verified, like with extract, and records
+ * that fail are listed in corrupt.
+ */
+stream_offsets findoffsets(dl::stream&, dl::error_handler&,
+    bool verify = false) noexcept (false);
+
+/*
+ * findoffsets on the raw file (not opened with open_rp66), from the visible
+ * record at from. The visible records are read in large blocks, and the
+ * envelopes and segment headers are parsed in memory, which is much faster
+ * for files with many small segments. The offsets are the same as findoffsets
+ * on a stream opened with open_rp66 at from, and end is set to what
+ * absolute_tell() would be on that stream afterwards, i.e. the start of the
+ * next logical file.
+ *
+ * If vrs is given, the visible records that are read are added to it.
+ *
+ * Tapeimage files are not supported.
+ */
+stream_offsets findoffsets(dl::stream&,
+                           long long from,
+                           long long& end,
+                           dl::error_handler&,
+                           bool verify = false,
+                           vr_index* vrs = nullptr) noexcept (false);
+
+/*
+ * findoffsets on the raw file at path, from the visible record at from, with
+ * the file split into shards that are indexed in parallel. The result,
+ * including end, vrs and what is reported to the error handler, is exactly
+ * the same as for findoffsets on a stream of the file.
+ *
+ * Every shard but the first starts at the first sound visible record after
+ * where the file is split. As rp66 requires visible records to hold whole
+ * segments, the segment headers of a shard can be walked without knowing what
+ * came before it, and the segment chains are stitched together across the
+ * shards afterwards. Files that break this, as well as verify, are indexed by
+ * the sequential findoffsets instead.
+ *
+ * If shards is 0, there is a shard per core, but no smaller than 64MB.
+ * Tapeimage files are not supported.
+ */
+stream_offsets findoffsets(const std::string& path,
+                           long long from,
+                           long long& end,
+                           dl::error_handler&,
+                           int shards = 0,
+                           bool verify = false,
+                           vr_index* vrs = nullptr) noexcept (false);
+
+/*
+ * A record read by batch_reader, or the reason it could not be read
+ */
+struct batch_record {
+    long long tell;
+    dl::record record;
+    /* what extract threw, or empty if the record was read */
+    std::string error;
+};
+
+/*
+ * Batched reads of records at known offsets
+ *
+ * A stream has a single position, so there is only ever one outstanding
+ * read, which leaves fast disks idle and makes network mounts pay the full
+ * latency for every record. The batch reader reads the raw file with
+ * positional reads (pread) from a pool of depth threads instead, with the
+ * visible record layout from findoffsets, so that depth records are in
+ * flight at the same time. The calling thread is one of them, and the rest
+ * are started with the reader and stopped when it is closed, so they are not
+ * started again for every batch. Every thread reads a whole visible record at a
+ * time, and neighbouring records are read by the same thread, so records
+ * that share a visible record are not read twice.
+ *
+ * Records are read exactly like extract(stream&, ...). Problems are reported
+ * to the error handler from the calling thread, in the order of tells, once
+ * all the records are read. Records that fail are returned with the error,
+ * so the caller can decide what to do with them.
+ *
+ * The reader only reads, so it can be shared between threads. Tapeimage
+ * files are not supported.
+ */
+class batch_reader {
+public:
+    batch_reader(const std::string& path, vr_index vrs, int depth = 16)
+    noexcept (false);
+    ~batch_reader();
+
+    batch_reader(const batch_reader&) = delete;
+    batch_reader& operator = (const batch_reader&) = delete;
+
+    /* at most bytes of every record, in the same order as tells */
+    std::vector< batch_record > extract(const std::vector< long long >& tells,
+                                        long long bytes,
+                                        dl::error_handler&,
+                                        bool verify = false)
+    const noexcept (false);
+
+    int depth() const noexcept (true);
+    const vr_index& index() const noexcept (true);
+    void close() noexcept (true);
+
+private:
+    struct worker_pool;
+
+    int fd;
+    vr_index vrs;
+    int queue_depth;
+    std::unique_ptr< worker_pool > workers;
+};
 
 std::map< dl::ident, std::vector< long long > >
 findfdata(dl::stream&, const std::vector< long long >&, dl::error_handler&)
 noexcept (false);
 
+/*
+ * An FDATA record and the frame number of its first frame, or -1 if the
+ * record has no frames.
+ *
+ * Frame numbers are normally increasing through the file, so the frames of a
+ * record are bounded by the first frame number of the record itself and of
+ * the next record. This makes for a sparse frame number -> record index that
+ * is captured for free when indexing, as the first frame number immediately
+ * follows the object name.
+ */
+struct fdata_record {
+    long long tell;
+    std::int32_t frameno;
+};
+
+std::map< dl::ident, std::vector< fdata_record > >
+indexfdata(dl::stream&, const std::vector< long long >&, dl::error_handler&)
+noexcept (false);
+
+std::map< dl::ident, std::vector< fdata_record > >
+indexfdata(const batch_reader&,
+           const std::vector< long long >&,
+           dl::error_handler&)
+noexcept (false);
+
+/*
+ * Tells of the records that may contain frames in [first, last]
+ *
+ * When the first frame numbers are non-decreasing, the first record is found
+ * by binary search. Otherwise, all records with frames are returned. Either
+ * way, the records may also contain frames outside the range, which the
+ * caller must filter out.
+ *
+ * Records without a frame number (frameno < 0), i.e. records that are empty
+ * or truncated in the frame number, are always returned, so that they are
+ * read, and reported, like any other broken record. The tells are in the same
+ * order as the records.
+ */
+std::vector< long long > findframes(const std::vector< fdata_record >&,
+                                    std::int32_t first,
+                                    std::int32_t last)
+noexcept (false);
+
+/*
+ * The value of the index channel in the first frame of every record, or NaN
+ * if the record has no frames.
+ *
+ * The index channel is always the first channel in the frame, right after
+ * FRAMENO. fmt is its (single, numeric) format character. Only the start of
+ * every record is read.
+ */
+std::vector< double > indexvalues(dl::stream&,
+                                  const std::vector< long long >& tells,
+                                  char fmt,
+                                  dl::error_handler&)
+noexcept (false);
+
+std::vector< double > indexvalues(const batch_reader&,
+                                  const std::vector< long long >& tells,
+                                  char fmt,
+                                  dl::error_handler&)
+noexcept (false);
+
+/*
+ * Tells of the records that may contain index values in [top, bottom] (or
+ * [bottom, top]), given the first index value of every record.
+ *
+ * When the index values are monotonic, increasing or decreasing, the records
+ * are found by binary search. Otherwise, all records with frames are
+ * returned. Like findframes, the records may contain frames outside the
+ * range.
+ *
+ * Records without an index value (NaN), i.e. records that are empty, broken,
+ * or start with a NaN, are left out of the search, but always returned. The
+ * tells are in the same order as the records.
+ */
+std::vector< long long > findindex(const std::vector< long long >& tells,
+                                   const std::vector< double >& values,
+                                   double top,
+                                   double bottom)
+noexcept (false);
+
 }
 
 #endif // DLISIO_PYTHON_IO_HPP
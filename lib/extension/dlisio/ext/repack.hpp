@@ -0,0 +1,54 @@
+#ifndef DLISIO_EXT_REPACK_HPP
+#define DLISIO_EXT_REPACK_HPP
+
+#include <string>
+#include <vector>
+
+#include <dlisio/ext/io.hpp>
+#include <dlisio/ext/types.hpp>
+#include <dlisio/ext/writer.hpp>
+
+namespace dl {
+
+struct repack_options {
+    /*
+     * Mnemonics of the channels to keep. Index channels are always kept, and
+     * an empty list keeps all channels.
+     */
+    std::vector< std::string > channels;
+
+    /*
+     * Only keep frames where the index is in [top, bottom] (or [bottom, top]
+     * for decreasing frames). Frames without an index are kept as-is.
+     */
+    bool index_range = false;
+    double top    = 0;
+    double bottom = 0;
+};
+
+/*
+ * Copy a logical file to out, keeping only a subset of the channels and/or
+ * frames.
+ *
+ * Frame data is copied as raw byte slices - the position of every channel in
+ * a frame is given by the frame format, so the samples are never decoded.
+ * Only the index channel is decoded, and only when an index range is given.
+ * Frames are renumbered from 1, so that FRAMENO stays consecutive.
+ *
+ * FRAME and CHANNEL sets are rewritten to only reference the kept channels,
+ * and frames with no kept channels are dropped entirely. INDEX-MIN and
+ * INDEX-MAX are clamped to the index range. All other records are copied
+ * verbatim, except encrypted records, which are skipped.
+ *
+ * The caller must start the logical file on out (writer::logical_file), so
+ * that several logical files can be written to the same output.
+ */
+void repack(dl::stream& file,
+            const dl::stream_offsets& offsets,
+            const repack_options& opts,
+            dl::writer& out,
+            dl::error_handler& errorhandler) noexcept (false);
+
+}
+
+#endif // DLISIO_EXT_REPACK_HPP
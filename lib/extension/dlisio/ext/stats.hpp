@@ -0,0 +1,115 @@
+#ifndef DLISIO_EXT_STATS_HPP
+#define DLISIO_EXT_STATS_HPP
+
+#include <chrono>
+#include <cstdint>
+
+namespace dl {
+
+/*
+ * Process-wide counters and per-stage timers for the hot paths, to find out
+ * where the time goes in a slow load: indexing, parsing metadata or decoding
+ * curves.
+ *
+ * The counters are relaxed atomics, so they are safe to bump from multiple
+ * threads (e.g. read_fdata_many), and cost next to nothing. They are still
+ * bumped once or more per segment, so the whole facility is compiled out
+ * unless DLISIO_STATS is defined (the cmake option of the same name). When
+ * compiled out, every function is an empty inline, and snapshot() is all
+ * zeros.
+ *
+ * Stage times are wall-clock, and inclusive: stages may nest (findfdata
+ * extracts records), and the time spent in extract is then counted in both.
+ * Time spent in concurrent calls of the same stage is summed.
+ */
+namespace stats {
+
+enum counter : int {
+    bytes_read = 0,    /* bytes read through dl::stream */
+    seeks,             /* seeks on dl::stream */
+    segments,          /* logical record segment headers read */
+    records,           /* logical records extracted */
+    objects,           /* objects parsed from EFLRs */
+    frames,            /* frames decoded from FDATA */
+    workers,           /* threads started to decode FDATA */
+    counters,
+};
+
+enum stage : int {
+    findoffsets = 0,
+    findfdata,
+    extract,
+    parse,             /* object_set::parse */
+    read_fdata,
+    stages,
+};
+
+struct snapshot {
+    std::int64_t count[counters] = {};
+    /* number of times the stage was entered, and the time spent in it */
+    std::int64_t calls[stages] = {};
+    std::int64_t nanoseconds[stages] = {};
+};
+
+const char* name(counter) noexcept (true);
+const char* name(stage) noexcept (true);
+
+/* true if the library is built with DLISIO_STATS */
+bool enabled() noexcept (true);
+
+#ifdef DLISIO_STATS
+
+void add(counter, std::int64_t n = 1) noexcept (true);
+void time(stage, std::int64_t nanoseconds) noexcept (true);
+snapshot read() noexcept (true);
+void reset() noexcept (true);
+
+/*
+ * Scoped stage timer:
+ *
+ *  dl::stats::timer t(dl::stats::findoffsets);
+ */
+class timer {
+public:
+    explicit timer(stage s) noexcept (true)
+        : s(s)
+        , start(std::chrono::steady_clock::now())
+    {}
+
+    ~timer() {
+        const auto elapsed = std::chrono::steady_clock::now() - this->start;
+        const auto ns = std::chrono::duration_cast<
+            std::chrono::nanoseconds
+        >(elapsed);
+        dl::stats::time(this->s, ns.count());
+    }
+
+    timer(const timer&) = delete;
+    timer& operator = (const timer&) = delete;
+
+private:
+    stage s;
+    std::chrono::steady_clock::time_point start;
+};
+
+#else
+
+inline void add(counter, std::int64_t = 1) noexcept (true) {}
+inline void time(stage, std::int64_t) noexcept (true) {}
+inline snapshot read() noexcept (true) { return snapshot{}; }
+inline void reset() noexcept (true) {}
+
+class timer {
+public:
+    explicit timer(stage) noexcept (true) {}
+    timer(const timer&) = delete;
+    timer& operator = (const timer&) = delete;
+};
+
+#endif // DLISIO_STATS
+
+}
+
+}
+
+#endif // DLISIO_EXT_STATS_HPP
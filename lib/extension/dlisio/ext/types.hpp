@@ -1,9 +1,12 @@
 #ifndef DLISIO_EXT_TYPES_HPP
 #define DLISIO_EXT_TYPES_HPP
 
+#include <atomic>
 #include <complex>
 #include <cstdint>
 #include <exception>
+#include <memory>
+#include <mutex>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -415,12 +418,46 @@ struct dlis_error {
     std::string action;
 };
 
+/*
+ * Known problems that can happen once per segment or record, and are
+ * reported with a code and a couple of numbers rather than a message, so that
+ * nothing needs to be formatted until someone reads it.
+ */
+enum class error_code {
+    checksum_mismatch,  // args: computed, expected checksum
+    checksum_too_short, // args: segment length
+    segment_trimmed,    // trim size = logical record segment length
+    fdata_obname,       // obname runs past the end of the FDATA record
+};
+
+struct error_report {
+    error_code code;
+    error_severity severity;
+    const char* context;     // static string
+    const char* action;      // static string
+    long long tell;          // of the segment or record, or -1
+    std::int64_t args[2];
+};
+
+/*
+ * Render a report as the problem, specification and action that would
+ * otherwise have been passed to log()
+ */
+dlis_error render(const error_report&) noexcept (false);
+
 struct error_handler {
     virtual void log(const error_severity &level, const std::string &context,
                      const std::string &problem,const std::string &specification,
                      const std::string &action)
         const noexcept(false) = 0;
 
+    /*
+     * Report a known problem. By default, the report is rendered and passed
+     * on to log(). Handlers that only collect problems (error_sink) override
+     * this to get the code and offset as-is.
+     */
+    virtual void report(const error_report&) const noexcept (false);
+
     virtual ~error_handler() = default;
 };
 
@@ -434,6 +471,34 @@ struct record {
     std::vector< char > data;
 };
 
+/*
+ * A logical record that refers to bytes it does not own
+ *
+ * A logical record that is a single segment is contiguous in the source, and
+ * the view points straight into it - padding, checksum and trailing length
+ * are trimmed by shortening the view. Only records that are split over
+ * several segments are stitched together in a buffer owned by the view.
+ *
+ * owner keeps the source bytes alive for as long as the view is.
+ */
+struct record_view {
+    bool isexplicit()  const noexcept (true);
+    bool isencrypted() const noexcept (true);
+
+    const char* data() const noexcept (true);
+    std::size_t size() const noexcept (true);
+
+    int type;
+    std::uint8_t attributes;
+    bool consistent;
+
+    bool stitched = false;
+    const char* ptr = nullptr;
+    std::size_t len = 0;
+    std::vector< char > buffer;
+    std::shared_ptr< const void > owner;
+};
+
 /*
  * The structure of an attribute as described in 3.2.2.1
  *
@@ -561,6 +626,14 @@ struct basic_object {
  *
  * As well as attributes, every object set should have information about issues
  * that arose during parsing.
+ *
+ * Threads:
+ *
+ * objects() is const and safe to call from multiple threads - the first call
+ * parses the set, and concurrent callers wait for it to finish. The log is
+ * complete once objects() has returned. Copying, moving and assigning are
+ * not synchronised with other writers, but may copy a set that is being
+ * parsed.
  */
 using object_vector = std::vector< basic_object >;
 
@@ -568,24 +641,34 @@ struct object_set {
 public:
     explicit object_set( dl::record ) noexcept (false);
 
+    object_set( const object_set& ) noexcept (false);
+    object_set( object_set&& ) noexcept (false);
+    object_set& operator = ( const object_set& ) noexcept (false);
+    object_set& operator = ( object_set&& ) noexcept (false);
+
     int role; // TODO: enum class?
     dl::ident type;
     dl::ident name;
 
-    std::vector< dl::dlis_error > log;
+    /* written by the (lazy) parse, hence mutable */
+    mutable std::vector< dl::dlis_error > log;
 
-    dl::object_vector& objects() noexcept (false);
+    const dl::object_vector& objects() const noexcept (false);
 private:
     dl::record          record;
-    dl::object_vector   objs;
-    dl::object_template tmpl;
+    /* offset of the template, i.e. the size of the set component */
+    std::size_t         template_offset = 0;
 
-    void parse() noexcept (true);
-    bool parsed = false;
+    mutable dl::object_vector   objs;
+    mutable dl::object_template tmpl;
+
+    void parse() const noexcept (true);
+    mutable std::mutex parse_lock;
+    mutable std::atomic< bool > parsed { false };
 
     const char* parse_set_component(const char* cur) noexcept (false);
-    const char* parse_template(const char* cur) noexcept (false);
-    const char* parse_objects(const char* cur) noexcept (false);
+    const char* parse_template(const char* cur) const noexcept (false);
+    const char* parse_objects(const char* cur) const noexcept (false);
 };
 
 struct matcher {
@@ -595,7 +678,13 @@ struct matcher {
     virtual ~matcher() = default;
 };
 
-/* A queryable pool of metadata objects */
+/*
+ * A queryable pool of metadata objects
+ *
+ * Queries are const, and a pool can be queried from multiple threads without
+ * locking, as long as the matcher and error handler are also safe to use
+ * concurrently.
+ */
 class pool {
 public:
     explicit pool( std::vector< dl::object_set > e ) : eflrs(std::move(e)) {};
@@ -605,11 +694,13 @@ public:
     object_vector get(const std::string& type,
                       const std::string& name,
                       const dl::matcher& matcher,
-                      const error_handler& errorhandler) noexcept (false);
+                      const error_handler& errorhandler)
+        const noexcept (false);
 
     object_vector get(const std::string& type,
                       const dl::matcher& matcher,
-                      const error_handler& errorhandler) noexcept (false);
+                      const error_handler& errorhandler)
+        const noexcept (false);
 
 private:
     std::vector< dl::object_set > eflrs;
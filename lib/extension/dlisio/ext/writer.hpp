@@ -0,0 +1,141 @@
+#ifndef DLISIO_EXT_WRITER_HPP
+#define DLISIO_EXT_WRITER_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <dlisio/ext/types.hpp>
+
+namespace dl {
+
+/*
+ * Encode an object set (3.2.1 EFLR: General layout) as the body of an
+ * explicitly formatted logical record.
+ *
+ * The template is the union of the attribute labels of all objects, in order
+ * of first appearance, with the representation code of the first object that
+ * has it. Attributes that an object does not have are written as absent.
+ * The object type and attribute logs are ignored.
+ */
+std::vector< char > encode_set(const dl::ident& type,
+                               const dl::ident& name,
+                               const dl::object_vector& objects)
+noexcept (false);
+
+/*
+ * The logical record type code (Appendix A: Logical Record Types) of a set
+ * type, e.g. FRAME -> 4. Unknown set types map to STATIC.
+ */
+int eflr_type(const dl::ident& type) noexcept (true);
+
+/*
+ * A single column of frame data, i.e. all samples of one channel.
+ *
+ * The data is laid out in the native format that dlis_packf would produce for
+ * the representation code, e.g. float for fsingl, two doubles for fdoub1 and
+ * eight ints for dtime, with all samples of a frame stored consecutively.
+ * data must point to frames * samples values.
+ */
+struct column {
+    dl::representation_code reprc;
+    int samples;
+    const void* data;
+};
+
+/*
+ * Streaming DLIS writer
+ *
+ * The writer produces the visible envelope (SUL and visible records) and
+ * splits logical records into segments. Only the visible record that is being
+ * built, the current logical record, and a block of complete visible records
+ * are kept in memory - blocks are written in one go when they are full, so
+ * the number of writes is independent of the visible record length.
+ *
+ * A typical file is written as:
+ *
+ *  dl::writer out(path);
+ *  out.storage_label(1, "my storage set");
+ *  out.logical_file();
+ *  out.write_set("FILE-HEADER", "", header);
+ *  out.write_set("ORIGIN", "", origins);
+ *  out.write_set("CHANNEL", "", channels);
+ *  out.write_set("FRAME", "", frames);
+ *  out.write_frames(frame.object_name, columns, 1, nframes);
+ *  out.close();
+ *
+ * Visible record length (vrlen) must be even, in [20, 16384]. seglen is the
+ * maximum length of a logical record segment, including its header, and
+ * defaults to whatever fits in a visible record.
+ *
+ * Anything not written before the writer is destroyed is discarded, call
+ * close() to flush the output and detect errors.
+ */
+class writer {
+public:
+    explicit writer(const std::string& path,
+                    int vrlen = 8192,
+                    int seglen = 0,
+                    std::size_t blocksize = 1 << 20) noexcept (false);
+    ~writer();
+
+    writer(const writer&) = delete;
+    writer& operator = (const writer&) = delete;
+
+    void storage_label(int seqnum, const std::string& id) noexcept (false);
+
+    /*
+     * Start a new logical file. Logical files always start in a new visible
+     * record.
+     */
+    void logical_file() noexcept (false);
+
+    /*
+     * Write a checksum in the trailer of every segment written from now on.
+     * Off by default.
+     */
+    void checksums(bool enable) noexcept (true);
+
+    /* Write a logical record, segmenting it as needed */
+    void write(int type,
+               bool explicit_formatting,
+               const char* data,
+               std::size_t size) noexcept (false);
+
+    void write_set(const dl::ident& type,
+                   const dl::ident& name,
+                   const dl::object_vector& objects) noexcept (false);
+
+    /*
+     * Pack frames from columns and write them as FDATA for frame, with
+     * frames_per_record frames in each record. The first frame is numbered
+     * frameno, and frame numbers increase by one.
+     *
+     * Only fixed-size representation codes are supported.
+     */
+    void write_frames(const dl::obname& frame,
+                      const std::vector< column >& columns,
+                      std::int32_t frameno,
+                      std::size_t frames,
+                      std::size_t frames_per_record = 1) noexcept (false);
+
+    void close() noexcept (false);
+
+private:
+    std::FILE* fp = nullptr;
+    int vrlen;
+    int seglen;
+    std::size_t blocksize;
+    bool checksum = false;
+    std::vector< char > vr;
+    std::vector< char > block;
+    std::vector< char > rec;
+
+    void flush_vr() noexcept (false);
+    void flush_block() noexcept (false);
+};
+
+}
+
+#endif // DLISIO_EXT_WRITER_HPP
@@ -233,6 +233,26 @@ int dlis_trim_record_segment(uint8_t attrs,
                              const char* end,
                              int* size);
 
+/*
+ * Compute the logical record segment checksum of the bytes in [begin, end).
+ *
+ * The checksum (2.2.2.4 Logical Record Segment Trailer, Appendix B) is a
+ * 16-bit CRC with the polynomial x^16 + x^15 + x^2 + 1, with the bits in
+ * reflected order and starting at 0. It covers the segment from the first
+ * byte of the segment header to the last pad byte, and is stored as a UNORM
+ * just before the trailing length, if any.
+ *
+ * crc is both input and output, which makes it possible to checksum a segment
+ * in pieces, e.g. header and body. Initialise it to 0 for every segment.
+ *
+ * The computation is table driven and works on 8 bytes at a time
+ * (slicing-by-8), which is fast enough to verify checksums while reading.
+ */
+DLISIO_API
+int dlis_checksum(const char* begin,
+                  const char* end,
+                  uint16_t* crc);
+
 #define DLIS_FMT_EOL    '\0'
 #define DLIS_FMT_FSHORT 'r'
 #define DLIS_FMT_FSINGL 'f'
@@ -579,6 +579,68 @@ int dlis_trim_record_segment(uint8_t descriptor,
 
 namespace {
 
+/*
+ * Tables for slicing-by-8. crc16_table[0] is the regular byte-wise CRC table,
+ * and crc16_table[k][i] is the CRC of byte i followed by k zero bytes, so
+ * that 8 bytes can be folded into the CRC with 8 independent lookups.
+ */
+struct crc16_tables {
+    std::uint16_t table[8][256];
+
+    crc16_tables() noexcept (true) {
+        /* x^16 + x^15 + x^2 + 1, reflected */
+        constexpr std::uint16_t poly = 0xA001;
+        for (int i = 0; i < 256; ++i) {
+            std::uint16_t crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc & 1) ? (crc >> 1) ^ poly : (crc >> 1);
+            this->table[0][i] = crc;
+        }
+
+        for (int k = 1; k < 8; ++k) {
+            for (int i = 0; i < 256; ++i) {
+                const auto prev = this->table[k - 1][i];
+                this->table[k][i] = (prev >> 8) ^ this->table[0][prev & 0xFF];
+            }
+        }
+    }
+};
+
+const crc16_tables crc16;
+
+}
+
+int dlis_checksum(const char* begin,
+                  const char* end,
+                  std::uint16_t* crc) {
+    if (std::distance(begin, end) < 0) return DLIS_INVALID_ARGS;
+
+    const auto& t = crc16.table;
+    const auto* xs = reinterpret_cast< const unsigned char* >(begin);
+    const auto* last = reinterpret_cast< const unsigned char* >(end);
+    std::uint16_t c = *crc;
+
+    while (last - xs >= 8) {
+        c = t[7][xs[0] ^ (c & 0xFF)]
+          ^ t[6][xs[1] ^ (c >> 8)]
+          ^ t[5][xs[2]]
+          ^ t[4][xs[3]]
+          ^ t[3][xs[4]]
+          ^ t[2][xs[5]]
+          ^ t[1][xs[6]]
+          ^ t[0][xs[7]];
+        xs += 8;
+    }
+
+    while (xs < last)
+        c = (c >> 8) ^ t[0][(c ^ *xs++) & 0xFF];
+
+    *crc = c;
+    return DLIS_OK;
+}
+
+namespace {
+
 /*
  * The dlis_packf function uses a dispatch table for interpreting and expanding
  * raw bytes into native C++ data types. There are 27 primary data types
@@ -0,0 +1,242 @@
+#include <ciso646>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+#include <fmt/format.h>
+
+#include <dlisio/ext/errors.hpp>
+#include <dlisio/ext/types.hpp>
+
+namespace dl {
+
+dlis_error render(const error_report& r) noexcept (false) {
+    const auto lrst = "[2.2.2.4 Logical Record Segment Trailer (LRST)]";
+
+    switch (r.code) {
+        case error_code::checksum_mismatch: {
+            const auto problem =
+                "checksum mismatch in logical record segment at tell {}: "
+                "computed {:#06x}, but the trailer says {:#06x}";
+            return {
+                r.severity,
+                fmt::format(problem, r.tell, r.args[0], r.args[1]),
+                lrst,
+                r.action,
+            };
+        }
+
+        case error_code::checksum_too_short: {
+            const auto problem =
+                "logical record segment at tell {} is too short for a "
+                "checksum, length was {}";
+            return {
+                r.severity,
+                fmt::format(problem, r.tell, r.args[0]),
+                lrst,
+                r.action,
+            };
+        }
+
+        case error_code::segment_trimmed:
+            return {
+                r.severity,
+                "trim size (padbytes + checksum + trailing length) = logical "
+                    "record segment length",
+                "[from 2.2.2.1 Logical Record Segment Header (LRSH) and "
+                    "2.2.2.4 Logical Record Segment Trailer (LRST) situation "
+                    "should be impossible]",
+                r.action,
+            };
+
+        case error_code::fdata_obname:
+            return {
+                r.severity,
+                "fdata record corrupted, error on reading obname",
+                "",
+                r.action,
+            };
+    }
+
+    const auto msg = "render: unknown error code {}";
+    throw std::invalid_argument(fmt::format(msg, int(r.code)));
+}
+
+void error_handler::report(const error_report& r) const noexcept (false) {
+    const auto err = render(r);
+    this->log(err.severity, r.context, err.problem, err.specification,
+              err.action);
+}
+
+error_sink::error_sink(bool raise_critical,
+                       std::size_t max_tells,
+                       std::size_t max_problems)
+noexcept (true)
+    : raise_critical(raise_critical)
+    , max_tells(max_tells)
+    , max_problems(max_problems)
+{}
+
+namespace {
+
+/*
+ * The key of a problem in the index. The parts are separated by a nul, which
+ * is not in any of them, so distinct problems never share a key. Logged and
+ * reported problems are told apart by the first character.
+ */
+std::string logged_key(const error_severity& level,
+                       const std::string& context,
+                       const std::string& problem) noexcept (false) {
+    auto key = std::string(1, 'l');
+    key += char('0' + int(level));
+    key += context;
+    key += '\0';
+    key += problem;
+    return key;
+}
+
+std::string reported_key(const error_report& r) noexcept (false) {
+    auto key = std::string(1, 'r');
+    key += char('0' + int(r.severity));
+    key += std::to_string(int(r.code));
+    key += '\0';
+    key += r.context;
+    return key;
+}
+
+}
+
+template < typename Make >
+error_sink::entry& error_sink::find(const std::string& key, Make make)
+const noexcept (false) {
+    const auto itr = this->index.find(key);
+    if (itr != this->index.end())
+        return this->entries[itr->second];
+
+    this->entries.push_back(make());
+    this->index.emplace(key, this->entries.size() - 1);
+    return this->entries.back();
+}
+
+void error_sink::log(const error_severity& level,
+                     const std::string& context,
+                     const std::string& problem,
+                     const std::string& specification,
+                     const std::string& action) const noexcept (false) {
+    {
+        std::lock_guard< std::mutex > guard(this->lock);
+        auto key = logged_key(level, context, problem);
+
+        /*
+         * Past max_problems distinct problems, new problems are counted in
+         * an entry of their own, but the problems already kept are still
+         * counted where they belong
+         */
+        const auto full = this->logged >= this->max_problems
+                      and this->index.find(key) == this->index.end();
+        if (full) {
+            key = logged_key(level, context, "");
+            key.insert(0, 1, '+');
+        }
+
+        auto& e = this->find(key, [&] {
+            entry x {};
+            x.reported = false;
+            x.context = context;
+            x.error = { level, problem, specification, action };
+            if (full) {
+                const auto msg = "more than {} distinct problems, the rest "
+                                 "are only counted";
+                x.error.problem = fmt::format(msg, this->max_problems);
+                x.error.specification = "";
+            } else {
+                this->logged += 1;
+            }
+            x.count = 0;
+            return x;
+        });
+
+        e.count += 1;
+    }
+
+    this->raise(level, context, problem);
+}
+
+void error_sink::report(const error_report& r) const noexcept (false) {
+    {
+        std::lock_guard< std::mutex > guard(this->lock);
+        auto& e = this->find(reported_key(r), [&] {
+            entry x {};
+            x.reported = true;
+            x.first = r;
+            x.count = 0;
+            return x;
+        });
+
+        e.count += 1;
+        if (r.tell >= 0 and e.tells.size() < this->max_tells)
+            e.tells.push_back(r.tell);
+    }
+
+    if (this->raise_critical and r.severity == error_severity::CRITICAL)
+        this->raise(r.severity, r.context, render(r).problem);
+}
+
+std::vector< error_sink::problem > error_sink::problems()
+const noexcept (false) {
+    std::lock_guard< std::mutex > guard(this->lock);
+    std::vector< problem > xs;
+    xs.reserve(this->entries.size());
+    for (const auto& e : this->entries) {
+        problem p;
+        if (e.reported) {
+            const auto err = render(e.first);
+            p.severity      = e.first.severity;
+            p.context       = e.first.context;
+            p.problem       = err.problem;
+            p.specification = err.specification;
+            p.action        = err.action;
+        } else {
+            p.severity      = e.error.severity;
+            p.context       = e.context;
+            p.problem       = e.error.problem;
+            p.specification = e.error.specification;
+            p.action        = e.error.action;
+        }
+        p.count = e.count;
+        p.tells = e.tells;
+        xs.push_back(std::move(p));
+    }
+    return xs;
+}
+
+std::size_t error_sink::size() const noexcept (true) {
+    std::lock_guard< std::mutex > guard(this->lock);
+    return this->entries.size();
+}
+
+std::size_t error_sink::count() const noexcept (true) {
+    std::lock_guard< std::mutex > guard(this->lock);
+    std::size_t n = 0;
+    for (const auto& e : this->entries)
+        n += e.count;
+    return n;
+}
+
+void error_sink::clear() noexcept (true) {
+    std::lock_guard< std::mutex > guard(this->lock);
+    this->entries.clear();
+    this->index.clear();
+    this->logged = 0;
+}
+
+void error_sink::raise(const error_severity& level,
+                       const std::string& context,
+                       const std::string& problem) const noexcept (false) {
+    if (not this->raise_critical) return;
+    if (level != error_severity::CRITICAL) return;
+    throw std::runtime_error(context + ": " + problem);
+}
+
+}
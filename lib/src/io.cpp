@@ -1,11 +1,33 @@
 #include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <ciso646>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
 #include <string>
 #include <system_error>
+#include <thread>
 #include <vector>
 #include <map>
 
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include <fmt/core.h>
 #include <fmt/format.h>
 #include <lfp/lfp.h>
@@ -16,9 +38,28 @@
 #include <dlisio/types.h>
 
 #include <dlisio/ext/io.hpp>
+#include <dlisio/ext/stats.hpp>
 
 namespace dl {
 
+namespace {
+
+stream open_protocol(lfp_protocol* protocol, std::int64_t offset)
+noexcept (false) {
+    auto err = lfp_seek(protocol, offset);
+    switch (err) {
+            case LFP_OK: break;
+            default: {
+                const std::string msg = lfp_errormsg(protocol);
+                lfp_close(protocol);
+                throw io_error(msg);
+            }
+        }
+    return stream(protocol);
+}
+
+}
+
 stream open(const std::string& path, std::int64_t offset) noexcept (false) {
     auto* file = std::fopen(path.c_str(), "rb");
     if (!file) {
@@ -29,13 +70,40 @@ stream open(const std::string& path, std::int64_t offset) noexcept (false) {
     if ( protocol == nullptr  )
         throw io_error("lfp: unable to open lfp protocol cfile");
 
-    auto err = lfp_seek(protocol, offset);
-    switch (err) {
-            case LFP_OK: break;
-            default:
-                throw io_error(lfp_errormsg(protocol));
-        }
-    return stream(protocol);
+    return open_protocol(protocol, offset);
+}
+
+stream open_memory(const char* data, std::size_t size, std::int64_t offset)
+noexcept (false) {
+#if defined(_WIN32) || defined(__APPLE__)
+    /*
+     * No fmemopen (macOS only has it from 10.13, and dlisio targets older
+     * releases), so the bytes are copied
+     */
+    auto* protocol = lfp_memfile_openwith(
+        reinterpret_cast< const unsigned char* >(data),
+        std::int64_t(size)
+    );
+    if ( protocol == nullptr )
+        throw io_error("lfp: unable to open lfp protocol memfile");
+#else
+    /* fmemopen does not accept empty buffers everywhere */
+    static const char empty[1] = {};
+    if (size == 0) data = empty;
+
+    auto* file = fmemopen(const_cast< char* >(data), size, "rb");
+    if (!file) {
+        auto msg = "unable to open in-memory file: {}";
+        throw dl::io_error(fmt::format(msg, strerror(errno)));
+    }
+    auto* protocol = lfp_cfile(file);
+    if ( protocol == nullptr ) {
+        std::fclose(file);
+        throw io_error("lfp: unable to open lfp protocol cfile");
+    }
+#endif
+
+    return open_protocol(protocol, offset);
 }
 
 stream open_rp66(const stream& f) noexcept (false) {
@@ -126,6 +194,108 @@ long long findvrl( stream& file, long long from ) noexcept (false) {
     }
 }
 
+namespace {
+
+/*
+ * Check that there is a sound visible record at offset, i.e. a visible
+ * record envelope (length, 0xFF, 0x01) followed by logical record segment
+ * headers whose lengths exactly add up to the visible record length, and
+ * that the next (chain - 1) visible records are sound too. A chain that
+ * reaches end-of-file after the first record is sound.
+ */
+bool soundvr(stream& file,
+             long long offset,
+             int chain,
+             std::vector< char >& buffer)
+noexcept (false) {
+    for (int i = 0; i < chain; ++i) {
+        char head[DLIS_VRL_SIZE];
+        file.seek(offset);
+        const auto n = file.read(head, DLIS_VRL_SIZE);
+        if (n == 0 and i > 0 and file.eof()) return true;
+        if (n != DLIS_VRL_SIZE) return false;
+
+        int len, version;
+        dlis_vrl(head, &len, &version);
+        if (std::uint8_t(head[2]) != 0xFF or version != 1) return false;
+        if (len < DLIS_VRL_SIZE + DLIS_LRSH_SIZE) return false;
+
+        const auto body = len - DLIS_VRL_SIZE;
+        buffer.resize(body);
+        if (file.read(buffer.data(), body) != body) return false;
+
+        int pos = 0;
+        while (pos < body) {
+            if (pos + DLIS_LRSH_SIZE > body) return false;
+            int seglen, type;
+            std::uint8_t attrs;
+            dlis_lrsh(buffer.data() + pos, &seglen, &attrs, &type);
+            if (seglen < DLIS_LRSH_SIZE) return false;
+            pos += seglen;
+        }
+        if (pos != body) return false;
+
+        offset += len;
+    }
+
+    return true;
+}
+
+}
+
+long long resyncvrl( stream& file, long long from, int chain )
+noexcept (false) {
+    if (from < 0) {
+        const auto msg = "expected from (which is {}) >= 0";
+        throw std::out_of_range(fmt::format(msg, from));
+    }
+
+    if (chain < 1) {
+        const auto msg = "expected chain (which is {}) >= 1";
+        throw std::out_of_range(fmt::format(msg, chain));
+    }
+
+    /*
+     * The file is read in large blocks, and searched for the 0xFF of the
+     * envelope with memchr, which is vectorised in any reasonable libc. The
+     * blocks overlap by 3 bytes, so that envelopes that cross a block
+     * boundary are still found.
+     */
+    constexpr int blocksize = 1 << 20;
+    std::vector< char > block(blocksize);
+    std::vector< char > buffer;
+
+    long long base = from;
+    while (true) {
+        file.seek(base);
+        const auto n = file.read(block.data(), blocksize);
+
+        const auto* begin = block.data();
+        const auto* end = begin + n;
+        /* the length precedes the 0xFF, and the version follows it */
+        const auto* ptr = begin + 2;
+        while (ptr < end - 1) {
+            const auto* ff = static_cast< const char* >(
+                std::memchr(ptr, 0xFF, (end - 1) - ptr)
+            );
+            if (not ff) break;
+
+            const auto candidate = base + (ff - 2 - begin);
+            if (ff[1] == 0x01 and soundvr(file, candidate, chain, buffer))
+                return candidate;
+
+            ptr = ff + 1;
+        }
+
+        if (n < blocksize) break;
+        base += n - 3;
+    }
+
+    const auto msg = "searched from {} to end-of-file, but could not find a "
+                     "sound visible record";
+    throw dl::not_found(fmt::format(msg, from));
+}
+
 bool hastapemark(stream& file) noexcept (false) {
     constexpr int TAPEMARK_SIZE = 12;
     file.seek(0);
@@ -157,6 +327,22 @@ bool record::isencrypted() const noexcept (true) {
     return this->attributes & DLIS_SEGATTR_ENCRYPT;
 }
 
+bool record_view::isexplicit() const noexcept (true) {
+    return this->attributes & DLIS_SEGATTR_EXFMTLR;
+}
+
+bool record_view::isencrypted() const noexcept (true) {
+    return this->attributes & DLIS_SEGATTR_ENCRYPT;
+}
+
+const char* record_view::data() const noexcept (true) {
+    return this->stitched ? this->buffer.data() : this->ptr;
+}
+
+std::size_t record_view::size() const noexcept (true) {
+    return this->stitched ? this->buffer.size() : this->len;
+}
+
 namespace {
 
 template < typename T >
@@ -174,10 +360,54 @@ bool type_consistent( const T& ) noexcept (true) {
     return true;
 }
 
+/*
+ * Verify the checksum of a segment with a checksum, from the segment header
+ * and the len - DLIS_LRSH_SIZE bytes of body (including the trailer). A
+ * mismatch is reported through the error handler, and false is returned.
+ */
+bool verify_checksum(std::uint8_t attrs,
+                     const char* header,
+                     const char* body,
+                     int len,
+                     long long tell,
+                     const char* context,
+                     const char* action,
+                     dl::error_handler& errorhandler)
+noexcept (false) {
+    const int trailer = 2 + ((attrs & DLIS_SEGATTR_TRAILEN) ? 2 : 0);
+    const int size = len - DLIS_LRSH_SIZE - trailer;
+    if (size < 0) {
+        errorhandler.report({ dl::error_code::checksum_too_short,
+                              dl::error_severity::MAJOR,
+                              context,
+                              action,
+                              tell,
+                              { len, 0 } });
+        return false;
+    }
+
+    std::uint16_t crc = 0;
+    dlis_checksum(header, header + DLIS_LRSH_SIZE, &crc);
+    dlis_checksum(body, body + size, &crc);
+
+    std::uint16_t expected;
+    dlis_unorm(body + size, &expected);
+    if (crc == expected) return true;
+
+    errorhandler.report({ dl::error_code::checksum_mismatch,
+                          dl::error_severity::MAJOR,
+                          context,
+                          action,
+                          tell,
+                          { crc, expected } });
+    return false;
+}
+
 void trim_segment(std::uint8_t attrs,
                   const char* begin,
                   int segment_size,
                   std::vector< char >& segment,
+                  long long tell,
                   dl::error_handler& errorhandler)
 noexcept (false) {
     int trim = 0;
@@ -197,15 +427,12 @@ noexcept (false) {
                 throw std::runtime_error(fmt::format(msg, trim, segment_size));
             }
 
-            errorhandler.log(
-                dl::error_severity::MINOR,
-                "extract (trim_segment)",
-                "trim size (padbytes + checksum + trailing length) = logical "
-                    "record segment length",
-                "[from 2.2.2.1 Logical Record Segment Header (LRSH) and "
-                    "2.2.2.4 Logical Record Segment Trailer (LRST) situation "
-                    "should be impossible]",
-                "Segment is skipped");
+            errorhandler.report({ dl::error_code::segment_trimmed,
+                                  dl::error_severity::MINOR,
+                                  "extract (trim_segment)",
+                                  "Segment is skipped",
+                                  tell,
+                                  { 0, 0 } });
 
             segment.resize(segment.size() - segment_size);
             return;
@@ -235,6 +462,7 @@ int stream::eof() const noexcept (true) {
 }
 
 void stream::seek( std::int64_t offset ) noexcept (false) {
+    dl::stats::add(dl::stats::seeks);
     const auto err = lfp_seek(this->f, offset);
     switch (err) {
         case LFP_OK:
@@ -292,6 +520,7 @@ noexcept (false) {
         default:
             throw std::runtime_error(lfp_errormsg(this->f));
     }
+    dl::stats::add(dl::stats::bytes_read, nread);
     return nread;
 }
 
@@ -305,16 +534,31 @@ template < typename T >
 using shortvec = std::basic_string< T >;
 
 
-record extract(stream& file, long long tell, error_handler& errorhandler)
+record extract(stream& file, long long tell, error_handler& errorhandler,
+               bool verify)
 noexcept (false) {
     record rec;
     rec.data.reserve( 8192 );
     auto nbytes = std::numeric_limits< std::int64_t >::max();
-    return extract(file, tell, nbytes, rec, errorhandler);
+    return extract(file, tell, nbytes, rec, errorhandler, verify);
 }
 
-record& extract(stream& file, long long tell, long long bytes, record& rec,
-                error_handler& errorhandler) noexcept (false) {
+namespace {
+
+/*
+ * The record walk of extract. Stream is dl::stream, or anything else with the
+ * same read, seek and tell.
+ */
+template < typename Stream >
+record& extract_record(Stream& file,
+                       long long tell,
+                       long long bytes,
+                       record& rec,
+                       error_handler& errorhandler,
+                       bool verify) noexcept (false) {
+    dl::stats::timer timer(dl::stats::extract);
+    dl::stats::add(dl::stats::records);
+
     shortvec< std::uint8_t > attributes;
     shortvec< int > types;
     bool consistent = true;
@@ -327,6 +571,7 @@ record& extract(stream& file, long long tell, long long bytes, record& rec,
         auto nread = file.read( buffer, DLIS_LRSH_SIZE );
         if ( nread < DLIS_LRSH_SIZE )
             throw std::runtime_error("extract: unable to read LRSH, file truncated");
+        dl::stats::add(dl::stats::segments);
 
         int len, type;
         std::uint8_t attrs;
@@ -360,14 +605,25 @@ record& extract(stream& file, long long tell, long long bytes, record& rec,
         if ( nread < to_read )
             throw std::runtime_error("extract: unable to read LRS, file truncated");
 
+        const auto* fst = rec.data.data() + prevsize;
+
+        if (verify and (attrs & DLIS_SEGATTR_CHCKSUM)
+                   and not (attrs & DLIS_SEGATTR_ENCRYPT)) {
+            verify_checksum(attrs,
+                            buffer,
+                            fst,
+                            len + DLIS_LRSH_SIZE,
+                            file.tell() - len - DLIS_LRSH_SIZE,
+                            "extract (checksum)",
+                            "Segment is read as-is",
+                            errorhandler);
+        }
+
         /*
-         * chop off trailing length and checksum for now
+         * chop off trailing length and checksum
          * TODO: verify integrity by checking trailing length
-         * TODO: calculate checksum
          */
-
-        const auto* fst = rec.data.data() + prevsize;
-        trim_segment(attrs, fst, len, rec.data, errorhandler);
+        trim_segment(attrs, fst, len, rec.data, tell, errorhandler);
 
         /* if the whole segment is getting trimmed, it's unclear if successor
          * attribute should be erased or not.  For now ignoring.  Suspecting
@@ -396,7 +652,382 @@ record& extract(stream& file, long long tell, long long bytes, record& rec,
     }
 }
 
-stream_offsets findoffsets( dl::stream& file, dl::error_handler& errorhandler)
+}
+
+record& extract(stream& file, long long tell, long long bytes, record& rec,
+                error_handler& errorhandler, bool verify) noexcept (false) {
+    return extract_record(file, tell, bytes, rec, errorhandler, verify);
+}
+
+memory_file::memory_file(const char* data,
+                         std::size_t size,
+                         std::shared_ptr< const void > owner) noexcept (false)
+    : keepalive(std::move(owner))
+{
+    /*
+     * Index the visible records until the end of the data, or until something
+     * that is not a visible record header. Like with the rp66 stream, reading
+     * past that point fails.
+     */
+    long long tell = 0;
+    std::size_t pos = 0;
+    while (size - pos >= DLIS_VRL_SIZE) {
+        int len, version;
+        const auto err = dlis_vrl(data + pos, &len, &version);
+        if (err or version != 1 or len < DLIS_VRL_SIZE) break;
+        if (std::uint8_t(data[pos + 2]) != 0xFF) break;
+
+        const auto body = std::min(std::size_t(len), size - pos)
+                        - DLIS_VRL_SIZE;
+        this->vrs.push_back({ tell, data + pos + DLIS_VRL_SIZE, body });
+        tell += body;
+        pos += len;
+
+        if (pos >= size) break;
+    }
+}
+
+std::vector< memory_file::visible_record >::const_iterator
+memory_file::find(long long tell) const noexcept (true) {
+    const auto lt = [](long long x, const visible_record& vr) {
+        return x < vr.tell;
+    };
+    auto itr = std::upper_bound(this->vrs.begin(), this->vrs.end(), tell, lt);
+    if (itr == this->vrs.begin()) return this->vrs.end();
+    return --itr;
+}
+
+const char* memory_file::contiguous(long long tell, std::size_t n)
+const noexcept (true) {
+    const auto vr = this->find(tell);
+    if (vr == this->vrs.end()) return nullptr;
+
+    const auto offset = std::size_t(tell - vr->tell);
+    if (offset + n > vr->size) return nullptr;
+    return vr->begin + offset;
+}
+
+std::size_t memory_file::read(long long tell, char* dst, std::size_t n)
+const noexcept (true) {
+    auto vr = this->find(tell);
+    std::size_t nread = 0;
+    while (nread < n and vr != this->vrs.end()) {
+        const auto offset = std::size_t(tell + nread - vr->tell);
+        if (offset < vr->size) {
+            const auto len = std::min(n - nread, vr->size - offset);
+            std::memcpy(dst + nread, vr->begin + offset, len);
+            nread += len;
+        }
+        ++vr;
+    }
+    return nread;
+}
+
+const std::shared_ptr< const void >& memory_file::owner()
+const noexcept (true) {
+    return this->keepalive;
+}
+
+record_view extract(const memory_file& file,
+                    long long tell,
+                    error_handler& errorhandler) noexcept (false) {
+    static const auto fmtenc = DLIS_SEGATTR_EXFMTLR | DLIS_SEGATTR_ENCRYPT;
+    dl::stats::timer timer(dl::stats::extract);
+    dl::stats::add(dl::stats::records);
+
+    const auto start = tell;
+    record_view view;
+    view.owner = file.owner();
+    view.consistent = true;
+
+    shortvec< std::uint8_t > attributes;
+    shortvec< int > types;
+
+    while (true) {
+        char buffer[ DLIS_LRSH_SIZE ];
+        if (file.read(tell, buffer, DLIS_LRSH_SIZE) < DLIS_LRSH_SIZE)
+            throw std::runtime_error("extract: unable to read LRSH, file truncated");
+        dl::stats::add(dl::stats::segments);
+
+        int len, type;
+        std::uint8_t attrs;
+        dlis_lrsh( buffer, &len, &attrs, &type );
+        len -= DLIS_LRSH_SIZE;
+        tell += DLIS_LRSH_SIZE;
+
+        attributes.push_back( attrs );
+        types.push_back( type );
+
+        /*
+         * A single segment is used in-place, trimming just makes the view
+         * shorter. Anything unusual with trimming is left to trim_segment,
+         * which logs it
+         */
+        const auto* segment = file.contiguous(tell, len);
+        const auto single = attributes.size() == 1
+                        and not (attrs & DLIS_SEGATTR_SUCCSEG);
+        if (single and segment) {
+            int trim = 0;
+            const auto err = dlis_trim_record_segment(attrs,
+                                                      segment,
+                                                      segment + len,
+                                                      &trim);
+            if (err == DLIS_OK) {
+                view.ptr = segment;
+                view.len = std::size_t(len - trim);
+                view.attributes = attrs & fmtenc;
+                view.type = type;
+                return view;
+            }
+        }
+
+        view.stitched = true;
+        const auto prevsize = view.buffer.size();
+        view.buffer.resize(prevsize + len);
+        auto* dst = view.buffer.data() + prevsize;
+        if (file.read(tell, dst, len) < std::size_t(len))
+            throw std::runtime_error("extract: unable to read LRS, file truncated");
+        tell += len;
+
+        trim_segment(attrs, dst, len, view.buffer, start, errorhandler);
+
+        if (attrs & DLIS_SEGATTR_SUCCSEG) continue;
+
+        view.attributes = attributes.front() & fmtenc;
+        view.type = types.front();
+        if (not attr_consistent( attributes )) view.consistent = false;
+        if (not type_consistent( types ))      view.consistent = false;
+        return view;
+    }
+}
+
+namespace {
+
+/*
+ * A stream over the raw file that strips the visible record envelopes itself,
+ * for findoffsets. The file is read sequentially in large blocks, and the
+ * envelopes and segment headers are parsed out of the block, so a logical
+ * file of small segments costs a handful of reads, rather than a read and a
+ * seek (through every protocol layer of lfp) per segment.
+ *
+ * Tells are logical, i.e. the same as on a stream opened with open_rp66 at
+ * from. Seeking is forward only, except back into the current visible
+ * record, or to the start of the last read, which is all findoffsets needs.
+ */
+class vr_cursor {
+public:
+    vr_cursor( dl::stream& file,
+               long long from,
+               vr_index* index = nullptr ) noexcept (false)
+        : file(file), index(index), base(from) {
+        this->file.seek(from);
+    }
+
+    std::int64_t read( char* dst, int n ) noexcept (false);
+    void seek( std::int64_t tell ) noexcept (false);
+    bool eof() const noexcept (true) { return this->at_eof; }
+
+    /* physical offset of the cursor, like stream::absolute_tell() */
+    long long absolute_tell() const noexcept (true) {
+        return this->base + this->pos;
+    }
+
+private:
+    static constexpr std::size_t blocksize = 1 << 20;
+
+    /*
+     * Make sure at least n bytes are buffered, or as many as are left in the
+     * file. Returns the number of bytes available.
+     */
+    std::size_t buffered( std::size_t n ) noexcept (false);
+    /* Move to the body of the next non-empty visible record */
+    bool next_record() noexcept (false);
+    /* Move the raw file, and drop the block */
+    void reposition( long long offset ) noexcept (false);
+
+    dl::stream& file;
+    /* visible records read so far, if asked for */
+    vr_index* index;
+    std::vector< char > block;
+    std::size_t pos = 0;     /* next unread byte in block */
+    long long base;          /* physical offset of block[0] */
+    std::int64_t tell = 0;   /* logical offset */
+    int left = 0;            /* bytes left of the current visible record */
+    int consumed = 0;        /* bytes read of the current visible record */
+    bool at_eof = false;
+    /* seeked past end-of-file, so the next read is truncated */
+    bool past_end = false;
+
+    /* where the last read started, to be able to seek back to it */
+    struct {
+        long long offset = -1;
+        std::int64_t tell;
+        int left;
+        int consumed;
+    } mark;
+};
+
+std::size_t vr_cursor::buffered( std::size_t n ) noexcept (false) {
+    const auto available = this->block.size() - this->pos;
+    if (available >= n) return available;
+
+    /* drop the consumed bytes and top up with the next block from the file */
+    this->block.erase(this->block.begin(), this->block.begin() + this->pos);
+    this->base += this->pos;
+    this->pos = 0;
+
+    const auto prev = this->block.size();
+    const auto want = std::max(n - prev, std::size_t(blocksize));
+    this->block.resize(prev + want);
+    const auto nread = this->file.read(this->block.data() + prev, int(want));
+    this->block.resize(prev + std::size_t(nread));
+    return this->block.size();
+}
+
+void vr_cursor::reposition( long long offset ) noexcept (false) {
+    this->file.seek(offset);
+    this->block.clear();
+    this->pos = 0;
+    this->base = offset;
+}
+
+bool vr_cursor::next_record() noexcept (false) {
+    while (this->left == 0) {
+        const auto available = this->buffered(DLIS_VRL_SIZE);
+        if (available == 0) return false;
+        if (available < DLIS_VRL_SIZE)
+            throw std::runtime_error("rp66: unexpected EOF when reading "
+                                     "visible record header");
+
+        int len, version;
+        dlis_vrl(this->block.data() + this->pos, &len, &version);
+        if (version != 1) {
+            const auto msg = "rp66: Incorrect format version in Visible "
+                             "Record at {}, expected 1, was {}";
+            throw std::runtime_error(
+                fmt::format(msg, this->base + this->pos, version)
+            );
+        }
+        if (len < DLIS_VRL_SIZE) {
+            const auto msg = "rp66: Too short Visible Record at {}, length "
+                             "can't be less than 4, but was {}";
+            throw std::runtime_error(
+                fmt::format(msg, this->base + this->pos, len)
+            );
+        }
+
+        if (this->index)
+            this->index->append(this->base + this->pos, len);
+
+        this->pos += DLIS_VRL_SIZE;
+        this->left = len - DLIS_VRL_SIZE;
+        this->consumed = 0;
+    }
+    return true;
+}
+
+std::int64_t vr_cursor::read( char* dst, int n ) noexcept (false) {
+    if (this->past_end)
+        throw std::runtime_error("rp66: unexpected EOF when reading record");
+
+    this->mark.offset = -1;
+    int nread = 0;
+    while (nread < n) {
+        if (not this->next_record()) {
+            this->at_eof = true;
+            return nread;
+        }
+
+        if (this->mark.offset < 0) {
+            this->mark.offset   = this->absolute_tell();
+            this->mark.tell     = this->tell;
+            this->mark.left     = this->left;
+            this->mark.consumed = this->consumed;
+        }
+
+        const auto k = std::min(n - nread, this->left);
+        if (this->buffered(k) < std::size_t(k))
+            throw std::runtime_error("rp66: unexpected EOF when reading "
+                                     "record");
+
+        std::memcpy(dst + nread, this->block.data() + this->pos, k);
+        this->pos      += k;
+        this->left     -= k;
+        this->consumed += k;
+        this->tell     += k;
+        nread += k;
+    }
+    this->at_eof = false;
+    return nread;
+}
+
+void vr_cursor::seek( std::int64_t tell ) noexcept (false) {
+    this->at_eof = false;
+
+    if (tell < this->tell) {
+        const auto back = this->tell - tell;
+        if (back <= this->consumed and std::size_t(back) <= this->pos) {
+            this->pos      -= back;
+            this->left     += back;
+            this->consumed -= back;
+            this->tell      = tell;
+            return;
+        }
+
+        if (tell != this->mark.tell or this->mark.offset < 0) {
+            const auto msg = "vr_cursor: cannot seek back to {} from {}";
+            throw std::logic_error(fmt::format(msg, tell, this->tell));
+        }
+
+        this->reposition(this->mark.offset);
+        this->tell     = this->mark.tell;
+        this->left     = this->mark.left;
+        this->consumed = this->mark.consumed;
+        this->past_end = false;
+        return;
+    }
+
+    while (this->tell < tell) {
+        if (not this->next_record()) {
+            this->past_end = true;
+            return;
+        }
+
+        const auto k = int(std::min< std::int64_t >(tell - this->tell,
+                                                    this->left));
+        const auto available = this->block.size() - this->pos;
+        if (std::size_t(k) <= available) {
+            this->pos += k;
+        } else {
+            /*
+             * Large segments are skipped by seeking past them, rather than
+             * reading them into the block. If the file is truncated, the
+             * next read finds out
+             */
+            this->reposition(this->absolute_tell() + k);
+        }
+        this->left     -= k;
+        this->consumed += k;
+        this->tell     += k;
+    }
+}
+
+void suspend_indexing( dl::error_handler& errorhandler,
+                       const std::string& problem )
+noexcept (false) {
+    const auto context = "dl::findoffsets (indexing logical file)";
+    errorhandler.log(dl::error_severity::CRITICAL, context, problem, "",
+                     "Indexing is suspended at last valid Logical Record");
+}
+
+/*
+ * The segment walk of findoffsets. Stream is dl::stream, or anything else with
+ * the same read, eof and seek.
+ */
+template < typename Stream >
+stream_offsets walk_segments( Stream& file,
+                              dl::error_handler& errorhandler,
+                              bool verify )
 noexcept (false) {
     stream_offsets ofs;
 
@@ -405,11 +1036,10 @@ noexcept (false) {
 
     bool has_successor = false;
     char buffer[ DLIS_LRSH_SIZE ];
+    std::vector< char > segment;
 
     const auto handle = [&]( const std::string& problem ) {
-        const auto context = "dl::findoffsets (indexing logical file)";
-        errorhandler.log(dl::error_severity::CRITICAL, context, problem, "",
-                         "Indexing is suspended at last valid Logical Record");
+        suspend_indexing(errorhandler, problem);
         ofs.broken.push_back( lr_offset );
     };
 
@@ -457,6 +1087,7 @@ noexcept (false) {
         int type;
         std::uint8_t attrs;
         dlis_lrsh( buffer, &len, &attrs, &type );
+        dl::stats::add(dl::stats::segments);
         if (len < 4) {
             const auto problem =
                 "Too short logical record. Length can't be less than 4, "
@@ -506,16 +1137,53 @@ noexcept (false) {
          * TODO: assure behavior for other io types
          */
 
-        char tmp;
-        file.seek(lrs_offset - 1);
-        try {
-            file.read(&tmp, 1);
-        } catch (const std::runtime_error& e) {
+        const bool checksummed = verify
+                             and (attrs & DLIS_SEGATTR_CHCKSUM)
+                             and not (attrs & DLIS_SEGATTR_ENCRYPT);
+
+        bool truncated = false;
+        if (not checksummed) {
+            char tmp;
+            file.seek(lrs_offset - 1);
+            try {
+                file.read(&tmp, 1);
+            } catch (const std::runtime_error& e) {
+                truncated = true;
+            }
+        } else {
+            /*
+             * The whole segment is needed for the checksum, and reading it
+             * detects truncation just as well
+             */
+            const auto size = len - DLIS_LRSH_SIZE;
+            segment.resize(size);
+            try {
+                truncated = file.read(segment.data(), size) < size;
+            } catch (const std::runtime_error& e) {
+                truncated = true;
+            }
+        }
+
+        if (truncated) {
             const auto problem = "File truncated in Logical Record Segment";
             handle(problem);
             break;
         }
 
+        if (checksummed) {
+            const auto ok = verify_checksum(attrs,
+                                            buffer,
+                                            segment.data(),
+                                            len,
+                                            lrs_offset - len,
+                                            "dl::findoffsets (checksum)",
+                                            "Record is indexed as-is",
+                                            errorhandler);
+            const auto& bad = ofs.corrupt;
+            if (not ok and (bad.empty() or bad.back() != lr_offset))
+                ofs.corrupt.push_back( lr_offset );
+        }
+
 
         if (not (has_successor)) {
             if (isexplicit)
@@ -536,54 +1204,1286 @@ noexcept (false) {
     return ofs;
 }
 
-std::map< dl::ident, std::vector< long long > >
-findfdata(dl::stream& file, const std::vector< long long >& tells,
-dl::error_handler& errorhandler) noexcept (false) {
-    std::map< dl::ident, std::vector< long long > > xs;
+}
 
-    constexpr std::size_t OBNAME_SIZE_MAX = 262;
+stream_offsets findoffsets( dl::stream& file,
+                            dl::error_handler& errorhandler,
+                            bool verify )
+noexcept (false) {
+    dl::stats::timer timer(dl::stats::findoffsets);
+    return walk_segments(file, errorhandler, verify);
+}
 
-    record rec;
-    rec.data.reserve( OBNAME_SIZE_MAX );
+stream_offsets findoffsets( dl::stream& file,
+                            long long from,
+                            long long& end,
+                            dl::error_handler& errorhandler,
+                            bool verify,
+                            vr_index* vrs )
+noexcept (false) {
+    dl::stats::timer timer(dl::stats::findoffsets);
+    vr_cursor cursor(file, from, vrs);
+    const auto ofs = walk_segments(cursor, errorhandler, verify);
+    end = cursor.absolute_tell();
+    return ofs;
+}
 
-    const auto handle = [&]( const std::string& problem ) {
-        const auto context = "dl::findfdata: Indexing implicit records";
-        errorhandler.log(dl::error_severity::CRITICAL, context, problem, "",
-                         "Record is skipped");
-    };
+namespace {
 
-    for (auto tell : tells) {
-        try {
-            extract(file, tell, OBNAME_SIZE_MAX, rec, errorhandler);
-        } catch (std::exception& e) {
-            handle(e.what());
-            continue;
-        }
+int open_readonly(const std::string& path) noexcept (false) {
+#ifdef _WIN32
+    const auto fd = _open(path.c_str(), _O_RDONLY | _O_BINARY);
+#else
+    const auto fd = ::open(path.c_str(), O_RDONLY);
+#endif
+    if (fd < 0) {
+        auto msg = "unable to open file for path {} : {}";
+        throw dl::io_error(fmt::format(msg, path, strerror(errno)));
+    }
+    return fd;
+}
+
+void close_fd(int fd) noexcept (true) {
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
 
-        if (rec.isencrypted()) continue;
-        if (rec.type != 0) continue;
-        if (rec.data.size() == 0) continue;
+long long filesize(int fd) noexcept (false) {
+#ifdef _WIN32
+    const auto size = _lseeki64(fd, 0, SEEK_END);
+#else
+    const auto size = ::lseek(fd, 0, SEEK_END);
+#endif
+    if (size < 0) throw io_error(errno);
+    return (long long)size;
+}
 
-        int32_t origin;
-        uint8_t copy;
-        int32_t idlen;
-        char id[ 256 ];
-        const char* cur = dlis_obname(rec.data.data(), &origin, &copy, &idlen, id);
+/*
+ * A positional read of n bytes at offset, or fewer at end-of-file
+ */
+std::size_t pread_full(int fd, char* dst, std::size_t n, long long offset)
+noexcept (false) {
+    std::size_t nread = 0;
+#ifdef _WIN32
+    /* there is no pread, so the reads are serialised */
+    static std::mutex lock;
+    std::lock_guard< std::mutex > guard(lock);
+    if (_lseeki64(fd, offset, SEEK_SET) < 0)
+        throw io_error(errno);
+
+    while (nread < n) {
+        const auto k = _read(fd, dst + nread, unsigned(n - nread));
+        if (k < 0) throw io_error(errno);
+        if (k == 0) break;
+        nread += std::size_t(k);
+    }
+#else
+    while (nread < n) {
+        const auto k = ::pread(fd, dst + nread, n - nread, off_t(offset + nread));
+        if (k < 0 and errno == EINTR) continue;
+        if (k < 0) throw io_error(errno);
+        if (k == 0) break;
+        nread += std::size_t(k);
+    }
+#endif
+    dl::stats::add(dl::stats::bytes_read, nread);
+    return nread;
+}
 
-        std::size_t obname_size = cur - rec.data.data();
-        if (obname_size > rec.data.size()) {
-            const auto problem =
-                "fdata record corrupted, error on reading obname";
-            handle(problem);
-            continue;
+/*
+ * A stream over the raw file for batch_reader, with the same tells as a
+ * stream opened with open_rp66. The visible record that holds the tell is
+ * looked up in the index and read whole, with a single positional read, so
+ * any number of cursors can read the same file at the same time.
+ */
+class pread_cursor {
+public:
+    pread_cursor( int fd, const vr_index& vrs ) noexcept (true)
+        : fd(fd), vrs(vrs) {}
+
+    std::int64_t read( char* dst, int n ) noexcept (false);
+    void seek( std::int64_t tell ) noexcept (true) { this->pos = tell; }
+    std::int64_t tell() const noexcept (true) { return this->pos; }
+
+private:
+    /* Read the visible record that holds tell, false if there is none */
+    bool load( long long tell ) noexcept (false);
+
+    int fd;
+    const vr_index& vrs;
+    std::vector< char > block;
+    long long block_tell = 0;   /* logical tell of block[0] */
+    std::int64_t pos = 0;
+};
+
+bool pread_cursor::load( long long tell ) noexcept (false) {
+    vr_index::extent vr;
+    if (not this->vrs.find(tell, vr)) return false;
+
+    this->block.resize(vr.size);
+    const auto nread = pread_full(this->fd,
+                                  this->block.data(),
+                                  vr.size,
+                                  vr.offset);
+    this->block.resize(nread);
+    this->block_tell = vr.tell;
+    return true;
+}
+
+std::int64_t pread_cursor::read( char* dst, int n ) noexcept (false) {
+    int nread = 0;
+    while (nread < n) {
+        auto offset = this->pos - this->block_tell;
+        if (offset < 0 or offset >= (long long)this->block.size()) {
+            if (not this->load(this->pos)) break;
+            offset = this->pos - this->block_tell;
+            /* the file is truncated */
+            if (offset >= (long long)this->block.size()) break;
         }
-        dl::obname tmp{ dl::origin{ origin },
-                        dl::ushort{ copy },
-                        dl::ident{ std::string{ id, id + idlen } } };
 
-        xs[tmp.fingerprint("FRAME")].push_back( tell );
+        const auto k = int(std::min< long long >(n - nread,
+                                                 this->block.size() - offset));
+        std::memcpy(dst + nread, this->block.data() + offset, k);
+        nread     += k;
+        this->pos += k;
     }
-    return xs;
+    return nread;
+}
+
+/*
+ * An error handler that keeps the problems of a worker thread, to be passed
+ * on to the real handler by the thread that owns it
+ */
+class deferred_errors : public error_handler {
+public:
+    void log(const error_severity& level,
+             const std::string& context,
+             const std::string& problem,
+             const std::string& specification,
+             const std::string& action) const noexcept (false) override {
+        entry e {};
+        e.reported = false;
+        e.context = context;
+        e.error = { level, problem, specification, action };
+        this->entries.push_back(std::move(e));
+    }
+
+    void report(const error_report& r) const noexcept (false) override {
+        entry e {};
+        e.reported = true;
+        e.first = r;
+        this->entries.push_back(std::move(e));
+    }
+
+    void replay(const error_handler& dst) const noexcept (false) {
+        for (const auto& e : this->entries) {
+            if (e.reported) {
+                dst.report(e.first);
+                continue;
+            }
+            dst.log(e.error.severity, e.context, e.error.problem,
+                    e.error.specification, e.error.action);
+        }
+    }
+
+private:
+    struct entry {
+        bool reported;
+        error_report first;    // if reported
+        std::string context;   // if logged
+        dlis_error error;      // if logged
+    };
+
+    mutable std::vector< entry > entries;
+};
+
+}
+
+void vr_index::append(long long offset, int length) noexcept (false) {
+    if (length <= DLIS_VRL_SIZE) return;
+
+    if (not this->runs.empty()) {
+        auto& last = this->runs.back();
+        const auto next = last.offset + last.count * last.length;
+        if (offset < next) return;
+
+        if (offset == next and length == last.length) {
+            last.count += 1;
+            return;
+        }
+    }
+
+    this->runs.push_back({ this->end(), offset, length, 1 });
+}
+
+void vr_index::append(const vr_index& other, long long until)
+noexcept (false) {
+    for (const auto& r : other.runs) {
+        for (long long i = 0; i < r.count; ++i) {
+            const auto offset = r.offset + i * r.length;
+            if (offset >= until) return;
+            this->append(offset, r.length);
+        }
+    }
+}
+
+bool vr_index::find(long long tell, extent& vr) const noexcept (true) {
+    const auto lt = [](long long x, const run& r) { return x < r.tell; };
+    auto itr = std::upper_bound(this->runs.begin(), this->runs.end(), tell, lt);
+    if (itr == this->runs.begin()) return false;
+    --itr;
+
+    const long long body = itr->length - DLIS_VRL_SIZE;
+    const auto i = (tell - itr->tell) / body;
+    if (i >= itr->count) return false;
+
+    vr.tell   = itr->tell + i * body;
+    vr.offset = itr->offset + i * itr->length + DLIS_VRL_SIZE;
+    vr.size   = std::size_t(body);
+    return true;
+}
+
+std::size_t vr_index::size() const noexcept (true) {
+    long long n = 0;
+    for (const auto& r : this->runs)
+        n += r.count;
+    return std::size_t(n);
+}
+
+long long vr_index::end() const noexcept (true) {
+    if (this->runs.empty()) return 0;
+    const auto& last = this->runs.back();
+    return last.tell + last.count * (last.length - DLIS_VRL_SIZE);
+}
+
+/*
+ * The threads of a batch reader, beyond the calling thread, which run the
+ * tasks in the queue until the pool is stopped. Every thread has its own
+ * cursor, which is kept between tasks.
+ */
+struct batch_reader::worker_pool {
+    using task = std::function< void (pread_cursor&) >;
+
+    std::mutex lock;
+    std::condition_variable wake;
+    std::deque< task > tasks;
+    bool stopping = false;
+    std::vector< std::thread > threads;
+
+    void serve(int fd, const vr_index& vrs) noexcept (true) {
+        pread_cursor cursor(fd, vrs);
+        while (true) {
+            task next;
+            {
+                std::unique_lock< std::mutex > guard(this->lock);
+                this->wake.wait(guard, [this] {
+                    return this->stopping or not this->tasks.empty();
+                });
+                if (this->tasks.empty()) return;
+                next = std::move(this->tasks.front());
+                this->tasks.pop_front();
+            }
+            next(cursor);
+        }
+    }
+};
+
+batch_reader::batch_reader(const std::string& path, vr_index vrs, int depth)
+noexcept (false)
+    : fd(-1)
+    , vrs(std::move(vrs))
+    , queue_depth(std::max(1, depth))
+    , workers(new worker_pool())
+{
+    this->fd = open_readonly(path);
+
+    try {
+        for (int i = 1; i < this->queue_depth; ++i) {
+            this->workers->threads.emplace_back(
+                &worker_pool::serve, this->workers.get(),
+                this->fd, std::cref(this->vrs)
+            );
+        }
+    } catch (...) {
+        this->close();
+        throw;
+    }
+}
+
+batch_reader::~batch_reader() {
+    this->close();
+}
+
+void batch_reader::close() noexcept (true) {
+    if (this->workers) {
+        {
+            std::lock_guard< std::mutex > guard(this->workers->lock);
+            this->workers->stopping = true;
+        }
+        this->workers->wake.notify_all();
+        for (auto& t : this->workers->threads) t.join();
+        this->workers.reset();
+    }
+
+    if (this->fd < 0) return;
+    close_fd(this->fd);
+    this->fd = -1;
+}
+
+int batch_reader::depth() const noexcept (true) {
+    return this->queue_depth;
+}
+
+const vr_index& batch_reader::index() const noexcept (true) {
+    return this->vrs;
+}
+
+std::vector< batch_record >
+batch_reader::extract(const std::vector< long long >& tells,
+                      long long bytes,
+                      dl::error_handler& errorhandler,
+                      bool verify)
+const noexcept (false) {
+    if (this->fd < 0)
+        throw io_error("batch_reader: file is closed");
+
+    const auto n = tells.size();
+    std::vector< batch_record > recs(n);
+    std::vector< deferred_errors > problems(n);
+    if (n == 0) return recs;
+
+    /*
+     * Threads take chunks of neighbouring records, so that records in the
+     * same visible record are usually read by the same cursor
+     */
+    const auto nthreads = std::min(std::size_t(this->queue_depth), n);
+    const auto chunk = std::max(std::size_t(1),
+                                std::min(std::size_t(64), n / (4 * nthreads)));
+
+    std::atomic< std::size_t > next{ 0 };
+    std::exception_ptr failure;
+    std::mutex failure_lock;
+    const auto work = [&](pread_cursor& cursor) {
+        try {
+            while (true) {
+                const auto begin = next.fetch_add(chunk);
+                if (begin >= n) return;
+
+                const auto end = std::min(n, begin + chunk);
+                for (auto i = begin; i < end; ++i) {
+                    auto& rec = recs[i];
+                    rec.tell = tells[i];
+                    try {
+                        extract_record(cursor, rec.tell, bytes, rec.record,
+                                       problems[i], verify);
+                    } catch (const std::exception& e) {
+                        rec.error = e.what();
+                    }
+                }
+            }
+        } catch (...) {
+            std::lock_guard< std::mutex > lock(failure_lock);
+            if (not failure) failure = std::current_exception();
+            next = n;
+        }
+    };
+
+    /*
+     * The tasks refer to this call's state, so all of them must be done, not
+     * just every chunk taken, before returning. The calling thread works too,
+     * so the batch is read even when the workers are busy with other calls.
+     */
+    std::mutex done_lock;
+    std::condition_variable done;
+    auto running = nthreads - 1;
+    const auto task = [&](pread_cursor& cursor) {
+        work(cursor);
+        std::lock_guard< std::mutex > guard(done_lock);
+        if (--running == 0) done.notify_one();
+    };
+
+    if (running > 0) {
+        {
+            std::lock_guard< std::mutex > guard(this->workers->lock);
+            for (std::size_t i = 0; i < running; ++i)
+                this->workers->tasks.push_back(task);
+        }
+        this->workers->wake.notify_all();
+    }
+
+    pread_cursor cursor(this->fd, this->vrs);
+    work(cursor);
+
+    {
+        std::unique_lock< std::mutex > guard(done_lock);
+        done.wait(guard, [&] { return running == 0; });
+    }
+
+    if (failure) std::rethrow_exception(failure);
+
+    for (const auto& p : problems)
+        p.replay(errorhandler);
+
+    return recs;
+}
+
+namespace {
+
+/*
+ * Random access to the raw file in large blocks, with positional reads
+ */
+class block_cursor {
+public:
+    block_cursor( int fd, long long size ) noexcept (true)
+        : fd(fd), size(size) {}
+
+    /*
+     * Pointer to the n bytes at offset, or nullptr if the file ends before
+     * that. The pointer is valid until the next call.
+     */
+    const char* at( long long offset, std::size_t n ) noexcept (false);
+
+private:
+    static constexpr std::size_t blocksize = 1 << 20;
+
+    int fd;
+    long long size;
+    std::vector< char > block;
+    long long base = -1;    /* physical offset of block[0] */
+};
+
+const char* block_cursor::at( long long offset, std::size_t n )
+noexcept (false) {
+    if (offset + (long long)n > this->size) return nullptr;
+
+    const auto begin = offset - this->base;
+    if (this->base >= 0 and begin >= 0
+        and begin + (long long)n <= (long long)this->block.size())
+        return this->block.data() + begin;
+
+    const auto left = std::size_t(this->size - offset);
+    this->block.resize(std::min(left, std::max(n, std::size_t(blocksize))));
+    const auto nread = pread_full(this->fd,
+                                  this->block.data(),
+                                  this->block.size(),
+                                  offset);
+    this->block.resize(nread);
+    this->base = offset;
+    if (nread < n) return nullptr;
+    return this->block.data();
+}
+
+/*
+ * The part of the logical file whose visible record headers are in
+ * [begin, limit), indexed on its own. Tells are relative to the first visible
+ * record of the shard, as its logical offset is not known until the shards
+ * before it are indexed.
+ *
+ * Only what the sequential walk needs to carry on from the shard is kept:
+ * where the records end, and the segments that could be the FILE-HEADER of
+ * the next logical file.
+ */
+struct shard {
+    long long begin = -1;  /* first visible record, -1 if none was found */
+    long long limit = 0;
+    long long next = 0;    /* first visible record at or after limit */
+    long long bytes = 0;   /* logical size */
+    vr_index vrs;
+
+    struct record {
+        long long end;      /* tell after the last segment */
+        bool isexplicit;
+    };
+    std::vector< record > records;
+
+    /* segment that is explicit, type 0 and without predecessor */
+    struct header {
+        std::size_t records;    /* records that end before it */
+        std::size_t segments;   /* segments up to and including it */
+        long long offset;       /* physical offset of the header */
+        bool first;             /* first segment of the shard */
+        bool after_successor;   /* previous segment expects a successor */
+    };
+    std::vector< header > headers;
+
+    std::size_t segments = 0;
+    bool has_segments = false;
+    bool has_successor = false; /* last segment expects a successor */
+
+    /*
+     * The walk stopped at something that is not a well-formed visible record
+     * of whole segments, which is left to the sequential findoffsets.
+     */
+    bool irregular = false;
+
+    /* the walk stopped early, at the first FILE-HEADER, see walk_shard */
+    bool truncated = false;
+};
+
+/*
+ * Walk the visible records and segment headers from begin, until the first
+ * visible record at or after limit.
+ *
+ * Only well-formed visible records are accepted, i.e. records that are all
+ * in the file, and that are exactly filled by segments. This is what rp66
+ * requires, and it means that every visible record starts with a segment
+ * header, so a shard can be indexed without knowing what came before it.
+ *
+ * With stop, the walk also stops after the visible record of the first
+ * FILE-HEADER that comes after an explicit record, as that is usually where
+ * the logical file ends, and nothing after it is needed. explicits is if an
+ * explicit record is known to come before begin.
+ */
+void walk_shard( block_cursor& file,
+                 long long size,
+                 long long begin,
+                 long long limit,
+                 shard& sh,
+                 bool stop = false,
+                 bool explicits = true )
+noexcept (false) {
+    sh = shard();
+    sh.begin = begin;
+    sh.limit = limit;
+
+    long long offset = begin;
+    long long tell = 0;
+    bool found = false;
+    while (offset < limit and offset < size) {
+        if (found) {
+            sh.truncated = true;
+            break;
+        }
+
+        const auto* head = file.at(offset, DLIS_VRL_SIZE);
+        if (not head) { sh.irregular = true; break; }
+
+        int len, version;
+        dlis_vrl(head, &len, &version);
+        if (version != 1 or len < DLIS_VRL_SIZE or offset + len > size) {
+            sh.irregular = true;
+            break;
+        }
+        sh.vrs.append(offset, len);
+
+        const auto end = offset + len;
+        auto pos = offset + DLIS_VRL_SIZE;
+        while (pos < end) {
+            const auto* lrsh = end - pos < DLIS_LRSH_SIZE
+                             ? nullptr
+                             : file.at(pos, DLIS_LRSH_SIZE);
+            if (not lrsh) { sh.irregular = true; break; }
+
+            int seglen, type;
+            std::uint8_t attrs;
+            dlis_lrsh(lrsh, &seglen, &attrs, &type);
+            if (seglen < DLIS_LRSH_SIZE or pos + seglen > end) {
+                sh.irregular = true;
+                break;
+            }
+
+            const bool isexplicit = attrs & DLIS_SEGATTR_EXFMTLR;
+            sh.segments += 1;
+            if (isexplicit and type == 0
+                and not (attrs & DLIS_SEGATTR_PREDSEG)) {
+                sh.headers.push_back({ sh.records.size(),
+                                       sh.segments,
+                                       pos,
+                                       not sh.has_segments,
+                                       sh.has_successor });
+                found = found or (stop and explicits);
+            }
+
+            sh.has_segments  = true;
+            sh.has_successor = attrs & DLIS_SEGATTR_SUCCSEG;
+            tell += seglen;
+            pos  += seglen;
+            if (not sh.has_successor) {
+                sh.records.push_back({ tell, isexplicit });
+                explicits = explicits or isexplicit;
+            }
+        }
+        if (sh.irregular) break;
+        offset = end;
+    }
+
+    sh.next  = offset;
+    sh.bytes = tell;
+    dl::stats::add(dl::stats::segments, sh.segments);
+}
+
+/*
+ * A sound visible record at offset, like soundvr with a chain of 2. This only
+ * needs to be good enough to usually find the right visible record, as the
+ * shards are checked against each other when stitched together.
+ */
+bool soundshard( block_cursor& file, long long size, long long offset )
+noexcept (false) {
+    const auto* head = file.at(offset, DLIS_VRL_SIZE);
+    if (not head) return false;
+
+    int len, version;
+    dlis_vrl(head, &len, &version);
+    if (std::uint8_t(head[2]) != 0xFF or version != 1) return false;
+    if (len < DLIS_VRL_SIZE + DLIS_LRSH_SIZE) return false;
+
+    const auto end = offset + len;
+    if (end > size) return false;
+
+    auto pos = offset + DLIS_VRL_SIZE;
+    while (pos < end) {
+        const auto* lrsh = end - pos < DLIS_LRSH_SIZE
+                         ? nullptr
+                         : file.at(pos, DLIS_LRSH_SIZE);
+        if (not lrsh) return false;
+
+        int seglen, type;
+        std::uint8_t attrs;
+        dlis_lrsh(lrsh, &seglen, &attrs, &type);
+        if (seglen < DLIS_LRSH_SIZE) return false;
+        pos += seglen;
+    }
+    if (pos != end) return false;
+    if (end == size) return true;
+
+    const auto* next = file.at(end, DLIS_VRL_SIZE);
+    if (not next) return false;
+    dlis_vrl(next, &len, &version);
+    return std::uint8_t(next[2]) == 0xFF
+       and version == 1
+       and len >= DLIS_VRL_SIZE;
+}
+
+/*
+ * The first sound visible record with a header in [from, limit), or -1
+ */
+long long resyncshard( int fd, long long size, long long from, long long limit )
+noexcept (false) {
+    block_cursor scan(fd, size);
+    block_cursor probe(fd, size);
+
+    constexpr long long blocksize = 1 << 20;
+    long long base = from;
+    while (base < limit) {
+        const auto n = std::min(blocksize, size - base);
+        if (n < DLIS_VRL_SIZE) return -1;
+
+        const auto* begin = scan.at(base, std::size_t(n));
+        if (not begin) return -1;
+
+        const auto* end = begin + n;
+        /* the length precedes the 0xFF, and the version follows it */
+        const auto* ptr = begin + 2;
+        while (ptr < end - 1) {
+            const auto* ff = static_cast< const char* >(
+                std::memchr(ptr, 0xFF, (end - 1) - ptr)
+            );
+            if (not ff) break;
+
+            const auto candidate = base + (ff - 2 - begin);
+            if (candidate >= limit) return -1;
+            if (ff[1] == 0x01 and soundshard(probe, size, candidate))
+                return candidate;
+
+            ptr = ff + 1;
+        }
+
+        base += n - 3;
+    }
+    return -1;
+}
+
+/*
+ * Index the shards of the file in parallel, and stitch them together. Returns
+ * false if the logical file is not well-formed, in which case nothing is
+ * reported to the error handler.
+ */
+bool walk_shards( int fd,
+                  long long size,
+                  long long from,
+                  int shards,
+                  long long& end,
+                  dl::error_handler& errorhandler,
+                  stream_offsets& ofs,
+                  vr_index& index )
+noexcept (false) {
+    /*
+     * Split the file into shards of the same size, and index them all at the
+     * same time. The first shard starts at from, the others at the first
+     * sound visible record after where they are split.
+     *
+     * Every shard stops at its first FILE-HEADER, so that indexing a logical
+     * file does not walk the rest of the file, which would make loading a
+     * file with many logical files quadratic. The first shard starts at the
+     * FILE-HEADER of this logical file, which does not count. For the other
+     * shards, an explicit record is assumed to come before them.
+     */
+    const auto span = (size - from) / shards;
+    std::vector< shard > parts(shards);
+    std::exception_ptr failure;
+    std::mutex failure_lock;
+    const auto work = [&](int i) {
+        try {
+            const auto first = from + i * span;
+            const auto limit = i + 1 == shards ? size : first + span;
+            block_cursor file(fd, size);
+            const auto begin = i == 0
+                             ? first
+                             : resyncshard(fd, size, first, limit);
+
+            if (begin < 0) {
+                parts[i].limit = limit;
+                return;
+            }
+            walk_shard(file, size, begin, limit, parts[i], true, i > 0);
+        } catch (...) {
+            std::lock_guard< std::mutex > lock(failure_lock);
+            if (not failure) failure = std::current_exception();
+        }
+    };
+
+    std::vector< std::thread > pool;
+    for (int i = 1; i < shards; ++i)
+        pool.emplace_back(work, i);
+    work(0);
+    for (auto& t : pool) t.join();
+
+    if (failure) std::rethrow_exception(failure);
+
+    /*
+     * Stitch the shards together, in order. A shard is only used if it starts
+     * at the visible record that the previous shard ended at, otherwise its
+     * visible record was a false positive, and it is indexed again from the
+     * right place. Where records end does not depend on where they start, so
+     * the records are just carried over, and the first record of a shard
+     * starts where the last record of the previous shard ended.
+     */
+    long long next = from;
+    long long base = 0;         /* logical offset of the current shard */
+    long long lr_offset = 0;    /* start of the current record */
+    bool has_successor = false;
+
+    const auto carry = [&](const shard& sh, std::size_t records) {
+        for (std::size_t k = 0; k < records; ++k) {
+            const auto& rec = sh.records[k];
+            if (rec.isexplicit)
+                ofs.explicits.push_back(lr_offset);
+            else
+                ofs.implicits.push_back(lr_offset);
+            lr_offset = base + rec.end;
+        }
+    };
+
+    /* true if the logical file ends at a FILE-HEADER in the shard */
+    const auto wrapup = [&](const shard& sh) {
+        std::size_t explicits = ofs.explicits.size();
+        std::size_t counted = 0;
+        for (const auto& header : sh.headers) {
+            for (; counted < header.records; ++counted)
+                explicits += sh.records[counted].isexplicit ? 1 : 0;
+
+            if (explicits == 0) continue;
+
+            /* The FILE-HEADER of the next logical file */
+            carry(sh, header.records);
+            index.append(sh.vrs, header.offset);
+
+            const auto successor = header.first
+                                 ? has_successor
+                                 : header.after_successor;
+            if (successor) {
+                const auto problem =
+                    "End of logical file, but last logical "
+                    "record segment expects successor";
+                suspend_indexing(errorhandler, problem);
+                ofs.broken.push_back(lr_offset);
+                end = header.offset + DLIS_LRSH_SIZE;
+            } else {
+                end = header.offset;
+            }
+            return true;
+        }
+        return false;
+    };
+
+    for (auto& sh : parts) {
+        /* the previous shard ended in a visible record that covers this one */
+        if (next >= sh.limit) continue;
+
+        if (sh.begin != next) {
+            block_cursor file(fd, size);
+            walk_shard(file, size, next, sh.limit, sh);
+        }
+
+        if (wrapup(sh)) return true;
+
+        /* it stopped at a FILE-HEADER that does not end the logical file */
+        if (sh.truncated) {
+            block_cursor file(fd, size);
+            walk_shard(file, size, next, sh.limit, sh);
+            if (wrapup(sh)) return true;
+        }
+
+        if (sh.irregular) return false;
+
+        carry(sh, sh.records.size());
+        index.append(sh.vrs);
+        if (sh.has_segments) has_successor = sh.has_successor;
+        base += sh.bytes;
+        next  = sh.next;
+    }
+
+    if (has_successor) {
+        const auto problem =
+            "Reached EOF, but last logical record segment expects "
+            "successor";
+        suspend_indexing(errorhandler, problem);
+        ofs.broken.push_back(lr_offset);
+    }
+
+    end = size;
+    return true;
+}
+
+}
+
+stream_offsets findoffsets( const std::string& path,
+                            long long from,
+                            long long& end,
+                            dl::error_handler& errorhandler,
+                            int shards,
+                            bool verify,
+                            vr_index* vrs )
+noexcept (false) {
+    const auto sequential = [&]() {
+        auto file = dl::open(path, 0);
+        try {
+            const auto ofs = findoffsets(file, from, end, errorhandler,
+                                         verify, vrs);
+            file.close();
+            return ofs;
+        } catch (...) {
+            file.close();
+            throw;
+        }
+    };
+
+    /*
+     * Checksums are verified by reading every segment in full, which is
+     * left to the sequential findoffsets
+     */
+    if (verify) return sequential();
+
+    const auto fd = open_readonly(path);
+    struct guard {
+        int fd;
+        ~guard() { close_fd(this->fd); }
+    } closing { fd };
+
+    const auto size = filesize(fd);
+    if (from < 0 or from > size) return sequential();
+
+    if (shards <= 0) {
+        /* a thread per core, but no smaller than 64MB per shard */
+        const auto cores = std::max(1u, std::thread::hardware_concurrency());
+        const auto large = (size - from) / (64LL << 20);
+        shards = int(std::max(1LL, std::min(large, (long long)cores)));
+    }
+    shards = int(std::max(1LL, std::min((long long)shards, size - from)));
+
+    stream_offsets ofs;
+    vr_index index;
+    bool regular;
+    {
+        dl::stats::timer timer(dl::stats::findoffsets);
+        regular = walk_shards(fd, size, from, shards, end, errorhandler,
+                              ofs, index);
+    }
+    if (not regular) return sequential();
+
+    if (vrs) vrs->append(index);
+    return ofs;
+}
+
+namespace {
+
+/* the obname, and the frame number (uvari) of the first frame */
+constexpr std::size_t OBNAME_SIZE_MAX = 262;
+constexpr std::size_t FDATA_HEADER_SIZE_MAX = OBNAME_SIZE_MAX + 4;
+
+void index_fdata_record(const record& rec,
+                        long long tell,
+                        std::map< dl::ident, std::vector< fdata_record > >& xs,
+                        dl::error_handler& errorhandler)
+noexcept (false) {
+    if (rec.isencrypted()) return;
+    if (rec.type != 0) return;
+    if (rec.data.size() == 0) return;
+
+    int32_t origin;
+    uint8_t copy;
+    int32_t idlen;
+    char id[ 256 ];
+    const char* cur = dlis_obname(rec.data.data(), &origin, &copy, &idlen, id);
+
+    std::size_t obname_size = cur - rec.data.data();
+    if (obname_size > rec.data.size()) {
+        errorhandler.report({ dl::error_code::fdata_obname,
+                              dl::error_severity::CRITICAL,
+                              "dl::findfdata: Indexing implicit records",
+                              "Record is skipped",
+                              tell,
+                              { 0, 0 } });
+        return;
+    }
+    dl::obname tmp{ dl::origin{ origin },
+                    dl::ushort{ copy },
+                    dl::ident{ std::string{ id, id + idlen } } };
+
+    /*
+     * A truncated frame number is reported when the record is read, so
+     * it is simply not indexed here
+     */
+    std::int32_t frameno = -1;
+    const auto remaining = rec.data.size() - obname_size;
+    if (remaining > 0) {
+        const auto x = std::uint8_t(*cur);
+        const std::size_t len = (x & 0x80) == 0    ? 1
+                              : (x & 0xC0) == 0x80 ? 2
+                              : 4;
+        if (len <= remaining)
+            dlis_uvari(cur, &frameno);
+    }
+
+    xs[tmp.fingerprint("FRAME")].push_back({ tell, frameno });
+}
+
+void log_fdata_skipped(const std::string& problem,
+                       dl::error_handler& errorhandler)
+noexcept (false) {
+    const auto context = "dl::findfdata: Indexing implicit records";
+    errorhandler.log(dl::error_severity::CRITICAL, context, problem, "",
+                     "Record is skipped");
+}
+
+}
+
+std::map< dl::ident, std::vector< fdata_record > >
+indexfdata(dl::stream& file, const std::vector< long long >& tells,
+dl::error_handler& errorhandler) noexcept (false) {
+    dl::stats::timer timer(dl::stats::findfdata);
+    std::map< dl::ident, std::vector< fdata_record > > xs;
+
+    record rec;
+    rec.data.reserve( FDATA_HEADER_SIZE_MAX );
+
+    for (auto tell : tells) {
+        try {
+            extract(file, tell, FDATA_HEADER_SIZE_MAX, rec, errorhandler);
+        } catch (std::exception& e) {
+            log_fdata_skipped(e.what(), errorhandler);
+            continue;
+        }
+
+        index_fdata_record(rec, tell, xs, errorhandler);
+    }
+    return xs;
+}
+
+std::map< dl::ident, std::vector< fdata_record > >
+indexfdata(const batch_reader& file,
+           const std::vector< long long >& tells,
+           dl::error_handler& errorhandler)
+noexcept (false) {
+    dl::stats::timer timer(dl::stats::findfdata);
+    std::map< dl::ident, std::vector< fdata_record > > xs;
+
+    const auto recs = file.extract(tells, FDATA_HEADER_SIZE_MAX, errorhandler);
+    for (const auto& rec : recs) {
+        if (not rec.error.empty()) {
+            log_fdata_skipped(rec.error, errorhandler);
+            continue;
+        }
+
+        index_fdata_record(rec.record, rec.tell, xs, errorhandler);
+    }
+    return xs;
+}
+
+std::map< dl::ident, std::vector< long long > >
+findfdata(dl::stream& file, const std::vector< long long >& tells,
+dl::error_handler& errorhandler) noexcept (false) {
+    std::map< dl::ident, std::vector< long long > > xs;
+    for (const auto& frame : indexfdata(file, tells, errorhandler)) {
+        auto& dst = xs[frame.first];
+        dst.reserve(frame.second.size());
+        for (const auto& rec : frame.second)
+            dst.push_back(rec.tell);
+    }
+    return xs;
+}
+
+std::vector< long long > findframes(const std::vector< fdata_record >& recs,
+                                    std::int32_t first,
+                                    std::int32_t last)
+noexcept (false) {
+    /* the positions of the records with a frame number */
+    std::vector< std::size_t > xs;
+    xs.reserve(recs.size());
+    for (std::size_t i = 0; i < recs.size(); ++i) {
+        if (recs[i].frameno >= 0) xs.push_back(i);
+    }
+
+    const auto less = [&](std::size_t lhs, std::size_t rhs) {
+        return recs[lhs].frameno < recs[rhs].frameno;
+    };
+    const auto below = [&](std::size_t i, std::int32_t frameno) {
+        return recs[i].frameno < frameno;
+    };
+    const auto above = [&](std::int32_t frameno, std::size_t i) {
+        return frameno < recs[i].frameno;
+    };
+
+    auto begin = xs.begin();
+    auto end   = xs.end();
+    if (std::is_sorted(xs.begin(), xs.end(), less)) {
+        /*
+         * The frame 'first' may be the last frame of the record before the
+         * first record that starts at or after it
+         */
+        begin = std::lower_bound(xs.begin(), xs.end(), first, below);
+        if (begin != xs.begin()) --begin;
+        end = std::upper_bound(begin, xs.end(), last, above);
+    }
+
+    std::vector< char > selected(recs.size(), 0);
+    for (auto itr = begin; itr < end; ++itr)
+        selected[*itr] = 1;
+
+    /*
+     * Records without a frame number cannot be placed, so they are read, and
+     * whatever is wrong with them is reported by the reader
+     */
+    std::vector< long long > tells;
+    for (std::size_t i = 0; i < recs.size(); ++i) {
+        if (selected[i] or recs[i].frameno < 0)
+            tells.push_back(recs[i].tell);
+    }
+    return tells;
+}
+
+
+namespace {
+
+template < typename T >
+double todouble(const char* src) noexcept (true) {
+    T x;
+    std::memcpy(&x, src, sizeof(x));
+    return double(x);
+}
+
+double index_value(char fmt, const char* src) noexcept (false) {
+    switch (fmt) {
+        case DLIS_FMT_FSHORT:
+        case DLIS_FMT_FSINGL:
+        case DLIS_FMT_ISINGL:
+        case DLIS_FMT_VSINGL: return todouble< float >(src);
+        case DLIS_FMT_FDOUBL: return todouble< double >(src);
+        case DLIS_FMT_SSHORT: return todouble< std::int8_t >(src);
+        case DLIS_FMT_SNORM:  return todouble< std::int16_t >(src);
+        case DLIS_FMT_SLONG:  return todouble< std::int32_t >(src);
+        case DLIS_FMT_USHORT: return todouble< std::uint8_t >(src);
+        case DLIS_FMT_UNORM:  return todouble< std::uint16_t >(src);
+        case DLIS_FMT_ULONG:  return todouble< std::uint32_t >(src);
+        default: {
+            const auto msg = "indexvalues: unsupported index format '{}'";
+            throw dl::not_implemented(fmt::format(msg, fmt));
+        }
+    }
+}
+
+/* the obname, the frame number (uvari) and the index value */
+constexpr std::size_t INDEX_HEADER_SIZE_MAX = 262 + 4 + 8;
+
+/*
+ * On-disk size of an index value of format fmt, or throws if fmt cannot be
+ * used as an index
+ */
+int index_size(char fmt) noexcept (false) {
+    const char localfmt[] = { fmt, '\0' };
+    int srcsize;
+    const auto err = dlis_pack_size(localfmt, &srcsize, nullptr);
+    if (err != DLIS_OK or srcsize == 0) {
+        const auto msg = "indexvalues: unsupported index format '{}'";
+        throw dl::not_implemented(fmt::format(msg, fmt));
+    }
+    /* fail early on formats that cannot be converted */
+    char zeros[8] = {};
+    index_value(fmt, zeros);
+    return srcsize;
+}
+
+/*
+ * The index value of the first frame of the record, or NaN if the record has
+ * no (complete) first frame
+ */
+double first_index_value(const record& rec, char fmt, int srcsize)
+noexcept (false) {
+    const auto nan = std::numeric_limits< double >::quiet_NaN();
+    if (rec.isencrypted()) return nan;
+    if (rec.data.empty()) return nan;
+    const auto* begin = rec.data.data();
+    const auto* end = begin + rec.data.size();
+
+    std::int32_t origin;
+    std::uint8_t copy;
+    const auto* cur = dlis_obname(begin, &origin, &copy, nullptr, nullptr);
+    if (cur >= end) return nan;
+
+    const auto x = std::uint8_t(*cur);
+    cur += (x & 0x80) == 0    ? 1
+         : (x & 0xC0) == 0x80 ? 2
+         : 4;
+
+    if (cur + srcsize > end) return nan;
+
+    const char localfmt[] = { fmt, '\0' };
+    char value[8];
+    dlis_packf(localfmt, cur, value);
+    return index_value(fmt, value);
+}
+
+void log_index_skipped(const std::string& problem,
+                       dl::error_handler& errorhandler) noexcept (false) {
+    const auto context = "dl::indexvalues: Indexing implicit records";
+    errorhandler.log(dl::error_severity::MINOR, context, problem, "",
+                     "Record is not indexed");
+}
+
+}
+
+std::vector< double > indexvalues(dl::stream& file,
+                                  const std::vector< long long >& tells,
+                                  char fmt,
+                                  dl::error_handler& errorhandler)
+noexcept (false) {
+    const auto srcsize = index_size(fmt);
+    const auto nan = std::numeric_limits< double >::quiet_NaN();
+
+    record rec;
+    rec.data.reserve( INDEX_HEADER_SIZE_MAX );
+
+    std::vector< double > xs;
+    xs.reserve(tells.size());
+    for (auto tell : tells) {
+        try {
+            extract(file, tell, INDEX_HEADER_SIZE_MAX, rec, errorhandler);
+        } catch (std::exception& e) {
+            log_index_skipped(e.what(), errorhandler);
+            xs.push_back(nan);
+            continue;
+        }
+
+        xs.push_back(first_index_value(rec, fmt, srcsize));
+    }
+
+    return xs;
+}
+
+std::vector< double > indexvalues(const batch_reader& file,
+                                  const std::vector< long long >& tells,
+                                  char fmt,
+                                  dl::error_handler& errorhandler)
+noexcept (false) {
+    const auto srcsize = index_size(fmt);
+    const auto nan = std::numeric_limits< double >::quiet_NaN();
+
+    const auto recs = file.extract(tells, INDEX_HEADER_SIZE_MAX, errorhandler);
+
+    std::vector< double > xs;
+    xs.reserve(recs.size());
+    for (const auto& rec : recs) {
+        if (not rec.error.empty()) {
+            log_index_skipped(rec.error, errorhandler);
+            xs.push_back(nan);
+            continue;
+        }
+
+        xs.push_back(first_index_value(rec.record, fmt, srcsize));
+    }
+
+    return xs;
+}
+
+std::vector< long long > findindex(const std::vector< long long >& tells,
+                                   const std::vector< double >& values,
+                                   double top,
+                                   double bottom)
+noexcept (false) {
+    if (tells.size() != values.size()) {
+        const auto msg = "findindex: expected len(tells) ({}) "
+                         "== len(values) ({})";
+        throw std::invalid_argument(
+            fmt::format(msg, tells.size(), values.size())
+        );
+    }
+
+    /* the positions of the records with an index value */
+    std::vector< std::size_t > xs;
+    xs.reserve(values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (not std::isnan(values[i])) xs.push_back(i);
+    }
+
+    const auto lo = std::min(top, bottom);
+    const auto hi = std::max(top, bottom);
+
+    const auto increasing = [&](std::size_t lhs, std::size_t rhs) {
+        return values[lhs] < values[rhs];
+    };
+    const auto decreasing = [&](std::size_t lhs, std::size_t rhs) {
+        return values[lhs] > values[rhs];
+    };
+    const auto below = [&](std::size_t i, double x) { return values[i] < x; };
+    const auto above = [&](double x, std::size_t i) { return x < values[i]; };
+    const auto after = [&](std::size_t i, double x) { return values[i] > x; };
+    const auto before = [&](double x, std::size_t i) { return x > values[i]; };
+
+    /*
+     * In both directions, the first value of the range may be in the record
+     * before the first record that starts inside the range
+     */
+    auto begin = xs.begin();
+    auto end   = xs.end();
+    if (std::is_sorted(xs.begin(), xs.end(), increasing)) {
+        begin = std::lower_bound(xs.begin(), xs.end(), lo, below);
+        if (begin != xs.begin()) --begin;
+        end = std::upper_bound(begin, xs.end(), hi, above);
+    }
+    else if (std::is_sorted(xs.begin(), xs.end(), decreasing)) {
+        begin = std::lower_bound(xs.begin(), xs.end(), hi, after);
+        if (begin != xs.begin()) --begin;
+        end = std::upper_bound(begin, xs.end(), lo, before);
+    }
+
+    std::vector< char > selected(values.size(), 0);
+    for (auto itr = begin; itr < end; ++itr)
+        selected[*itr] = 1;
+
+    /*
+     * Records without an index value cannot be placed, so like in findframes
+     * they are always read, and what is wrong with them is reported by the
+     * reader
+     */
+    std::vector< long long > found;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (selected[i] or std::isnan(values[i]))
+            found.push_back(tells[i]);
+    }
+    return found;
 }
 
 }
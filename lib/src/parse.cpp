@@ -1,13 +1,16 @@
 #include <algorithm>
+#include <atomic>
 #include <bitset>
 #include <cstdlib>
 #include <cstring>
+#include <mutex>
 #include <string>
 #include <ciso646>
 
 #include <fmt/core.h>
 
 #include <dlisio/dlisio.h>
+#include <dlisio/ext/stats.hpp>
 #include <dlisio/ext/types.hpp>
 
 namespace {
@@ -691,7 +694,8 @@ bool basic_object::operator != (const basic_object& o) const noexcept (true) {
 }
 
 
-const char* object_set::parse_template(const char* cur) noexcept (false) {
+const char* object_set::parse_template(const char* cur)
+const noexcept (false) {
     const char* end = this->record.data.data() + this->record.data.size();
 
     while (true) {
@@ -929,7 +933,8 @@ void report_set_errors(const dl::object_set& eflr,
 
 }
 
-const char* object_set::parse_objects(const char* cur) noexcept (false) {
+const char* object_set::parse_objects(const char* cur)
+const noexcept (false) {
 
     const char* end = this->record.data.data() + this->record.data.size();
     const auto default_object = defaulted_object( tmpl );
@@ -1144,17 +1149,68 @@ const char* object_set::parse_set_component(const char* cur) noexcept (false) {
 
 object_set::object_set(dl::record rec) noexcept (false)  {
         this->record = std::move(rec);
-        parse_set_component(this->record.data.data());
+        const auto* begin = this->record.data.data();
+        const auto* cur = parse_set_component(begin);
+        this->template_offset = std::size_t(cur - begin);
+}
+
+object_set::object_set(const object_set& other) noexcept (false) {
+    *this = other;
+}
+
+object_set::object_set(object_set&& other) noexcept (false) {
+    *this = std::move(other);
+}
+
+object_set& object_set::operator = (const object_set& other)
+noexcept (false) {
+    if (this == &other) return *this;
+
+    std::lock_guard< std::mutex > guard(other.parse_lock);
+    this->role            = other.role;
+    this->type            = other.type;
+    this->name            = other.name;
+    this->log             = other.log;
+    this->record          = other.record;
+    this->template_offset = other.template_offset;
+    this->objs            = other.objs;
+    this->tmpl            = other.tmpl;
+    this->parsed          = other.parsed.load();
+    return *this;
+}
+
+object_set& object_set::operator = (object_set&& other) noexcept (false) {
+    if (this == &other) return *this;
+
+    std::lock_guard< std::mutex > guard(other.parse_lock);
+    this->role            = other.role;
+    this->type            = std::move(other.type);
+    this->name            = std::move(other.name);
+    this->log             = std::move(other.log);
+    this->record          = std::move(other.record);
+    this->template_offset = other.template_offset;
+    this->objs            = std::move(other.objs);
+    this->tmpl            = std::move(other.tmpl);
+    this->parsed          = other.parsed.load();
+    return *this;
 }
 
-void object_set::parse() noexcept (true) {
-    if (this->parsed) return;
+void object_set::parse() const noexcept (true) {
+    /*
+     * Double-checked, so that the common case of an already parsed set is a
+     * single atomic load. The release store publishes objs, tmpl and log to
+     * the threads that see parsed == true.
+     */
+    if (this->parsed.load(std::memory_order_acquire)) return;
 
-    const char* cur = this->record.data.data();
+    std::lock_guard< std::mutex > guard(this->parse_lock);
+    if (this->parsed.load(std::memory_order_relaxed)) return;
+    dl::stats::timer timer(dl::stats::parse);
+
+    /* the set component is parsed by the constructor */
+    const char* cur = this->record.data.data() + this->template_offset;
 
     try {
-        /* As cursor value is not stored, read data again to get the position */
-        cur = parse_set_component(cur);
         cur = parse_template(cur);
               parse_objects(cur);
     } catch (const std::exception& e) {
@@ -1172,10 +1228,11 @@ void object_set::parse() noexcept (true) {
      * be considered parsed. If set is parsed after that in error-escape mode,
      * parsing will be locked, but error will get stored on object set anyway.
      */
-    this->parsed = true;
+    dl::stats::add(dl::stats::objects, this->objs.size());
+    this->parsed.store(true, std::memory_order_release);
 }
 
-dl::object_vector& object_set::objects() noexcept (false) {
+const dl::object_vector& object_set::objects() const noexcept (false) {
     this->parse();
     return this->objs;
 }
@@ -1192,10 +1249,10 @@ object_vector pool::get(const std::string& type,
                         const std::string& name,
                         const dl::matcher& m,
                         const error_handler& errorhandler)
-noexcept (false) {
+const noexcept (false) {
     object_vector objs;
 
-    for (auto& eflr : this->eflrs) {
+    for (const auto& eflr : this->eflrs) {
         if (not m.match(dl::ident{type}, eflr.type)) continue;
 
         for (const auto& obj : eflr.objects()) {
@@ -1212,13 +1269,13 @@ noexcept (false) {
 object_vector pool::get(const std::string& type,
                         const dl::matcher& m,
                         const error_handler& errorhandler)
-noexcept (false) {
+const noexcept (false) {
     object_vector objs;
 
-    for (auto& eflr : this->eflrs) {
+    for (const auto& eflr : this->eflrs) {
         if (not m.match(dl::ident{type}, eflr.type)) continue;
 
-        auto tmp = eflr.objects();
+        const auto& tmp = eflr.objects();
         objs.insert(objs.end(), tmp.begin(), tmp.end());
 
         report_set_errors (eflr, errorhandler);
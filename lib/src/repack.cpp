@@ -0,0 +1,515 @@
+#include <algorithm>
+#include <ciso646>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include <dlisio/dlisio.h>
+#include <dlisio/types.h>
+
+#include <dlisio/ext/io.hpp>
+#include <dlisio/ext/repack.hpp>
+
+namespace {
+
+char fmtchar(int reprc) noexcept (false) {
+    switch (reprc) {
+        case DLIS_FSHORT: return DLIS_FMT_FSHORT;
+        case DLIS_FSINGL: return DLIS_FMT_FSINGL;
+        case DLIS_FSING1: return DLIS_FMT_FSING1;
+        case DLIS_FSING2: return DLIS_FMT_FSING2;
+        case DLIS_ISINGL: return DLIS_FMT_ISINGL;
+        case DLIS_VSINGL: return DLIS_FMT_VSINGL;
+        case DLIS_FDOUBL: return DLIS_FMT_FDOUBL;
+        case DLIS_FDOUB1: return DLIS_FMT_FDOUB1;
+        case DLIS_FDOUB2: return DLIS_FMT_FDOUB2;
+        case DLIS_CSINGL: return DLIS_FMT_CSINGL;
+        case DLIS_CDOUBL: return DLIS_FMT_CDOUBL;
+        case DLIS_SSHORT: return DLIS_FMT_SSHORT;
+        case DLIS_SNORM:  return DLIS_FMT_SNORM;
+        case DLIS_SLONG:  return DLIS_FMT_SLONG;
+        case DLIS_USHORT: return DLIS_FMT_USHORT;
+        case DLIS_UNORM:  return DLIS_FMT_UNORM;
+        case DLIS_ULONG:  return DLIS_FMT_ULONG;
+        case DLIS_UVARI:  return DLIS_FMT_UVARI;
+        case DLIS_IDENT:  return DLIS_FMT_IDENT;
+        case DLIS_ASCII:  return DLIS_FMT_ASCII;
+        case DLIS_DTIME:  return DLIS_FMT_DTIME;
+        case DLIS_ORIGIN: return DLIS_FMT_ORIGIN;
+        case DLIS_OBNAME: return DLIS_FMT_OBNAME;
+        case DLIS_OBJREF: return DLIS_FMT_OBJREF;
+        case DLIS_ATTREF: return DLIS_FMT_ATTREF;
+        case DLIS_STATUS: return DLIS_FMT_STATUS;
+        case DLIS_UNITS:  return DLIS_FMT_UNITS;
+        default: {
+            const auto msg = "invalid representation code {}";
+            throw std::invalid_argument(fmt::format(msg, reprc));
+        }
+    }
+}
+
+const dl::object_attribute* find(const dl::basic_object& obj,
+                                 const std::string& label) noexcept (true) {
+    for (const auto& attr : obj.attributes) {
+        if (dl::decay(attr.label) == label) return &attr;
+    }
+    return nullptr;
+}
+
+template < typename T >
+const std::vector< T >* values(const dl::basic_object& obj,
+                               const std::string& label) noexcept (true) {
+    const auto* attr = find(obj, label);
+    if (not attr) return nullptr;
+    return mpark::get_if< std::vector< T > >(&attr->value);
+}
+
+/*
+ * The on-disk format of a channel, i.e. the DLIS_FMT_* character of its
+ * representation code repeated once per sample
+ */
+std::string channel_format(const dl::basic_object& channel) noexcept (false) {
+    const auto* reprc = values< dl::ushort >(channel, "REPRESENTATION-CODE");
+    if (not reprc or reprc->size() != 1) {
+        const auto msg = "channel {} has no valid REPRESENTATION-CODE";
+        throw std::runtime_error(fmt::format(msg,
+                                 dl::decay(channel.object_name.id)));
+    }
+
+    std::size_t samples = 1;
+    const auto* dimension = values< dl::uvari >(channel, "DIMENSION");
+    if (dimension) {
+        for (const auto& x : *dimension)
+            samples *= std::size_t(dl::decay(x));
+    }
+
+    return std::string(samples, fmtchar(reprc->front()));
+}
+
+/*
+ * Decode a single (the first) sample of the index channel, without decoding
+ * anything else in the frame
+ */
+template < typename T >
+double first(const char* src, char code) noexcept (true) {
+    const char f[] = { code, DLIS_FMT_EOL };
+    char dst[3 * sizeof(double)];
+    dlis_packf(f, src, dst);
+    T x;
+    std::memcpy(&x, dst, sizeof(x));
+    return double(x);
+}
+
+double index_value(const char* src, char code) noexcept (false) {
+    switch (code) {
+        case DLIS_FMT_FSHORT:
+        case DLIS_FMT_FSINGL:
+        case DLIS_FMT_FSING1:
+        case DLIS_FMT_FSING2:
+        case DLIS_FMT_ISINGL:
+        case DLIS_FMT_VSINGL: return first< float >(src, code);
+        case DLIS_FMT_FDOUBL:
+        case DLIS_FMT_FDOUB1:
+        case DLIS_FMT_FDOUB2: return first< double >(src, code);
+        case DLIS_FMT_SSHORT: return first< std::int8_t >(src, code);
+        case DLIS_FMT_SNORM:  return first< std::int16_t >(src, code);
+        case DLIS_FMT_SLONG:  return first< std::int32_t >(src, code);
+        case DLIS_FMT_USHORT: return first< std::uint8_t >(src, code);
+        case DLIS_FMT_UNORM:  return first< std::uint16_t >(src, code);
+        case DLIS_FMT_ULONG:  return first< std::uint32_t >(src, code);
+        case DLIS_FMT_UVARI:  return first< std::int32_t >(src, code);
+        default: {
+            const auto msg = "index range on non-numeric index (format '{}')";
+            throw dl::not_implemented(fmt::format(msg, code));
+        }
+    }
+}
+
+struct clamp_values {
+    double lo;
+    double hi;
+
+    void operator () (mpark::monostate&) const noexcept (true) {}
+
+    template < typename T >
+    typename std::enable_if< std::is_arithmetic< T >::value >::type
+    operator () (std::vector< T >& xs) const noexcept (true) {
+        for (auto& x : xs) {
+            if (double(x) < this->lo) x = T(this->lo);
+            if (double(x) > this->hi) x = T(this->hi);
+        }
+    }
+
+    template < typename T >
+    typename std::enable_if< not std::is_arithmetic< T >::value >::type
+    operator () (std::vector< T >&) const noexcept (true) {}
+};
+
+/*
+ * How to repack the FDATA of a single frame
+ *
+ * offsets are the byte offsets of the channels relative to the end of the
+ * frame number, and are only computed once when all channels are fixed-size.
+ */
+struct frame_plan {
+    std::vector< std::string > formats;
+    std::vector< bool > keep;
+    std::vector< dl::obname > kept;
+    bool drop     = false;
+    bool filtered = false;
+    bool indexed  = false;
+    bool valid    = true;
+
+    bool fixed = false;
+    std::vector< int > offsets;
+
+    std::int32_t frameno = 1;
+};
+
+bool selected(const dl::repack_options& opts, const dl::obname& name) {
+    if (opts.channels.empty()) return true;
+    const auto& id = dl::decay(name.id);
+    return std::find(opts.channels.begin(), opts.channels.end(), id)
+        != opts.channels.end();
+}
+
+void channel_offsets(const frame_plan& plan,
+                     const char* ptr,
+                     const char* end,
+                     std::vector< int >& offsets) noexcept (false) {
+    offsets.resize(plan.formats.size() + 1);
+    offsets[0] = 0;
+    const auto* begin = ptr;
+    for (std::size_t i = 0; i < plan.formats.size(); ++i) {
+        int nread, nwrite;
+        const auto err = dlis_packflen(plan.formats[i].c_str(),
+                                       ptr,
+                                       &nread,
+                                       &nwrite);
+        if (err)
+            throw std::runtime_error("invalid frame format");
+        ptr += nread;
+        if (ptr > end) {
+            const auto msg = "corrupted record: frame would read {} bytes "
+                             "past end of record";
+            throw std::runtime_error(fmt::format(msg, ptr - end));
+        }
+        offsets[i + 1] = int(ptr - begin);
+    }
+}
+
+void fixed_offsets(frame_plan& plan) noexcept (false) {
+    plan.offsets.assign(1, 0);
+    for (const auto& format : plan.formats) {
+        int src, dst;
+        if (dlis_pack_size(format.c_str(), &src, &dst))
+            throw std::runtime_error("invalid frame format");
+        plan.offsets.push_back(plan.offsets.back() + src);
+    }
+    plan.fixed = true;
+}
+
+void append_frameno(std::vector< char >& out, std::int32_t frameno)
+noexcept (false) {
+    char buffer[4];
+    auto* end = static_cast< char* >(dlis_uvario(buffer, frameno, 0));
+    out.insert(out.end(), buffer, end);
+}
+
+}
+
+namespace dl {
+
+void repack(dl::stream& file,
+            const dl::stream_offsets& offsets,
+            const repack_options& opts,
+            dl::writer& out,
+            dl::error_handler& errorhandler) noexcept (false) {
+    const auto lo = std::min(opts.top, opts.bottom);
+    const auto hi = std::max(opts.top, opts.bottom);
+
+    /*
+     * Metadata is read up-front, as the FRAME set may refer to channels that
+     * are defined later in the logical file
+     */
+    std::vector< dl::record > explicits;
+    for (const auto tell : offsets.explicits)
+        explicits.push_back(dl::extract(file, tell, errorhandler));
+
+    std::map< dl::ident, std::string > formats;
+    std::vector< dl::basic_object > frames;
+    for (const auto& rec : explicits) {
+        if (rec.isencrypted()) continue;
+        if (rec.type != DLIS_CHANNL and rec.type != DLIS_FRAME) continue;
+
+        auto set = dl::object_set(rec);
+        const auto& type = dl::decay(set.type);
+        if (type == "FRAME") {
+            const auto& objs = set.objects();
+            frames.insert(frames.end(), objs.begin(), objs.end());
+        }
+
+        if (type != "CHANNEL") continue;
+        for (const auto& ch : set.objects()) {
+            const auto key = ch.object_name.fingerprint("CHANNEL");
+            try {
+                formats[key] = channel_format(ch);
+            } catch (const std::exception& e) {
+                errorhandler.log(dl::error_severity::MAJOR,
+                                 "dl::repack: reading channels",
+                                 e.what(), "",
+                                 "Frames with this channel are not repacked");
+            }
+        }
+    }
+
+    /*
+     * A frame is dropped when none of its (non-index) channels are selected.
+     * Channels are only removed from the CHANNEL sets when no remaining frame
+     * refers to them.
+     */
+    std::map< dl::ident, frame_plan > plans;
+    std::vector< dl::ident > referenced;
+    std::vector< dl::ident > kept;
+    for (const auto& frame : frames) {
+        frame_plan plan;
+        plan.indexed = find(frame, "INDEX-TYPE") != nullptr;
+
+        const auto* channels = values< dl::obname >(frame, "CHANNELS");
+        const auto nchannels = channels ? channels->size() : 0;
+        bool data = false;
+        for (std::size_t i = 0; i < nchannels; ++i) {
+            const auto& name = (*channels)[i];
+            const auto key = name.fingerprint("CHANNEL");
+            const auto format = formats.find(key);
+            if (format == formats.end()) plan.valid = false;
+            else plan.formats.push_back(format->second);
+
+            const bool index = plan.indexed and i == 0;
+            const bool keep = selected(opts, name);
+            if (keep and not index) data = true;
+            plan.keep.push_back(keep or index);
+            if (keep or index) plan.kept.push_back(name);
+            referenced.push_back(key);
+        }
+
+        plan.drop = not opts.channels.empty() and not data;
+        plan.filtered = plan.kept.size() != nchannels
+                     or (opts.index_range and plan.indexed);
+
+        if (plan.drop) {
+            plans[frame.object_name.fingerprint("FRAME")] = std::move(plan);
+            continue;
+        }
+
+        for (const auto& name : plan.kept)
+            kept.push_back(name.fingerprint("CHANNEL"));
+
+        if (plan.valid and not plan.formats.empty()) {
+            std::string format;
+            for (const auto& x : plan.formats) format += x;
+            int varsrc, vardst;
+            dlis_pack_varsize(format.c_str(), &varsrc, &vardst);
+            if (not varsrc) fixed_offsets(plan);
+        }
+
+        plans[frame.object_name.fingerprint("FRAME")] = std::move(plan);
+    }
+
+    std::vector< dl::ident > dropped;
+    for (const auto& key : referenced) {
+        if (std::find(kept.begin(), kept.end(), key) == kept.end())
+            dropped.push_back(key);
+    }
+
+    /*
+     * Explicit and implicit records are written in their original order
+     */
+    std::size_t ei = 0;
+    std::size_t ii = 0;
+    dl::record rec;
+    std::vector< char > body;
+    std::vector< int > ofs;
+
+    const auto skip = [&](const std::string& problem) {
+        errorhandler.log(dl::error_severity::CRITICAL,
+                         "dl::repack: repacking implicit records",
+                         problem, "",
+                         "Record is skipped");
+    };
+
+    while (ei < explicits.size() or ii < offsets.implicits.size()) {
+        const bool next_explicit = ii == offsets.implicits.size()
+            or (ei < explicits.size()
+                and offsets.explicits[ei] < offsets.implicits[ii]);
+
+        if (next_explicit) {
+            const auto& eflr = explicits[ei++];
+            if (eflr.isencrypted()) {
+                errorhandler.log(dl::error_severity::MINOR,
+                                 "dl::repack: copying explicit records",
+                                 "encrypted records cannot be re-written", "",
+                                 "Record is skipped");
+                continue;
+            }
+
+            if (eflr.type != DLIS_CHANNL and eflr.type != DLIS_FRAME) {
+                out.write(eflr.type, true, eflr.data.data(), eflr.data.size());
+                continue;
+            }
+
+            auto set = dl::object_set(eflr);
+            const auto& type = dl::decay(set.type);
+            bool changed = false;
+            dl::object_vector objs;
+            for (auto obj : set.objects()) {
+                if (type == "CHANNEL") {
+                    const auto key = obj.object_name.fingerprint("CHANNEL");
+                    const auto itr = std::find(dropped.begin(),
+                                               dropped.end(),
+                                               key);
+                    if (itr != dropped.end()) {
+                        changed = true;
+                        continue;
+                    }
+                }
+
+                if (type == "FRAME") {
+                    const auto key = obj.object_name.fingerprint("FRAME");
+                    const auto& plan = plans.at(key);
+                    if (plan.drop) {
+                        changed = true;
+                        continue;
+                    }
+
+                    if (plan.filtered) {
+                        changed = true;
+                        for (auto& attr : obj.attributes) {
+                            const auto& label = dl::decay(attr.label);
+                            if (label == "CHANNELS") {
+                                attr.value = plan.kept;
+                                attr.count = dl::uvari(
+                                    std::int32_t(plan.kept.size()));
+                            }
+                            if (not opts.index_range) continue;
+                            if (label == "INDEX-MIN" or label == "INDEX-MAX")
+                                mpark::visit(clamp_values{ lo, hi },
+                                             attr.value);
+                        }
+                    }
+                }
+                objs.push_back(std::move(obj));
+            }
+
+            if (not changed)
+                out.write(eflr.type, true, eflr.data.data(), eflr.data.size());
+            else if (not objs.empty())
+                out.write_set(set.type, set.name, objs);
+            continue;
+        }
+
+        const auto tell = offsets.implicits[ii++];
+        try {
+            const auto all = std::numeric_limits< std::int64_t >::max();
+            dl::extract(file, tell, all, rec, errorhandler);
+        } catch (const std::exception& e) {
+            skip(e.what());
+            continue;
+        }
+
+        if (rec.isencrypted()) continue;
+        if (rec.type != 0 or rec.data.empty()) {
+            out.write(rec.type, false, rec.data.data(), rec.data.size());
+            continue;
+        }
+
+        std::int32_t origin;
+        std::uint8_t copy;
+        std::int32_t idlen;
+        char id[256];
+        const auto* begin = rec.data.data();
+        const auto* end = begin + rec.data.size();
+        const auto* ptr = dlis_obname(begin, &origin, &copy, &idlen, id);
+        if (ptr > end) {
+            skip("fdata record corrupted, error on reading obname");
+            continue;
+        }
+
+        const dl::obname name{ dl::origin{ origin },
+                               dl::ushort{ copy },
+                               dl::ident{ std::string(id, id + idlen) } };
+        const auto itr = plans.find(name.fingerprint("FRAME"));
+        if (itr == plans.end()) {
+            const auto msg = "no FRAME object {} for fdata record";
+            skip(fmt::format(msg, dl::decay(name.id)));
+            continue;
+        }
+
+        auto& plan = itr->second;
+        if (plan.drop) continue;
+        if (not plan.filtered) {
+            out.write(0, false, rec.data.data(), rec.data.size());
+            continue;
+        }
+
+        if (not plan.valid) {
+            skip("frame format unknown, channels are missing");
+            continue;
+        }
+
+        /*
+         * The frames are copied as raw byte slices, only the frame number is
+         * re-encoded
+         */
+        body.assign(begin, ptr);
+        const auto header = body.size();
+        const auto frameno = plan.frameno;
+        try {
+            while (ptr < end) {
+                int nread, nwrite;
+                dlis_packflen("i", ptr, &nread, &nwrite);
+                const auto* frame = ptr + nread;
+
+                if (not plan.fixed)
+                    channel_offsets(plan, frame, end, ofs);
+                const auto& o = plan.fixed ? plan.offsets : ofs;
+
+                if (o.back() > end - frame) {
+                    const auto msg = "corrupted record: frame would read {} "
+                                     "bytes past end of record";
+                    const auto overflow = o.back() - (end - frame);
+                    throw std::runtime_error(fmt::format(msg, overflow));
+                }
+                ptr = frame + o.back();
+
+                if (opts.index_range and plan.indexed) {
+                    const auto x = index_value(frame, plan.formats[0][0]);
+                    if (x < lo or x > hi) continue;
+                }
+
+                append_frameno(body, plan.frameno++);
+                for (std::size_t i = 0; i < plan.keep.size(); ++i) {
+                    if (not plan.keep[i]) continue;
+                    body.insert(body.end(), frame + o[i], frame + o[i + 1]);
+                }
+            }
+        } catch (const dl::not_implemented&) {
+            throw;
+        } catch (const std::exception& e) {
+            plan.frameno = frameno;
+            skip(e.what());
+            continue;
+        }
+
+        if (body.size() > header)
+            out.write(0, false, body.data(), body.size());
+    }
+}
+
+}
@@ -0,0 +1,83 @@
+#include <atomic>
+#include <cstdint>
+
+#include <dlisio/ext/stats.hpp>
+
+namespace dl {
+namespace stats {
+
+const char* name(counter c) noexcept (true) {
+    switch (c) {
+        case bytes_read: return "bytes_read";
+        case seeks:      return "seeks";
+        case segments:   return "segments";
+        case records:    return "records";
+        case objects:    return "objects";
+        case frames:     return "frames";
+        case workers:    return "workers";
+        default:         return "unknown";
+    }
+}
+
+const char* name(stage s) noexcept (true) {
+    switch (s) {
+        case findoffsets: return "findoffsets";
+        case findfdata:   return "findfdata";
+        case extract:     return "extract";
+        case parse:       return "parse";
+        case read_fdata:  return "read_fdata";
+        default:          return "unknown";
+    }
+}
+
+#ifdef DLISIO_STATS
+
+bool enabled() noexcept (true) {
+    return true;
+}
+
+namespace {
+
+std::atomic< std::int64_t > counts[counters];
+std::atomic< std::int64_t > calls[stages];
+std::atomic< std::int64_t > nanoseconds[stages];
+
+}
+
+void add(counter c, std::int64_t n) noexcept (true) {
+    counts[c].fetch_add(n, std::memory_order_relaxed);
+}
+
+void time(stage s, std::int64_t ns) noexcept (true) {
+    calls[s].fetch_add(1, std::memory_order_relaxed);
+    nanoseconds[s].fetch_add(ns, std::memory_order_relaxed);
+}
+
+snapshot read() noexcept (true) {
+    snapshot snap;
+    for (int i = 0; i < counters; ++i)
+        snap.count[i] = counts[i].load(std::memory_order_relaxed);
+    for (int i = 0; i < stages; ++i) {
+        snap.calls[i] = calls[i].load(std::memory_order_relaxed);
+        snap.nanoseconds[i] = nanoseconds[i].load(std::memory_order_relaxed);
+    }
+    return snap;
+}
+
+void reset() noexcept (true) {
+    for (auto& x : counts)      x.store(0, std::memory_order_relaxed);
+    for (auto& x : calls)       x.store(0, std::memory_order_relaxed);
+    for (auto& x : nanoseconds) x.store(0, std::memory_order_relaxed);
+}
+
+#else
+
+bool enabled() noexcept (true) {
+    return false;
+}
+
+#endif // DLISIO_STATS
+
+}
+
+}
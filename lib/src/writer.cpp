@@ -0,0 +1,640 @@
+#include <algorithm>
+#include <cerrno>
+#include <ciso646>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include <dlisio/dlisio.h>
+#include <dlisio/types.h>
+
+#include <dlisio/ext/io.hpp>
+#include <dlisio/ext/writer.hpp>
+
+namespace {
+
+/*
+ * The emit functions are the inverse of the cast functions in parse.cpp, and
+ * append the RP66 encoding of a value to the output buffer.
+ */
+char* grow(std::vector< char >& out, std::size_t n) noexcept (false) {
+    const auto size = out.size();
+    out.resize(size + n);
+    return out.data() + size;
+}
+
+void shrink(std::vector< char >& out, const void* end) noexcept (true) {
+    const auto* p = static_cast< const char* >(end);
+    out.resize(std::distance(static_cast< const char* >(out.data()), p));
+}
+
+std::uint8_t length(const std::string& s) noexcept (false) {
+    if (s.size() > 255) {
+        const auto msg = "identifier too long ({} > 255 characters): {}";
+        throw std::invalid_argument(fmt::format(msg, s.size(), s));
+    }
+    return std::uint8_t(s.size());
+}
+
+void emit(std::vector< char >&, dl::fshort) noexcept (false) {
+    throw dl::not_implemented("encoding fshort");
+}
+
+void emit(std::vector< char >& out, dl::fsingl x) noexcept (false) {
+    shrink(out, dlis_fsinglo(grow(out, DLIS_SIZEOF_FSINGL), x));
+}
+
+void emit(std::vector< char >& out, dl::fdoubl x) noexcept (false) {
+    shrink(out, dlis_fdoublo(grow(out, DLIS_SIZEOF_FDOUBL), x));
+}
+
+void emit(std::vector< char >& out, const dl::fsing1& x) noexcept (false) {
+    shrink(out, dlis_fsing1o(grow(out, DLIS_SIZEOF_FSING1), x.V, x.A));
+}
+
+void emit(std::vector< char >& out, const dl::fsing2& x) noexcept (false) {
+    shrink(out, dlis_fsing2o(grow(out, DLIS_SIZEOF_FSING2), x.V, x.A, x.B));
+}
+
+void emit(std::vector< char >& out, const dl::fdoub1& x) noexcept (false) {
+    shrink(out, dlis_fdoub1o(grow(out, DLIS_SIZEOF_FDOUB1), x.V, x.A));
+}
+
+void emit(std::vector< char >& out, const dl::fdoub2& x) noexcept (false) {
+    shrink(out, dlis_fdoub2o(grow(out, DLIS_SIZEOF_FDOUB2), x.V, x.A, x.B));
+}
+
+void emit(std::vector< char >& out, const dl::isingl& x) noexcept (false) {
+    shrink(out, dlis_isinglo(grow(out, DLIS_SIZEOF_ISINGL), dl::decay(x)));
+}
+
+void emit(std::vector< char >& out, const dl::vsingl& x) noexcept (false) {
+    shrink(out, dlis_vsinglo(grow(out, DLIS_SIZEOF_VSINGL), dl::decay(x)));
+}
+
+void emit(std::vector< char >& out, const dl::csingl& x) noexcept (false) {
+    auto* p = grow(out, DLIS_SIZEOF_CSINGL);
+    shrink(out, dlis_csinglo(p, x.real(), x.imag()));
+}
+
+void emit(std::vector< char >& out, const dl::cdoubl& x) noexcept (false) {
+    auto* p = grow(out, DLIS_SIZEOF_CDOUBL);
+    shrink(out, dlis_cdoublo(p, x.real(), x.imag()));
+}
+
+void emit(std::vector< char >& out, dl::sshort x) noexcept (false) {
+    shrink(out, dlis_sshorto(grow(out, DLIS_SIZEOF_SSHORT), x));
+}
+
+void emit(std::vector< char >& out, dl::snorm x) noexcept (false) {
+    shrink(out, dlis_snormo(grow(out, DLIS_SIZEOF_SNORM), x));
+}
+
+void emit(std::vector< char >& out, dl::slong x) noexcept (false) {
+    shrink(out, dlis_slongo(grow(out, DLIS_SIZEOF_SLONG), x));
+}
+
+void emit(std::vector< char >& out, dl::ushort x) noexcept (false) {
+    shrink(out, dlis_ushorto(grow(out, DLIS_SIZEOF_USHORT), x));
+}
+
+void emit(std::vector< char >& out, dl::unorm x) noexcept (false) {
+    shrink(out, dlis_unormo(grow(out, DLIS_SIZEOF_UNORM), x));
+}
+
+void emit(std::vector< char >& out, dl::ulong x) noexcept (false) {
+    shrink(out, dlis_ulongo(grow(out, DLIS_SIZEOF_ULONG), x));
+}
+
+void emit(std::vector< char >& out, const dl::uvari& x) noexcept (false) {
+    shrink(out, dlis_uvario(grow(out, 4), dl::decay(x), 0));
+}
+
+void emit(std::vector< char >& out, const dl::origin& x) noexcept (false) {
+    shrink(out, dlis_origino(grow(out, 4), dl::decay(x)));
+}
+
+void emit(std::vector< char >& out, const dl::status& x) noexcept (false) {
+    shrink(out, dlis_statuso(grow(out, DLIS_SIZEOF_STATUS), dl::decay(x)));
+}
+
+void emit(std::vector< char >& out, const dl::ident& x) noexcept (false) {
+    const auto& s = dl::decay(x);
+    const auto len = length(s);
+    shrink(out, dlis_idento(grow(out, 1 + len), len, s.data()));
+}
+
+void emit(std::vector< char >& out, const dl::units& x) noexcept (false) {
+    const auto& s = dl::decay(x);
+    const auto len = length(s);
+    shrink(out, dlis_unitso(grow(out, 1 + len), len, s.data()));
+}
+
+void emit(std::vector< char >& out, const dl::ascii& x) noexcept (false) {
+    const auto& s = dl::decay(x);
+    auto* p = grow(out, 4 + s.size());
+    shrink(out, dlis_asciio(p, std::int32_t(s.size()), s.data(), 0));
+}
+
+void emit(std::vector< char >& out, const dl::dtime& x) noexcept (false) {
+    auto* p = grow(out, DLIS_SIZEOF_DTIME);
+    shrink(out, dlis_dtimeo(p, dlis_yearo(x.Y), x.TZ, x.M, x.D,
+                               x.H, x.MN, x.S, x.MS));
+}
+
+void emit(std::vector< char >& out, const dl::obname& x) noexcept (false) {
+    emit(out, x.origin);
+    emit(out, x.copy);
+    emit(out, x.id);
+}
+
+void emit(std::vector< char >& out, const dl::objref& x) noexcept (false) {
+    emit(out, x.type);
+    emit(out, x.name);
+}
+
+void emit(std::vector< char >& out, const dl::attref& x) noexcept (false) {
+    emit(out, x.type);
+    emit(out, x.name);
+    emit(out, x.label);
+}
+
+struct emit_values {
+    std::vector< char >& out;
+
+    void operator () (const mpark::monostate&) const noexcept (true) {}
+
+    template < typename T >
+    void operator () (const std::vector< T >& xs) const noexcept (false) {
+        for (const auto& x : xs)
+            emit(this->out, x);
+    }
+};
+
+struct count_values {
+    std::size_t operator () (const mpark::monostate&) const noexcept (true) {
+        return 0;
+    }
+
+    template < typename T >
+    std::size_t operator () (const std::vector< T >& xs) const noexcept (true) {
+        return xs.size();
+    }
+};
+
+/*
+ * The representation code is given by the type of the value, so that the
+ * reprc written is always consistent with the bytes written. Attributes
+ * without values keep the reprc they have.
+ */
+struct value_reprc {
+    dl::representation_code fallback;
+
+    dl::representation_code operator () (const mpark::monostate&)
+    const noexcept (true) {
+        return this->fallback;
+    }
+
+    template < typename T >
+    dl::representation_code operator () (const std::vector< T >&)
+    const noexcept (true) {
+        return dl::typeinfo< T >::reprc;
+    }
+};
+
+dl::representation_code reprc_of(const dl::object_attribute& attr)
+noexcept (true) {
+    return mpark::visit(value_reprc{ attr.reprc }, attr.value);
+}
+
+/*
+ * Size of a single sample as laid out by dlis_packf, or 0 for codes that
+ * cannot be packed from columns.
+ */
+std::size_t native_size(dl::representation_code reprc) noexcept (true) {
+    using rpc = dl::representation_code;
+    switch (reprc) {
+        case rpc::fsingl: return sizeof(float);
+        case rpc::fsing1: return sizeof(float) * 2;
+        case rpc::fsing2: return sizeof(float) * 3;
+        case rpc::isingl: return sizeof(float);
+        case rpc::vsingl: return sizeof(float);
+        case rpc::fdoubl: return sizeof(double);
+        case rpc::fdoub1: return sizeof(double) * 2;
+        case rpc::fdoub2: return sizeof(double) * 3;
+        case rpc::csingl: return sizeof(float) * 2;
+        case rpc::cdoubl: return sizeof(double) * 2;
+        case rpc::sshort: return sizeof(std::int8_t);
+        case rpc::snorm:  return sizeof(std::int16_t);
+        case rpc::slong:  return sizeof(std::int32_t);
+        case rpc::ushort: return sizeof(std::uint8_t);
+        case rpc::unorm:  return sizeof(std::uint16_t);
+        case rpc::ulong:  return sizeof(std::uint32_t);
+        case rpc::uvari:  return sizeof(std::int32_t);
+        case rpc::origin: return sizeof(std::int32_t);
+        case rpc::status: return sizeof(std::uint8_t);
+        case rpc::dtime:  return sizeof(int) * 8;
+        default:          return 0;
+    }
+}
+
+template < typename T >
+T load(const char* src) noexcept (true) {
+    T x;
+    std::memcpy(&x, src, sizeof(x));
+    return x;
+}
+
+void pack(std::vector< char >& out,
+          dl::representation_code reprc,
+          const char* src) noexcept (false) {
+    using rpc = dl::representation_code;
+    const auto f = sizeof(float);
+    const auto d = sizeof(double);
+
+    switch (reprc) {
+        case rpc::fsingl: emit(out, load< float >(src)); return;
+        case rpc::fdoubl: emit(out, load< double >(src)); return;
+        case rpc::isingl: emit(out, dl::isingl{ load< float >(src) }); return;
+        case rpc::vsingl: emit(out, dl::vsingl{ load< float >(src) }); return;
+        case rpc::sshort: emit(out, load< std::int8_t   >(src)); return;
+        case rpc::snorm:  emit(out, load< std::int16_t  >(src)); return;
+        case rpc::slong:  emit(out, load< std::int32_t  >(src)); return;
+        case rpc::ushort: emit(out, load< std::uint8_t  >(src)); return;
+        case rpc::unorm:  emit(out, load< std::uint16_t >(src)); return;
+        case rpc::ulong:  emit(out, load< std::uint32_t >(src)); return;
+        case rpc::uvari:  emit(out, dl::uvari{ load< std::int32_t >(src) });
+                          return;
+        case rpc::origin: emit(out, dl::origin{ load< std::int32_t >(src) });
+                          return;
+        case rpc::status: emit(out, dl::status{ load< std::uint8_t >(src) });
+                          return;
+
+        case rpc::fsing1:
+            emit(out, dl::fsing1{ load< float >(src),
+                                  load< float >(src + f) });
+            return;
+
+        case rpc::fsing2:
+            emit(out, dl::fsing2{ load< float >(src),
+                                  load< float >(src + f),
+                                  load< float >(src + 2*f) });
+            return;
+
+        case rpc::fdoub1:
+            emit(out, dl::fdoub1{ load< double >(src),
+                                  load< double >(src + d) });
+            return;
+
+        case rpc::fdoub2:
+            emit(out, dl::fdoub2{ load< double >(src),
+                                  load< double >(src + d),
+                                  load< double >(src + 2*d) });
+            return;
+
+        case rpc::csingl:
+            emit(out, dl::csingl{ load< float >(src),
+                                  load< float >(src + f) });
+            return;
+
+        case rpc::cdoubl:
+            emit(out, dl::cdoubl{ load< double >(src),
+                                  load< double >(src + d) });
+            return;
+
+        case rpc::dtime: {
+            /*
+             * dlis_packf outputs the year as-is (i.e. relative to 1900), so
+             * write it back without conversion
+             */
+            int x[8];
+            std::memcpy(x, src, sizeof(x));
+            auto* p = grow(out, DLIS_SIZEOF_DTIME);
+            shrink(out, dlis_dtimeo(p, x[0], x[1], x[2], x[3],
+                                       x[4], x[5], x[6], x[7]));
+            return;
+        }
+
+        default: {
+            const auto msg = "packing frames with representation code {}";
+            const auto code = static_cast< int >(reprc);
+            throw dl::not_implemented(fmt::format(msg, code));
+        }
+    }
+}
+
+}
+
+namespace dl {
+
+std::vector< char > encode_set(const dl::ident& type,
+                               const dl::ident& name,
+                               const dl::object_vector& objects)
+noexcept (false) {
+    std::vector< char > out;
+
+    std::uint8_t set = DLIS_ROLE_SET | 1 << 4;
+    if (not dl::decay(name).empty()) set |= 1 << 3;
+    out.push_back(char(set));
+    emit(out, type);
+    if (not dl::decay(name).empty()) emit(out, name);
+
+    std::vector< dl::ident > labels;
+    std::vector< dl::representation_code > reprcs;
+    for (const auto& obj : objects) {
+        for (const auto& attr : obj.attributes) {
+            const auto itr = std::find(labels.begin(), labels.end(),
+                                       attr.label);
+            if (itr != labels.end()) continue;
+            labels.push_back(attr.label);
+            reprcs.push_back(reprc_of(attr));
+        }
+    }
+
+    for (std::size_t i = 0; i < labels.size(); ++i) {
+        out.push_back(char(DLIS_ROLE_ATTRIB | 1 << 4 | 1 << 2));
+        emit(out, labels[i]);
+        emit(out, dl::ushort(reprcs[i]));
+    }
+
+    for (const auto& obj : objects) {
+        out.push_back(char(DLIS_ROLE_OBJECT | 1 << 4));
+        emit(out, obj.object_name);
+
+        for (std::size_t i = 0; i < labels.size(); ++i) {
+            const auto eq = [&](const dl::object_attribute& x) {
+                return x.label == labels[i];
+            };
+            const auto attr = std::find_if(obj.attributes.begin(),
+                                           obj.attributes.end(),
+                                           eq);
+
+            if (attr == obj.attributes.end()) {
+                out.push_back(char(DLIS_ROLE_ABSATR));
+                continue;
+            }
+
+            const auto count = mpark::visit(count_values{}, attr->value);
+            const auto reprc = reprc_of(*attr);
+            const auto& units = dl::decay(attr->units);
+
+            std::uint8_t desc = DLIS_ROLE_ATTRIB;
+            if (count != 1)          desc |= 1 << 3;
+            if (reprc != reprcs[i])  desc |= 1 << 2;
+            if (not units.empty())   desc |= 1 << 1;
+            if (count > 0)           desc |= 1 << 0;
+            out.push_back(char(desc));
+
+            if (count != 1)         emit(out, dl::uvari(std::int32_t(count)));
+            if (reprc != reprcs[i]) emit(out, dl::ushort(reprc));
+            if (not units.empty())  emit(out, attr->units);
+            mpark::visit(emit_values{ out }, attr->value);
+        }
+    }
+
+    return out;
+}
+
+int eflr_type(const dl::ident& type) noexcept (true) {
+    static const std::vector< std::pair< std::string, int > > types = {
+        { "FILE-HEADER",             DLIS_FHLR   },
+        { "ORIGIN",                  DLIS_OLR    },
+        { "WELL-REFERENCE",          DLIS_OLR    },
+        { "AXIS",                    DLIS_AXIS   },
+        { "CHANNEL",                 DLIS_CHANNL },
+        { "FRAME",                   DLIS_FRAME  },
+        { "PATH",                    DLIS_FRAME  },
+        { "COMMENT",                 DLIS_SCRIPT },
+        { "MESSAGE",                 DLIS_SCRIPT },
+        { "UPDATE",                  DLIS_UPDATE },
+        { "NO-FORMAT",               DLIS_UDI    },
+        { "LONG-NAME",               DLIS_LNAME  },
+        { "ATTRIBUTE",               DLIS_SPEC   },
+        { "CODE",                    DLIS_SPEC   },
+        { "EFLR",                    DLIS_SPEC   },
+        { "IFLR",                    DLIS_SPEC   },
+        { "OBJECT-TYPE",             DLIS_SPEC   },
+        { "REPRESENTATION-CODE",     DLIS_SPEC   },
+        { "SPECIFICATION",           DLIS_SPEC   },
+        { "UNIT-SYMBOL",             DLIS_SPEC   },
+        { "BASE-DICTIONARY",         DLIS_DICT   },
+        { "IDENTIFIER",              DLIS_DICT   },
+        { "LEXICON",                 DLIS_DICT   },
+        { "OPTION",                  DLIS_DICT   },
+    };
+
+    for (const auto& x : types) {
+        if (x.first == dl::decay(type)) return x.second;
+    }
+    return DLIS_STATIC;
+}
+
+writer::writer(const std::string& path,
+               int vrlen,
+               int seglen,
+               std::size_t blocksize) noexcept (false)
+    : vrlen(vrlen)
+    , seglen(seglen ? seglen : vrlen - DLIS_VRL_SIZE)
+    , blocksize(blocksize)
+{
+    /*
+     * The visible record length is an unorm, and must be even. Anything below
+     * 20 cannot fit a single minimal segment.
+     */
+    if (vrlen < 20 or vrlen > 16384 or vrlen % 2) {
+        const auto msg = "visible record length must be even and in "
+                         "[20, 16384], was {}";
+        throw std::invalid_argument(fmt::format(msg, vrlen));
+    }
+
+    if (this->seglen < 16 or this->seglen % 2) {
+        const auto msg = "segment length must be even and >= 16, was {}";
+        throw std::invalid_argument(fmt::format(msg, this->seglen));
+    }
+
+    this->fp = std::fopen(path.c_str(), "wb");
+    if (not this->fp) {
+        const auto msg = "unable to open file for path {} : {}";
+        throw dl::io_error(fmt::format(msg, path, std::strerror(errno)));
+    }
+
+    this->vr.resize(DLIS_VRL_SIZE);
+    this->block.reserve(blocksize + vrlen);
+}
+
+writer::~writer() {
+    if (this->fp) std::fclose(this->fp);
+}
+
+void writer::storage_label(int seqnum, const std::string& id)
+noexcept (false) {
+    if (not this->block.empty() or this->vr.size() > DLIS_VRL_SIZE)
+        throw std::logic_error("storage label must be written first");
+
+    const auto label = fmt::format("{:>4}V1.00RECORD{:>5}{:<60.60}",
+                                   seqnum, this->vrlen, id);
+    if (label.size() != DLIS_SUL_SIZE) {
+        const auto msg = "invalid storage label sequence number {}";
+        throw std::invalid_argument(fmt::format(msg, seqnum));
+    }
+
+    this->block.insert(this->block.end(), label.begin(), label.end());
+}
+
+void writer::checksums(bool enable) noexcept (true) {
+    this->checksum = enable;
+}
+
+void writer::logical_file() noexcept (false) {
+    this->flush_vr();
+}
+
+void writer::write(int type,
+                   bool explicit_formatting,
+                   const char* data,
+                   std::size_t size) noexcept (false) {
+    std::size_t written = 0;
+    do {
+        const auto space = this->vrlen - int(this->vr.size());
+        if (space < 16) {
+            this->flush_vr();
+            continue;
+        }
+
+        const int trailer  = this->checksum ? 2 : 0;
+        const auto maxlen  = std::min(space, this->seglen) & ~1;
+        const auto maxbody = std::size_t(maxlen - DLIS_LRSH_SIZE - trailer);
+        const auto len     = std::min(size - written, maxbody);
+        const bool first   = written == 0;
+        const bool last    = written + len == size;
+
+        /*
+         * Segments must be of even length, and at least 16 bytes long. The
+         * pad count includes the pad count byte itself.
+         */
+        auto pad = int(len % 2);
+        if (len + pad + trailer < 12) pad = 12 - int(len) - trailer;
+
+        std::uint8_t attrs = 0;
+        if (explicit_formatting) attrs |= DLIS_SEGATTR_EXFMTLR;
+        if (not first)           attrs |= DLIS_SEGATTR_PREDSEG;
+        if (not last)            attrs |= DLIS_SEGATTR_SUCCSEG;
+        if (this->checksum)      attrs |= DLIS_SEGATTR_CHCKSUM;
+        if (pad)                 attrs |= DLIS_SEGATTR_PADDING;
+
+        const auto total = DLIS_LRSH_SIZE + len + pad + trailer;
+        char lrsh[DLIS_LRSH_SIZE];
+        auto* p = dlis_unormo(lrsh, std::uint16_t(total));
+        p = dlis_ushorto(p, attrs);
+        dlis_ushorto(p, std::uint8_t(type));
+
+        const auto segment = this->vr.size();
+        this->vr.insert(this->vr.end(), lrsh, lrsh + sizeof(lrsh));
+        this->vr.insert(this->vr.end(), data + written, data + written + len);
+        if (pad) {
+            this->vr.insert(this->vr.end(), pad - 1, 0);
+            this->vr.push_back(char(pad));
+        }
+
+        if (this->checksum) {
+            std::uint16_t crc = 0;
+            const auto* begin = this->vr.data() + segment;
+            dlis_checksum(begin, begin + (total - trailer), &crc);
+            char trail[2];
+            dlis_unormo(trail, crc);
+            this->vr.insert(this->vr.end(), trail, trail + sizeof(trail));
+        }
+
+        written += len;
+    } while (written < size);
+}
+
+void writer::write_set(const dl::ident& type,
+                       const dl::ident& name,
+                       const dl::object_vector& objects) noexcept (false) {
+    const auto body = encode_set(type, name, objects);
+    this->write(eflr_type(type), true, body.data(), body.size());
+}
+
+void writer::write_frames(const dl::obname& frame,
+                          const std::vector< column >& columns,
+                          std::int32_t frameno,
+                          std::size_t frames,
+                          std::size_t frames_per_record) noexcept (false) {
+    if (frames_per_record == 0)
+        throw std::invalid_argument("frames_per_record must be > 0");
+
+    std::vector< std::size_t > sizes;
+    for (const auto& col : columns) {
+        const auto size = native_size(col.reprc);
+        if (size == 0) {
+            const auto msg = "packing frames with representation code {}";
+            const auto code = static_cast< int >(col.reprc);
+            throw dl::not_implemented(fmt::format(msg, code));
+        }
+        sizes.push_back(size * col.samples);
+    }
+
+    std::size_t i = 0;
+    while (i < frames) {
+        this->rec.clear();
+        emit(this->rec, frame);
+
+        const auto last = std::min(frames, i + frames_per_record);
+        for (; i < last; ++i) {
+            emit(this->rec, dl::uvari(std::int32_t(frameno + i)));
+
+            for (std::size_t c = 0; c < columns.size(); ++c) {
+                const auto& col = columns[c];
+                const auto size = sizes[c] / col.samples;
+                const auto* src = static_cast< const char* >(col.data)
+                                + i * sizes[c];
+
+                for (int s = 0; s < col.samples; ++s, src += size)
+                    pack(this->rec, col.reprc, src);
+            }
+        }
+
+        this->write(0, false, this->rec.data(), this->rec.size());
+    }
+}
+
+void writer::close() noexcept (false) {
+    if (not this->fp) return;
+
+    this->flush_vr();
+    this->flush_block();
+
+    const auto err = std::fclose(this->fp);
+    this->fp = nullptr;
+    if (err) throw dl::io_error(errno);
+}
+
+void writer::flush_vr() noexcept (false) {
+    if (this->vr.size() == DLIS_VRL_SIZE) return;
+
+    auto* p = dlis_unormo(this->vr.data(), std::uint16_t(this->vr.size()));
+    p = dlis_ushorto(p, 0xFF);
+    dlis_ushorto(p, 0x01);
+
+    this->block.insert(this->block.end(), this->vr.begin(), this->vr.end());
+    this->vr.resize(DLIS_VRL_SIZE);
+
+    if (this->block.size() >= this->blocksize)
+        this->flush_block();
+}
+
+void writer::flush_block() noexcept (false) {
+    const auto n = std::fwrite(this->block.data(),
+                               1,
+                               this->block.size(),
+                               this->fp);
+    if (n != this->block.size())
+        throw dl::io_error(errno);
+
+    this->block.clear();
+}
+
+}
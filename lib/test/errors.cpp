@@ -0,0 +1,146 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <dlisio/ext/errors.hpp>
+#include <dlisio/ext/types.hpp>
+
+namespace {
+
+struct collect_handler : public dl::error_handler {
+    void log(const dl::error_severity&, const std::string& context,
+             const std::string& problem, const std::string& spec,
+             const std::string& action)
+    const noexcept (false) override {
+        this->messages.push_back(context + "|" + problem + "|" + spec + "|"
+                                 + action);
+    }
+
+    mutable std::vector< std::string > messages;
+};
+
+dl::error_report mismatch(long long tell) {
+    return {
+        dl::error_code::checksum_mismatch,
+        dl::error_severity::MAJOR,
+        "extract (checksum)",
+        "Segment is read as-is",
+        tell,
+        { 0x1234, 0xBEEF },
+    };
+}
+
+}
+
+TEST_CASE("Reports are rendered and logged by default", "[errors]") {
+    collect_handler handler;
+    handler.report(mismatch(80));
+    REQUIRE(handler.messages.size() == 1);
+    CHECK(handler.messages[0] ==
+        "extract (checksum)|"
+        "checksum mismatch in logical record segment at tell 80: "
+        "computed 0x1234, but the trailer says 0xbeef|"
+        "[2.2.2.4 Logical Record Segment Trailer (LRST)]|"
+        "Segment is read as-is");
+}
+
+TEST_CASE("Error sink de-duplicates reports", "[errors]") {
+    dl::error_sink sink(true, 4);
+    for (int i = 0; i < 100; ++i)
+        sink.report(mismatch(80 + 20 * i));
+
+    auto other = mismatch(40);
+    other.code = dl::error_code::checksum_too_short;
+    sink.report(other);
+
+    CHECK(sink.size() == 2);
+    CHECK(sink.count() == 101);
+
+    const auto problems = sink.problems();
+    REQUIRE(problems.size() == 2);
+    CHECK(problems[0].count == 100);
+    CHECK(problems[0].tells == std::vector< long long >{ 80, 100, 120, 140 });
+    CHECK(problems[0].context == "extract (checksum)");
+    CHECK(problems[0].severity == dl::error_severity::MAJOR);
+    CHECK(problems[0].problem.find("at tell 80:") != std::string::npos);
+    CHECK(problems[1].count == 1);
+    CHECK(problems[1].tells == std::vector< long long >{ 40 });
+
+    sink.clear();
+    CHECK(sink.size() == 0);
+    CHECK(sink.count() == 0);
+}
+
+TEST_CASE("Error sink de-duplicates logged problems", "[errors]") {
+    dl::error_sink sink;
+    const auto minor = dl::error_severity::MINOR;
+    sink.log(minor, "context", "problem", "spec", "action");
+    sink.log(minor, "context", "problem", "spec", "action");
+    sink.log(minor, "context", "other problem", "spec", "action");
+    sink.log(dl::error_severity::INFO, "context", "problem", "", "");
+
+    const auto problems = sink.problems();
+    REQUIRE(problems.size() == 3);
+    CHECK(problems[0].problem == "problem");
+    CHECK(problems[0].specification == "spec");
+    CHECK(problems[0].action == "action");
+    CHECK(problems[0].count == 2);
+    CHECK(problems[0].tells.empty());
+    CHECK(problems[1].problem == "other problem");
+    CHECK(problems[2].severity == dl::error_severity::INFO);
+}
+
+TEST_CASE("Error sink keeps a bounded number of logged problems", "[errors]") {
+    dl::error_sink sink(true, 64, 3);
+    const auto minor = dl::error_severity::MINOR;
+    for (int i = 0; i < 1000; ++i) {
+        const auto problem = "record at tell " + std::to_string(i);
+        sink.log(minor, "context", problem, "spec", "action");
+    }
+    sink.log(minor, "context", "record at tell 1", "spec", "action");
+    sink.log(minor, "other", "record at tell 1", "spec", "action");
+    sink.report(mismatch(80));
+
+    CHECK(sink.size() == 6);
+    CHECK(sink.count() == 1003);
+
+    const auto problems = sink.problems();
+    REQUIRE(problems.size() == 6);
+    CHECK(problems[0].problem == "record at tell 0");
+    CHECK(problems[1].problem == "record at tell 1");
+    CHECK(problems[1].count == 2);
+    CHECK(problems[2].problem == "record at tell 2");
+    CHECK(problems[3].problem.find("more than 3") != std::string::npos);
+    CHECK(problems[3].context == "context");
+    CHECK(problems[3].count == 997);
+    CHECK(problems[4].context == "other");
+    CHECK(problems[4].count == 1);
+    CHECK(problems[5].count == 1);
+
+    sink.clear();
+    sink.log(minor, "context", "record at tell 999", "spec", "action");
+    CHECK(sink.problems()[0].problem == "record at tell 999");
+}
+
+TEST_CASE("Error sink raises critical problems on request", "[errors]") {
+    const auto critical = dl::error_severity::CRITICAL;
+    auto report = mismatch(80);
+    report.severity = critical;
+
+    SECTION("raise") {
+        dl::error_sink sink;
+        CHECK_THROWS_AS(sink.log(critical, "ctx", "problem", "", ""),
+                        std::runtime_error);
+        CHECK_THROWS_AS(sink.report(report), std::runtime_error);
+        CHECK(sink.size() == 2);
+    }
+
+    SECTION("collect") {
+        dl::error_sink sink(false);
+        sink.log(critical, "ctx", "problem", "", "");
+        sink.report(report);
+        CHECK(sink.size() == 2);
+    }
+}
@@ -0,0 +1,1126 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <dlisio/dlisio.h>
+#include <dlisio/types.h>
+#include <dlisio/ext/errors.hpp>
+#include <dlisio/ext/io.hpp>
+#include <dlisio/ext/stats.hpp>
+#include <dlisio/ext/types.hpp>
+#include <dlisio/ext/writer.hpp>
+
+namespace {
+
+struct fail_handler : public dl::error_handler {
+    void log(const dl::error_severity&, const std::string& context,
+             const std::string& problem, const std::string&,
+             const std::string&)
+    const noexcept (false) override {
+        FAIL(context + ": " + problem);
+    }
+};
+
+struct collect_handler : public dl::error_handler {
+    void log(const dl::error_severity&, const std::string&,
+             const std::string& problem, const std::string&,
+             const std::string&)
+    const noexcept (false) override {
+        this->problems.push_back(problem);
+    }
+
+    mutable std::vector< std::string > problems;
+};
+
+std::vector< char > slurp(const std::string& path) {
+    std::ifstream fs(path, std::ios::binary);
+    return std::vector< char >(std::istreambuf_iterator< char >(fs),
+                               std::istreambuf_iterator< char >());
+}
+
+std::vector< char > body(std::size_t size, int seed) {
+    std::vector< char > xs(size);
+    for (std::size_t i = 0; i < size; ++i)
+        xs[i] = char((i + seed) % 251);
+    return xs;
+}
+
+/*
+ * A file of logical_files logical files, with tiny visible records and
+ * segments, so that records are split over many visible records. Every
+ * logical file is a FILE-HEADER, followed by records of 1 to max_size
+ * bytes, every third of them an explicit CHANNEL, and a record of large
+ * bytes at the end, unless large is 0.
+ *
+ * With fake_vrls, every 50th record is data that looks like a chain of sound
+ * visible records, so that shards can start in the wrong place.
+ */
+void write_logical_files(const std::string& path,
+                         int logical_files,
+                         int records,
+                         int max_size,
+                         std::size_t large,
+                         bool fake_vrls) {
+    dl::writer out(path, 128, 32);
+    out.storage_label(1, "io test");
+    for (int lf = 0; lf < logical_files; ++lf) {
+        out.logical_file();
+        const auto header = body(40, lf);
+        out.write(0, true, header.data(), header.size());
+        for (int i = 0; i < records; ++i) {
+            auto b = body(1 + (i * 37) % max_size, i);
+            if (fake_vrls and i % 50 == 25) {
+                const char fake[] = { 0x00, 0x08, char(0xFF), 0x01,
+                                      0x00, 0x04, 0x00, 0x00 };
+                for (std::size_t k = 0; k < b.size(); ++k)
+                    b[k] = fake[k % sizeof(fake)];
+            }
+            out.write(i % 3 ? 0 : DLIS_CHANNL, i % 3 == 0,
+                      b.data(), b.size());
+        }
+        if (large > 0) {
+            const auto b = body(large, lf);
+            out.write(0, false, b.data(), b.size());
+        }
+    }
+    out.close();
+}
+
+}
+
+TEST_CASE("Record views are identical to extracted records", "[io]") {
+    const auto path = std::string("io-record-view.dlis");
+
+    /*
+     * Small visible records and segments, so that the file has both records
+     * that fit in a single segment (some of which are padded) and records
+     * that are split over segments and visible records
+     */
+    const std::vector< std::vector< char > > bodies = {
+        body(5,   0),
+        body(20,  1),
+        body(21,  2),
+        body(300, 3),
+        body(1,   4),
+        body(999, 5),
+    };
+
+    {
+        dl::writer out(path, 128, 64);
+        out.storage_label(1, "io test");
+        out.logical_file();
+        for (std::size_t i = 0; i < bodies.size(); ++i) {
+            const auto& b = bodies[i];
+            out.write(int(i % 2 ? 0 : DLIS_CHANNL), i % 2 == 0,
+                      b.data(), b.size());
+        }
+        out.close();
+    }
+
+    fail_handler handler;
+    auto file = dl::open(path, DLIS_SUL_SIZE);
+    file = dl::open_rp66(file);
+    const auto offsets = dl::findoffsets(file, handler);
+    REQUIRE(offsets.broken.empty());
+
+    std::vector< long long > tells;
+    tells.insert(tells.end(), offsets.explicits.begin(),
+                              offsets.explicits.end());
+    tells.insert(tells.end(), offsets.implicits.begin(),
+                              offsets.implicits.end());
+    std::sort(tells.begin(), tells.end());
+    REQUIRE(tells.size() == bodies.size());
+
+    const auto bytes = std::make_shared< std::vector< char > >(slurp(path));
+    const auto* begin = bytes->data() + DLIS_SUL_SIZE;
+    const auto size = bytes->size() - DLIS_SUL_SIZE;
+    const dl::memory_file mem(begin, size, bytes);
+
+    for (std::size_t i = 0; i < tells.size(); ++i) {
+        const auto rec  = dl::extract(file, tells[i], handler);
+        const auto view = dl::extract(mem, tells[i], handler);
+
+        CHECK(view.type == rec.type);
+        CHECK(view.attributes == rec.attributes);
+        CHECK(view.consistent == rec.consistent);
+        CHECK(view.isexplicit() == rec.isexplicit());
+        CHECK(view.owner == bytes);
+
+        const auto data = std::vector< char >(view.data(),
+                                              view.data() + view.size());
+        CHECK(data == rec.data);
+        CHECK(data == bodies[i]);
+
+        /* single-segment records point straight into the source */
+        if (bodies[i].size() <= 64 - DLIS_LRSH_SIZE) {
+            CHECK(not view.stitched);
+            CHECK(view.data() >= begin);
+            CHECK(view.data() + view.size() <= begin + size);
+        } else {
+            CHECK(view.stitched);
+        }
+    }
+
+    file.close();
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Record views fail on truncated data", "[io]") {
+    const auto path = std::string("io-record-view-truncated.dlis");
+    const auto data = body(300, 0);
+
+    {
+        dl::writer out(path, 128);
+        out.storage_label(1, "io test");
+        out.logical_file();
+        out.write(DLIS_CHANNL, true, data.data(), data.size());
+        out.close();
+    }
+
+    fail_handler handler;
+    const auto bytes = slurp(path);
+    const auto* begin = bytes.data() + DLIS_SUL_SIZE;
+
+    const dl::memory_file whole(begin, bytes.size() - DLIS_SUL_SIZE);
+    CHECK(dl::extract(whole, 0, handler).size() == data.size());
+
+    const dl::memory_file truncated(begin, bytes.size() - DLIS_SUL_SIZE - 10);
+    CHECK_THROWS_AS(dl::extract(truncated, 0, handler), std::runtime_error);
+    CHECK_THROWS_AS(dl::extract(truncated, 1000, handler), std::runtime_error);
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("FDATA records are indexed by first frame number", "[io]") {
+    const auto path = std::string("io-frame-index.dlis");
+    const auto name = dl::obname{
+        dl::origin{ 10 }, dl::ushort{ 0 }, dl::ident{ "MAIN" }
+    };
+
+    /*
+     * 200 frames, 7 frames per record, numbered from 100. Frame numbers from
+     * 128 and up are 2-byte uvaris
+     */
+    std::vector< std::int32_t > xs(200);
+    for (std::size_t i = 0; i < xs.size(); ++i)
+        xs[i] = std::int32_t(i);
+
+    {
+        dl::writer out(path, 256);
+        out.storage_label(1, "io test");
+        out.logical_file();
+        out.write_frames(name, {
+            { dl::representation_code::slong, 1, xs.data() },
+        }, 100, xs.size(), 7);
+        out.close();
+    }
+
+    fail_handler handler;
+    auto file = dl::open(path, DLIS_SUL_SIZE);
+    file = dl::open_rp66(file);
+    const auto offsets = dl::findoffsets(file, handler);
+    const auto index = dl::indexfdata(file, offsets.implicits, handler);
+
+    const auto key = name.fingerprint("FRAME");
+    REQUIRE(index.size() == 1);
+    const auto& recs = index.at(key);
+    REQUIRE(recs.size() == 29);
+    for (std::size_t i = 0; i < recs.size(); ++i) {
+        CHECK(recs[i].tell == offsets.implicits[i]);
+        CHECK(recs[i].frameno == std::int32_t(100 + 7 * i));
+    }
+
+    const auto fdata = dl::findfdata(file, offsets.implicits, handler);
+    CHECK(fdata.at(key) == offsets.implicits);
+
+    SECTION("ranges inside the file select the overlapping records") {
+        /* frames 150-160 are in records 7 (149-155) and 8 (156-162) */
+        const auto tells = dl::findframes(recs, 150, 160);
+        const auto expected = std::vector< long long >{
+            recs[7].tell, recs[8].tell
+        };
+        CHECK(tells == expected);
+    }
+
+    SECTION("ranges outside the file select nothing, or a single record") {
+        CHECK(dl::findframes(recs, 1000, 2000).size() == 1);
+        CHECK(dl::findframes(recs, 0, 50).empty());
+    }
+
+    SECTION("records out of order fall back to all records") {
+        auto shuffled = recs;
+        std::swap(shuffled[3], shuffled[10]);
+        shuffled[5].frameno = -1;
+        const auto tells = dl::findframes(shuffled, 150, 160);
+        CHECK(tells.size() == recs.size());
+    }
+
+    SECTION("records without a frame number are always selected") {
+        auto broken = recs;
+        broken[2].frameno = -1;
+        broken[20].frameno = -1;
+        const auto tells = dl::findframes(broken, 150, 160);
+        const auto expected = std::vector< long long >{
+            recs[2].tell, recs[7].tell, recs[8].tell, recs[20].tell
+        };
+        CHECK(tells == expected);
+    }
+
+    file.close();
+    std::remove(path.c_str());
+}
+
+TEST_CASE("FDATA records are indexed by index channel", "[io]") {
+    const auto path = std::string("io-index-values.dlis");
+    const auto name = dl::obname{
+        dl::origin{ 10 }, dl::ushort{ 0 }, dl::ident{ "MAIN" }
+    };
+
+    /* 50 frames, 5 frames per record, with depth decreasing by 0.5 */
+    std::vector< double > depth(50);
+    for (std::size_t i = 0; i < depth.size(); ++i)
+        depth[i] = 2000.0 - 0.5 * i;
+
+    {
+        dl::writer out(path, 256);
+        out.storage_label(1, "io test");
+        out.logical_file();
+        out.write_frames(name, {
+            { dl::representation_code::fdoubl, 1, depth.data() },
+        }, 1, depth.size(), 5);
+        out.close();
+    }
+
+    fail_handler handler;
+    auto file = dl::open(path, DLIS_SUL_SIZE);
+    file = dl::open_rp66(file);
+    const auto offsets = dl::findoffsets(file, handler);
+    const auto& tells = offsets.implicits;
+
+    const auto values = dl::indexvalues(file, tells, DLIS_FMT_FDOUBL, handler);
+    REQUIRE(values.size() == 10);
+    for (std::size_t i = 0; i < values.size(); ++i)
+        CHECK(values[i] == 2000.0 - 2.5 * i);
+
+    SECTION("decreasing index is searched in either order") {
+        /* [1994.0, 1990.0] is in records 2 (1995.0-1993.0), 3 and 4 */
+        const auto expected = std::vector< long long >{
+            tells[2], tells[3], tells[4]
+        };
+        CHECK(dl::findindex(tells, values, 1990.0, 1994.0) == expected);
+        CHECK(dl::findindex(tells, values, 1994.0, 1990.0) == expected);
+    }
+
+    SECTION("increasing index") {
+        auto reversed = values;
+        std::reverse(reversed.begin(), reversed.end());
+        const auto selected = dl::findindex(tells, reversed, 1990.0, 1994.0);
+        /* record 4 may end with 1990.0 if the index has repeated values */
+        const auto expected = std::vector< long long >{
+            tells[4], tells[5], tells[6]
+        };
+        CHECK(selected == expected);
+    }
+
+    SECTION("unsorted index falls back to all records") {
+        auto shuffled = values;
+        std::swap(shuffled[1], shuffled[7]);
+        shuffled[0] = std::numeric_limits< double >::quiet_NaN();
+        const auto selected = dl::findindex(tells, shuffled, 1990.0, 1994.0);
+        CHECK(selected == tells);
+    }
+
+    SECTION("records without an index value are always returned") {
+        auto broken = values;
+        broken[0] = std::numeric_limits< double >::quiet_NaN();
+        broken[3] = std::numeric_limits< double >::quiet_NaN();
+        broken[8] = std::numeric_limits< double >::quiet_NaN();
+        const auto selected = dl::findindex(tells, broken, 1990.0, 1994.0);
+        const auto expected = std::vector< long long >{
+            tells[0], tells[2], tells[3], tells[4], tells[8]
+        };
+        CHECK(selected == expected);
+    }
+
+    SECTION("batch reader reads the same index values") {
+        auto raw = dl::open(path, 0);
+        long long end = -1;
+        dl::vr_index vrs;
+        dl::findoffsets(raw, DLIS_SUL_SIZE, end, handler, false, &vrs);
+        raw.close();
+
+        const dl::batch_reader reader(path, vrs, 4);
+        const auto batched =
+            dl::indexvalues(reader, tells, DLIS_FMT_FDOUBL, handler);
+        CHECK(batched == values);
+    }
+
+    SECTION("non-numeric index formats are not supported") {
+        CHECK_THROWS_AS(
+            dl::indexvalues(file, tells, DLIS_FMT_ASCII, handler),
+            dl::not_implemented
+        );
+    }
+
+    file.close();
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Resync finds the next sound visible record", "[io]") {
+    const auto path = std::string("io-resync.dlis");
+
+    {
+        dl::writer out(path, 128);
+        out.storage_label(1, "io test");
+        out.logical_file();
+        for (int i = 0; i < 20; ++i) {
+            const auto b = body(100, i);
+            out.write(0, false, b.data(), b.size());
+        }
+        out.close();
+    }
+
+    auto bytes = slurp(path);
+
+    /* the visible records, from the lengths in their envelopes */
+    std::vector< long long > vrs;
+    for (long long pos = DLIS_SUL_SIZE; pos < (long long)bytes.size(); ) {
+        int len, version;
+        dlis_vrl(bytes.data() + pos, &len, &version);
+        vrs.push_back(pos);
+        pos += len;
+    }
+    REQUIRE(vrs.size() > 5);
+
+    /*
+     * Break the segment header of the second visible record, and plant
+     * something that looks like an envelope in the middle of it
+     */
+    const auto broken = vrs[1];
+    bytes[broken + DLIS_VRL_SIZE]     = char(0x7F);
+    bytes[broken + DLIS_VRL_SIZE + 1] = char(0xFF);
+    const char fake[] = { 0x00, 0x40, char(0xFF), 0x01 };
+    std::memcpy(bytes.data() + broken + 20, fake, sizeof(fake));
+
+    {
+        std::ofstream fs(path, std::ios::binary);
+        fs.write(bytes.data(), bytes.size());
+    }
+
+    auto file = dl::open(path, 0);
+    /* the first record is intact, but the chain after it is not */
+    CHECK(dl::resyncvrl(file, vrs[0], 1) == vrs[0]);
+    CHECK(dl::resyncvrl(file, vrs[0]) == vrs[2]);
+    CHECK(dl::resyncvrl(file, broken) == vrs[2]);
+
+    /* the last record ends at end-of-file, which is sound too */
+    CHECK(dl::resyncvrl(file, vrs.back()) == vrs.back());
+    CHECK_THROWS_AS(dl::resyncvrl(file, vrs.back() + 1), dl::not_found);
+    CHECK_THROWS_AS(dl::resyncvrl(file, 0, 0), std::out_of_range);
+
+    file.close();
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Bulk indexing is identical to indexing the rp66 stream", "[io]") {
+    const auto path = std::string("io-bulk-offsets.dlis");
+
+    /*
+     * Two logical files, both with FILE-HEADER first, and with tiny visible
+     * records and segments so that both the block boundaries and the
+     * records split over visible records are exercised. The large record is
+     * bigger than the block, and is skipped by seeking
+     */
+    write_logical_files(path, 2, 50, 150, 3 << 20, false);
+
+    const auto bytes = slurp(path);
+
+    auto file = dl::open(path, 0);
+    const auto vrl = dl::findvrl(file, DLIS_SUL_SIZE);
+    REQUIRE(vrl == DLIS_SUL_SIZE);
+
+    auto indexlf = [&](long long from, std::size_t truncated) {
+        {
+            std::ofstream fs(path, std::ios::binary | std::ios::trunc);
+            fs.write(bytes.data(), bytes.size() - truncated);
+        }
+
+        collect_handler expected_handler;
+        auto rp66 = dl::open(path, from);
+        rp66 = dl::open_rp66(rp66);
+        const auto expected = dl::findoffsets(rp66, expected_handler);
+        const auto expected_end = rp66.absolute_tell();
+        rp66.close();
+
+        collect_handler handler;
+        auto raw = dl::open(path, 0);
+        long long end = -1;
+        const auto ofs = dl::findoffsets(raw, from, end, handler);
+        raw.close();
+
+        CHECK(ofs.explicits == expected.explicits);
+        CHECK(ofs.implicits == expected.implicits);
+        CHECK(ofs.broken == expected.broken);
+        CHECK(handler.problems.size() == expected_handler.problems.size());
+        if (expected.broken.empty())
+            CHECK(end == expected_end);
+        return ofs;
+    };
+
+    /* the second logical file starts where indexing of the first ended */
+    collect_handler handler;
+    long long end = -1;
+    dl::findoffsets(file, vrl, end, handler);
+    const auto next = dl::findvrl(file, end - DLIS_VRL_SIZE);
+    CHECK(next == end - DLIS_VRL_SIZE);
+    CHECK(handler.problems.empty());
+
+    SECTION("both logical files are indexed") {
+        for (const auto from : { vrl, next }) {
+            const auto ofs = indexlf(from, 0);
+            CHECK(ofs.explicits.size() == 18);
+            CHECK(ofs.implicits.size() == 34);
+            CHECK(ofs.broken.empty());
+        }
+    }
+
+    SECTION("truncated files are broken at the same record") {
+        for (const auto n : { 1, 3, 10, 100, 200, 3 << 20 }) {
+            const auto ofs = indexlf(next, n);
+            CHECK(ofs.broken.size() == 1);
+        }
+    }
+
+    file.close();
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Parallel indexing is identical to sequential indexing",
+          "[io][threads]") {
+    const auto path = std::string("io-parallel-offsets.dlis");
+
+    /*
+     * Like the bulk indexing test, so that records are split over many small
+     * visible records, and the shards are split in the middle of records
+     */
+    write_logical_files(path, 2, 200, 300, 1 << 16, true);
+
+    const auto bytes = slurp(path);
+    const auto rewrite = [&](const std::vector< char >& xs, std::size_t n) {
+        std::ofstream fs(path, std::ios::binary | std::ios::trunc);
+        fs.write(xs.data(), n);
+    };
+
+    std::vector< long long > vrls;
+    for (long long pos = DLIS_SUL_SIZE; pos < (long long)bytes.size(); ) {
+        int len, version;
+        dlis_vrl(bytes.data() + pos, &len, &version);
+        vrls.push_back(pos);
+        pos += len;
+    }
+
+    auto indexlf = [&](long long from, int shards) {
+        collect_handler expected_handler;
+        dl::vr_index expected_vrs;
+        long long expected_end = -1;
+        auto raw = dl::open(path, 0);
+        const auto expected = dl::findoffsets(raw, from, expected_end,
+                                              expected_handler, false,
+                                              &expected_vrs);
+        raw.close();
+
+        collect_handler handler;
+        dl::vr_index vrs;
+        long long end = -1;
+        const auto ofs = dl::findoffsets(path, from, end, handler, shards,
+                                         false, &vrs);
+
+        CHECK(ofs.explicits == expected.explicits);
+        CHECK(ofs.implicits == expected.implicits);
+        CHECK(ofs.broken == expected.broken);
+        CHECK(end == expected_end);
+        CHECK(handler.problems == expected_handler.problems);
+
+        CHECK(vrs.size() == expected_vrs.size());
+        CHECK(vrs.end() == expected_vrs.end());
+        for (long long tell = 0; tell < expected_vrs.end(); tell += 97) {
+            dl::vr_index::extent vr, expected_vr;
+            REQUIRE(expected_vrs.find(tell, expected_vr));
+            REQUIRE(vrs.find(tell, vr));
+            CHECK(vr.tell == expected_vr.tell);
+            CHECK(vr.offset == expected_vr.offset);
+        }
+        return ofs;
+    };
+
+    collect_handler handler;
+    long long end = -1;
+    auto file = dl::open(path, 0);
+    dl::findoffsets(file, DLIS_SUL_SIZE, end, handler);
+    const auto next = dl::findvrl(file, end - DLIS_VRL_SIZE);
+    file.close();
+    REQUIRE(handler.problems.empty());
+
+    const auto shards = { 1, 2, 3, 8, 100, 5000 };
+
+    SECTION("both logical files are indexed") {
+        for (const auto from : { (long long)DLIS_SUL_SIZE, next }) {
+            for (const auto n : shards) {
+                const auto ofs = indexlf(from, n);
+                CHECK(ofs.explicits.size() == 68);
+                CHECK(ofs.implicits.size() == 134);
+                CHECK(ofs.broken.empty());
+            }
+        }
+    }
+
+    SECTION("records cut at a visible record are broken") {
+        /* in the middle of the large record at the end of the file */
+        rewrite(bytes, vrls[vrls.size() - 10]);
+        for (const auto n : shards) {
+            const auto ofs = indexlf(next, n);
+            CHECK(ofs.broken.size() == 1);
+        }
+    }
+
+    SECTION("truncated files are broken at the same record") {
+        for (const auto truncated : { 1, 3, 10, 200, 1 << 15 }) {
+            rewrite(bytes, bytes.size() - truncated);
+            for (const auto n : shards) {
+                const auto ofs = indexlf(next, n);
+                CHECK(ofs.broken.size() == 1);
+            }
+        }
+    }
+
+    SECTION("broken visible records are indexed sequentially") {
+        auto broken = bytes;
+        /* a visible record of the wrong version, in the first logical file */
+        broken[vrls[20] + 3] = 2;
+        rewrite(broken, broken.size());
+        for (const auto n : shards) {
+            const auto ofs = indexlf(DLIS_SUL_SIZE, n);
+            CHECK(ofs.broken.size() == 1);
+        }
+
+        /* but only if the logical file is broken, not the next one */
+        for (const auto n : shards)
+            indexlf(next, n);
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Parallel indexing only walks the logical file",
+          "[io][threads][stats]") {
+    const auto path = std::string("io-parallel-many.dlis");
+    constexpr int logical_files = 16;
+    write_logical_files(path, logical_files, 50, 300, 0, false);
+    const auto size = (long long)slurp(path).size();
+
+    /*
+     * Index the logical files one after the other, like dlisio.load. The
+     * shards stop at the first FILE-HEADER, so the segments walked to index
+     * all the logical files are proportional to the file, not to the number
+     * of logical files times the file
+     */
+    long long sequential = 0;
+    long long sharded = 0;
+    int indexed = 0;
+    for (long long from = DLIS_SUL_SIZE; from < size; ++indexed) {
+        REQUIRE(indexed < logical_files);
+
+        fail_handler handler;
+        long long expected_end = -1;
+        auto file = dl::open(path, 0);
+        dl::stats::reset();
+        const auto expected = dl::findoffsets(file, from, expected_end,
+                                              handler);
+        sequential += dl::stats::read().count[dl::stats::segments];
+
+        long long end = -1;
+        dl::stats::reset();
+        const auto ofs = dl::findoffsets(path, from, end, handler, 2);
+        sharded += dl::stats::read().count[dl::stats::segments];
+
+        CHECK(ofs.explicits == expected.explicits);
+        CHECK(ofs.implicits == expected.implicits);
+        CHECK(ofs.broken.empty());
+        CHECK(end == expected_end);
+
+        from = end < size ? dl::findvrl(file, end - DLIS_VRL_SIZE) : size;
+        file.close();
+    }
+    std::remove(path.c_str());
+
+    CHECK(indexed == logical_files);
+    if (dl::stats::enabled())
+        CHECK(sharded <= 3 * sequential);
+}
+
+TEST_CASE("Checksums are verified on request", "[io]") {
+    const auto path = std::string("io-checksum.dlis");
+
+    /* records over several segments, so that some segments are padded */
+    {
+        dl::writer out(path, 128, 48);
+        out.checksums(true);
+        out.storage_label(1, "io test");
+        out.logical_file();
+        for (int i = 0; i < 6; ++i) {
+            const auto b = body(20 + 15 * i, i);
+            out.write(0, i == 0, b.data(), b.size());
+        }
+        out.close();
+    }
+
+    auto bytes = slurp(path);
+
+    collect_handler handler;
+    auto file = dl::open(path, DLIS_SUL_SIZE);
+    file = dl::open_rp66(file);
+    const auto offsets = dl::findoffsets(file, handler, true);
+    REQUIRE(handler.problems.empty());
+    REQUIRE(offsets.implicits.size() == 5);
+    CHECK(offsets.corrupt.empty());
+
+    for (const auto tell : offsets.implicits) {
+        const auto rec = dl::extract(file, tell, handler, true);
+        CHECK(not rec.data.empty());
+    }
+    CHECK(handler.problems.empty());
+    file.close();
+
+    /* flip a bit in the body of the fourth record */
+    const auto victim = offsets.implicits[2];
+    auto target = victim + DLIS_LRSH_SIZE + 2;
+    long long pos = DLIS_SUL_SIZE;
+    while (true) {
+        int len, version;
+        dlis_vrl(bytes.data() + pos, &len, &version);
+        if (target < len - DLIS_VRL_SIZE) break;
+        target -= len - DLIS_VRL_SIZE;
+        pos += len;
+    }
+    bytes[pos + DLIS_VRL_SIZE + target] ^= 0x10;
+    {
+        std::ofstream fs(path, std::ios::binary);
+        fs.write(bytes.data(), bytes.size());
+    }
+
+    SECTION("findoffsets") {
+        auto file = dl::open(path, DLIS_SUL_SIZE);
+        file = dl::open_rp66(file);
+        const auto verified = dl::findoffsets(file, handler, true);
+        CHECK(verified.implicits == offsets.implicits);
+        CHECK(verified.broken.empty());
+        CHECK(verified.corrupt == std::vector< long long >{ victim });
+        CHECK(handler.problems.size() == 1);
+        file.close();
+
+        long long end;
+        auto raw = dl::open(path, 0);
+        const auto bulk = dl::findoffsets(raw, DLIS_SUL_SIZE, end, handler,
+                                          true);
+        CHECK(bulk.corrupt == verified.corrupt);
+        raw.close();
+    }
+
+    SECTION("extract") {
+        auto file = dl::open(path, DLIS_SUL_SIZE);
+        file = dl::open_rp66(file);
+        const auto unverified = dl::extract(file, victim, handler);
+        CHECK(handler.problems.empty());
+
+        const auto rec = dl::extract(file, victim, handler, true);
+        CHECK(rec.data == unverified.data);
+        REQUIRE(handler.problems.size() == 1);
+        CHECK(handler.problems[0].find("checksum mismatch")
+              != std::string::npos);
+        file.close();
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Stats count indexing and extracting", "[io][stats]") {
+    const auto path = std::string("io-stats.dlis");
+    {
+        dl::writer out(path, 128, 48);
+        out.storage_label(1, "io test");
+        out.logical_file();
+        for (int i = 0; i < 6; ++i) {
+            const auto b = body(20 + 15 * i, i);
+            out.write(0, i == 0, b.data(), b.size());
+        }
+        out.close();
+    }
+
+    fail_handler handler;
+    auto file = dl::open(path, DLIS_SUL_SIZE);
+    file = dl::open_rp66(file);
+
+    dl::stats::reset();
+    const auto offsets = dl::findoffsets(file, handler);
+    const auto indexed = dl::stats::read();
+
+    for (const auto tell : offsets.implicits)
+        dl::extract(file, tell, handler);
+    const auto extracted = dl::stats::read();
+    file.close();
+    std::remove(path.c_str());
+
+    using namespace dl::stats;
+    if (not enabled()) {
+        for (const auto x : extracted.count) CHECK(x == 0);
+        for (const auto x : extracted.calls) CHECK(x == 0);
+        return;
+    }
+
+    CHECK(indexed.calls[findoffsets] == 1);
+    CHECK(indexed.calls[extract] == 0);
+    CHECK(indexed.count[records] == 0);
+    CHECK(indexed.count[segments] > 6);
+    CHECK(indexed.count[bytes_read] > 0);
+
+    CHECK(extracted.calls[findoffsets] == 1);
+    CHECK(extracted.calls[extract] == 5);
+    CHECK(extracted.count[records] == 5);
+    CHECK(extracted.count[segments] - indexed.count[segments] > 5);
+    CHECK(extracted.count[seeks] > indexed.count[seeks]);
+    CHECK(extracted.count[bytes_read] > indexed.count[bytes_read]);
+    CHECK(extracted.nanoseconds[extract] > 0);
+}
+
+TEST_CASE("Checksum mismatches are collected once per problem", "[io]") {
+    const auto path = std::string("io-checksum-sink.dlis");
+    {
+        dl::writer out(path, 8192);
+        out.checksums(true);
+        out.storage_label(1, "io test");
+        out.logical_file();
+        for (int i = 0; i < 6; ++i) {
+            const auto b = body(20 + 15 * i, i);
+            out.write(0, i == 0, b.data(), b.size());
+        }
+        out.close();
+    }
+
+    fail_handler handler;
+    auto file = dl::open(path, DLIS_SUL_SIZE);
+    file = dl::open_rp66(file);
+    const auto offsets = dl::findoffsets(file, handler, true);
+    file.close();
+    REQUIRE(offsets.implicits.size() == 5);
+
+    /* everything fits in a single visible record */
+    auto bytes = slurp(path);
+    for (const auto tell : offsets.implicits)
+        bytes[DLIS_SUL_SIZE + DLIS_VRL_SIZE + tell + DLIS_LRSH_SIZE] ^= 0x10;
+    {
+        std::ofstream fs(path, std::ios::binary);
+        fs.write(bytes.data(), bytes.size());
+    }
+
+    dl::error_sink sink;
+    file = dl::open(path, DLIS_SUL_SIZE);
+    file = dl::open_rp66(file);
+    const auto verified = dl::findoffsets(file, sink, true);
+    for (const auto tell : verified.implicits)
+        dl::extract(file, tell, sink, true);
+    file.close();
+    std::remove(path.c_str());
+
+    CHECK(verified.corrupt == offsets.implicits);
+    CHECK(sink.count() == 10);
+
+    const auto problems = sink.problems();
+    REQUIRE(problems.size() == 2);
+    CHECK(problems[0].context == "dl::findoffsets (checksum)");
+    CHECK(problems[0].count == 5);
+    CHECK(problems[0].tells == offsets.implicits);
+    CHECK(problems[1].context == "extract (checksum)");
+    CHECK(problems[1].count == 5);
+    CHECK(problems[1].tells == offsets.implicits);
+    CHECK(problems[1].problem.find("checksum mismatch") != std::string::npos);
+}
+
+TEST_CASE("Visible record index maps tells to runs", "[io]") {
+    dl::vr_index vrs;
+    vrs.append(80, 100);
+    vrs.append(180, 100);
+    vrs.append(280, 100);
+    /* already indexed, e.g. read again after seeking back */
+    vrs.append(180, 100);
+    /* empty visible records hold no bytes */
+    vrs.append(380, DLIS_VRL_SIZE);
+    vrs.append(384, 50);
+
+    CHECK(vrs.size() == 4);
+    CHECK(vrs.end() == 3 * 96 + 46);
+
+    dl::vr_index::extent vr;
+    REQUIRE(vrs.find(0, vr));
+    CHECK(vr.tell == 0);
+    CHECK(vr.offset == 84);
+    CHECK(vr.size == 96);
+
+    REQUIRE(vrs.find(200, vr));
+    CHECK(vr.tell == 192);
+    CHECK(vr.offset == 284);
+    CHECK(vr.size == 96);
+
+    REQUIRE(vrs.find(288, vr));
+    CHECK(vr.tell == 288);
+    CHECK(vr.offset == 388);
+    CHECK(vr.size == 46);
+
+    CHECK(not vrs.find(-1, vr));
+    CHECK(not vrs.find(vrs.end(), vr));
+
+    /* indices of parts of a file are joined in order */
+    dl::vr_index joined;
+    joined.append(vrs, 280);
+    CHECK(joined.size() == 2);
+    joined.append(vrs);
+    CHECK(joined.size() == vrs.size());
+    CHECK(joined.end() == vrs.end());
+}
+
+TEST_CASE("Batched reads are identical to extracting from the stream",
+          "[io][threads]") {
+    const auto path = std::string("io-batch-reader.dlis");
+
+    /*
+     * Small visible records and segments, so that records share visible
+     * records and are split over several of them
+     */
+    {
+        dl::writer out(path, 128, 48);
+        out.storage_label(1, "io test");
+        out.logical_file();
+        for (int i = 0; i < 200; ++i) {
+            const auto b = body(1 + (i * 37) % 400, i);
+            out.write(i % 4 ? 0 : DLIS_CHANNL, i % 4 == 0,
+                      b.data(), b.size());
+        }
+        out.close();
+    }
+
+    collect_handler handler;
+    auto raw = dl::open(path, 0);
+    long long end = -1;
+    dl::vr_index vrs;
+    const auto ofs = dl::findoffsets(raw, DLIS_SUL_SIZE, end, handler,
+                                     false, &vrs);
+    raw.close();
+    REQUIRE(ofs.broken.empty());
+    CHECK(vrs.size() > 100);
+
+    std::vector< long long > tells;
+    tells.insert(tells.end(), ofs.explicits.begin(), ofs.explicits.end());
+    tells.insert(tells.end(), ofs.implicits.begin(), ofs.implicits.end());
+    std::sort(tells.begin(), tells.end());
+    REQUIRE(tells.size() == 200);
+
+    auto file = dl::open(path, DLIS_SUL_SIZE);
+    file = dl::open_rp66(file);
+
+    const auto all = std::numeric_limits< long long >::max();
+    for (const auto depth : { 1, 4, 64 }) {
+        const dl::batch_reader reader(path, vrs, depth);
+        CHECK(reader.depth() == depth);
+
+        for (const auto bytes : { all, 10LL }) {
+            const auto recs = reader.extract(tells, bytes, handler);
+            REQUIRE(recs.size() == tells.size());
+
+            dl::record expected;
+            for (std::size_t i = 0; i < tells.size(); ++i) {
+                dl::extract(file, tells[i], bytes, expected, handler);
+                const auto& rec = recs[i];
+                CHECK(rec.tell == tells[i]);
+                CHECK(rec.error.empty());
+                CHECK(rec.record.type == expected.type);
+                CHECK(rec.record.attributes == expected.attributes);
+                CHECK(rec.record.consistent == expected.consistent);
+                CHECK(rec.record.data == expected.data);
+            }
+        }
+
+        const auto index = dl::indexfdata(reader, ofs.implicits, handler);
+        const auto expected = dl::indexfdata(file, ofs.implicits, handler);
+        REQUIRE(index.size() == expected.size());
+        auto itr = expected.begin();
+        for (const auto& frame : index) {
+            CHECK(frame.first == itr->first);
+            REQUIRE(frame.second.size() == itr->second.size());
+            for (std::size_t i = 0; i < frame.second.size(); ++i) {
+                CHECK(frame.second[i].tell == itr->second[i].tell);
+                CHECK(frame.second[i].frameno == itr->second[i].frameno);
+            }
+            ++itr;
+        }
+    }
+
+    SECTION("records that cannot be read are returned with the error") {
+        const dl::batch_reader reader(path, vrs, 4);
+        const auto recs = reader.extract({ tells[1], vrs.end() + 10 },
+                                         all, handler);
+        REQUIRE(recs.size() == 2);
+        CHECK(recs[0].error.empty());
+        CHECK(recs[1].error.find("LRSH") != std::string::npos);
+    }
+
+    SECTION("the reader is shared between threads") {
+        const dl::batch_reader reader(path, vrs, 4);
+        const auto expected = reader.extract(tells, all, handler);
+
+        std::vector< std::vector< dl::batch_record > > results(4);
+        std::vector< std::thread > threads;
+        for (auto& result : results) {
+            threads.emplace_back([&] {
+                collect_handler local;
+                for (int i = 0; i < 10; ++i)
+                    result = reader.extract(tells, all, local);
+            });
+        }
+        for (auto& t : threads) t.join();
+
+        for (const auto& result : results) {
+            REQUIRE(result.size() == expected.size());
+            for (std::size_t i = 0; i < result.size(); ++i)
+                CHECK(result[i].record.data == expected[i].record.data);
+        }
+    }
+
+    SECTION("closed readers cannot be read") {
+        dl::batch_reader reader(path, vrs, 4);
+        reader.close();
+        CHECK_THROWS_AS(reader.extract(tells, all, handler), dl::io_error);
+    }
+
+    file.close();
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Batched reads report problems in the order of tells", "[io]") {
+    const auto path = std::string("io-batch-checksum.dlis");
+    {
+        dl::writer out(path, 128);
+        out.checksums(true);
+        out.storage_label(1, "io test");
+        out.logical_file();
+        for (int i = 0; i < 20; ++i) {
+            const auto b = body(20, i);
+            out.write(0, i == 0, b.data(), b.size());
+        }
+        out.close();
+    }
+
+    fail_handler handler;
+    auto raw = dl::open(path, 0);
+    long long end = -1;
+    dl::vr_index vrs;
+    const auto ofs = dl::findoffsets(raw, DLIS_SUL_SIZE, end, handler,
+                                     true, &vrs);
+    raw.close();
+    REQUIRE(ofs.implicits.size() == 19);
+
+    /* break the checksum of every other record */
+    auto bytes = slurp(path);
+    std::vector< long long > broken;
+    for (std::size_t i = 0; i < ofs.implicits.size(); i += 2) {
+        const auto tell = ofs.implicits[i];
+        dl::vr_index::extent vr;
+        REQUIRE(vrs.find(tell + DLIS_LRSH_SIZE, vr));
+        bytes[vr.offset + (tell + DLIS_LRSH_SIZE - vr.tell)] ^= 0x10;
+        broken.push_back(tell);
+    }
+    {
+        std::ofstream fs(path, std::ios::binary);
+        fs.write(bytes.data(), bytes.size());
+    }
+
+    dl::error_sink sink;
+    const dl::batch_reader reader(path, vrs, 8);
+    const auto recs = reader.extract(ofs.implicits,
+                                     std::numeric_limits< long long >::max(),
+                                     sink,
+                                     true);
+    std::remove(path.c_str());
+
+    for (const auto& rec : recs)
+        CHECK(rec.error.empty());
+
+    const auto problems = sink.problems();
+    REQUIRE(problems.size() == 1);
+    CHECK(problems[0].context == "extract (checksum)");
+    CHECK(problems[0].tells == broken);
+}
+
+TEST_CASE("In-memory files are read like files on disk", "[io]") {
+    const auto path = std::string("io-open-memory.dlis");
+    {
+        dl::writer out(path, 128, 48);
+        out.storage_label(1, "io test");
+        out.logical_file();
+        for (int i = 0; i < 20; ++i) {
+            const auto b = body(1 + (i * 37) % 300, i);
+            out.write(0, i % 3 == 0, b.data(), b.size());
+        }
+        out.close();
+    }
+
+    fail_handler handler;
+    auto file = dl::open(path, DLIS_SUL_SIZE);
+    file = dl::open_rp66(file);
+    const auto expected = dl::findoffsets(file, handler);
+
+    const auto bytes = slurp(path);
+    auto raw = dl::open_memory(bytes.data(), bytes.size());
+    CHECK(dl::findsul(raw) == 0);
+    CHECK(dl::findvrl(raw, DLIS_SUL_SIZE) == DLIS_SUL_SIZE);
+
+    long long end = -1;
+    const auto bulk = dl::findoffsets(raw, DLIS_SUL_SIZE, end, handler);
+    CHECK(bulk.explicits == expected.explicits);
+    CHECK(bulk.implicits == expected.implicits);
+    raw.close();
+
+    auto mem = dl::open_memory(bytes.data(), bytes.size(), DLIS_SUL_SIZE);
+    mem = dl::open_rp66(mem);
+    const auto ofs = dl::findoffsets(mem, handler);
+    CHECK(ofs.explicits == expected.explicits);
+    CHECK(ofs.implicits == expected.implicits);
+    CHECK(ofs.broken.empty());
+
+    for (const auto tell : ofs.implicits) {
+        const auto rec = dl::extract(mem, tell, handler);
+        const auto disk = dl::extract(file, tell, handler);
+        CHECK(rec.type == disk.type);
+        CHECK(rec.data == disk.data);
+    }
+
+    mem.close();
+    file.close();
+    std::remove(path.c_str());
+
+    SECTION("empty buffers open, but have nothing in them") {
+        auto empty = dl::open_memory(nullptr, 0);
+        char buffer[4];
+        CHECK(empty.read(buffer, 4) == 0);
+        CHECK(empty.eof());
+        empty.close();
+    }
+}
@@ -0,0 +1,106 @@
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <dlisio/dlisio.h>
+#include <dlisio/types.h>
+#include <dlisio/ext/types.hpp>
+#include <dlisio/ext/writer.hpp>
+
+namespace {
+
+struct collect_handler : public dl::error_handler {
+    void log(const dl::error_severity&, const std::string&,
+             const std::string& problem, const std::string&,
+             const std::string&)
+    const noexcept (false) override {
+        this->problems.push_back(problem);
+    }
+
+    mutable std::vector< std::string > problems;
+};
+
+struct exact : public dl::matcher {
+    bool match(const dl::ident& pattern, const dl::ident& candidate)
+    const noexcept (false) override {
+        return pattern == candidate;
+    }
+};
+
+template < typename T >
+dl::object_attribute attribute(const std::string& label, std::vector< T > xs) {
+    dl::object_attribute attr;
+    attr.label = dl::ident{ label };
+    attr.count = dl::uvari{ std::int32_t(xs.size()) };
+    attr.reprc = dl::typeinfo< T >::reprc;
+    attr.value = std::move(xs);
+    return attr;
+}
+
+dl::obname name(const std::string& id) {
+    return dl::obname{ dl::origin{ 10 }, dl::ushort{ 2 }, dl::ident{ id } };
+}
+
+}
+
+TEST_CASE("Object sets are parsed once under concurrent queries",
+          "[parse][threads]") {
+    dl::object_vector objects;
+    for (int i = 0; i < 500; ++i) {
+        dl::basic_object ch;
+        ch.object_name = name("CH" + std::to_string(i));
+        ch.attributes = {
+            attribute("REPRESENTATION-CODE", std::vector< dl::ushort >{ 2 }),
+            attribute("DIMENSION", std::vector< dl::uvari >{ dl::uvari{ i } }),
+        };
+        objects.push_back(ch);
+    }
+
+    dl::record rec;
+    rec.type = DLIS_CHANNL;
+    rec.attributes = DLIS_SEGATTR_EXFMTLR;
+    rec.consistent = true;
+    rec.data = dl::encode_set(dl::ident{ "CHANNEL" }, dl::ident{}, objects);
+
+    /*
+     * An absent attribute in the template is logged on the set every time
+     * the set is parsed, and the log is reported by every query. A set that
+     * is parsed more than once reports the problem more than once.
+     *
+     * The set component is the descriptor and the type, i.e. 1 + 1 + 7 bytes
+     */
+    const auto template_offset = 1 + 1 + std::string("CHANNEL").size();
+    rec.data.insert(rec.data.begin() + template_offset,
+                    char(DLIS_ROLE_ABSATR));
+
+    const exact matcher;
+    const auto pool = dl::pool({ dl::object_set(rec) });
+
+    constexpr int nthreads = 8;
+    std::vector< dl::object_vector > all(nthreads);
+    std::vector< dl::object_vector > one(nthreads);
+    std::vector< collect_handler > handlers(nthreads);
+    std::vector< std::thread > threads;
+    for (int i = 0; i < nthreads; ++i) {
+        threads.emplace_back([&, i]() {
+            all[i] = pool.get("CHANNEL", matcher, handlers[i]);
+            one[i] = pool.get("CHANNEL", "CH" + std::to_string(i), matcher,
+                              handlers[i]);
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    for (int i = 0; i < nthreads; ++i) {
+        CHECK(all[i] == objects);
+        REQUIRE(one[i].size() == 1);
+        CHECK(one[i][0] == objects[i]);
+
+        const auto& problems = handlers[i].problems;
+        REQUIRE(problems.size() == 2);
+        CHECK(problems[0] == "Absent Attribute in object set template");
+        CHECK(problems[1] == "Absent Attribute in object set template");
+    }
+}
@@ -1,4 +1,5 @@
 #include <cstdint>
+#include <vector>
 
 #include <catch2/catch.hpp>
 
@@ -717,3 +718,44 @@ TEST_CASE_METHOD(
     CHECK(!err);
     CHECK(size == expected);
 }
+
+namespace {
+
+/* bit-by-bit x^16 + x^15 + x^2 + 1, reflected, as reference */
+std::uint16_t bitwise_crc16(const std::vector< char >& xs) {
+    std::uint16_t crc = 0;
+    for (const auto x : xs) {
+        crc ^= std::uint8_t(x);
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : (crc >> 1);
+    }
+    return crc;
+}
+
+}
+
+TEST_CASE("Checksum of the standard check input", "[checksum][v1]") {
+    const char xs[] = "123456789";
+    std::uint16_t crc = 0;
+    const auto err = dlis_checksum(xs, xs + 9, &crc);
+    CHECK(!err);
+    CHECK(crc == 0xBB3D);
+}
+
+TEST_CASE("Checksum matches the bitwise computation", "[checksum][v1]") {
+    std::vector< char > xs;
+    for (int size = 0; size < 100; ++size) {
+        std::uint16_t crc = 0;
+        dlis_checksum(xs.data(), xs.data() + xs.size(), &crc);
+        CHECK(crc == bitwise_crc16(xs));
+
+        /* in two pieces, like header and body */
+        const auto half = xs.size() / 3;
+        std::uint16_t pieces = 0;
+        dlis_checksum(xs.data(), xs.data() + half, &pieces);
+        dlis_checksum(xs.data() + half, xs.data() + xs.size(), &pieces);
+        CHECK(pieces == crc);
+
+        xs.push_back(char((size * 131 + 7) % 256));
+    }
+}
@@ -0,0 +1,280 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <dlisio/dlisio.h>
+#include <dlisio/types.h>
+#include <dlisio/ext/io.hpp>
+#include <dlisio/ext/repack.hpp>
+#include <dlisio/ext/types.hpp>
+#include <dlisio/ext/writer.hpp>
+
+namespace {
+
+struct fail_handler : public dl::error_handler {
+    void log(const dl::error_severity&, const std::string& context,
+             const std::string& problem, const std::string&,
+             const std::string&)
+    const noexcept (false) override {
+        FAIL(context + ": " + problem);
+    }
+};
+
+template < typename T >
+dl::object_attribute attribute(const std::string& label, std::vector< T > xs) {
+    dl::object_attribute attr;
+    attr.label = dl::ident{ label };
+    attr.count = dl::uvari{ std::int32_t(xs.size()) };
+    attr.reprc = dl::typeinfo< T >::reprc;
+    attr.value = std::move(xs);
+    return attr;
+}
+
+dl::obname name(const std::string& id) {
+    return dl::obname{ dl::origin{ 10 }, dl::ushort{ 0 }, dl::ident{ id } };
+}
+
+dl::basic_object channel(const std::string& id, int reprc, int samples) {
+    dl::basic_object obj;
+    obj.object_name = name(id);
+    obj.attributes = {
+        attribute("REPRESENTATION-CODE", std::vector< dl::ushort >{
+            dl::ushort(reprc)
+        }),
+        attribute("DIMENSION", std::vector< dl::uvari >{ dl::uvari{ samples } }),
+    };
+    return obj;
+}
+
+struct logical_file {
+    explicit logical_file(const std::string& path)
+        : file(dl::open(path, 0))
+    {
+        const auto sul = dl::findsul(this->file);
+        const auto vrl = dl::findvrl(this->file, sul + DLIS_SUL_SIZE);
+        this->file.seek(vrl);
+        this->file = dl::open_rp66(this->file);
+        this->offsets = dl::findoffsets(this->file, this->handler);
+    }
+
+    ~logical_file() {
+        this->file.close();
+    }
+
+    dl::object_vector get(const std::string& type) {
+        for (const auto tell : this->offsets.explicits) {
+            auto set = dl::object_set(dl::extract(this->file, tell,
+                                                  this->handler));
+            if (dl::decay(set.type) == type) return set.objects();
+        }
+        return {};
+    }
+
+    std::vector< char > fdata() {
+        std::vector< char > xs;
+        for (const auto tell : this->offsets.implicits) {
+            const auto rec = dl::extract(this->file, tell, this->handler);
+            xs.insert(xs.end(), rec.data.begin(), rec.data.end());
+        }
+        return xs;
+    }
+
+    fail_handler handler;
+    dl::stream file;
+    dl::stream_offsets offsets;
+};
+
+/*
+ * A logical file with a single frame MAIN = [INDEX (fdoubl), PAIR (2 x
+ * fsingl), COUNT (slong)], where INDEX = 1000, 1000.5, ... 1004.5
+ */
+const std::size_t frames = 10;
+
+void write_input(const std::string& path) {
+    std::vector< double > index;
+    std::vector< float > pairs;
+    std::vector< std::int32_t > counts;
+    for (std::size_t i = 0; i < frames; ++i) {
+        index.push_back(1000.0 + 0.5 * i);
+        pairs.push_back(float(i));
+        pairs.push_back(-float(i));
+        counts.push_back(std::int32_t(i) * 10);
+    }
+
+    dl::basic_object frame;
+    frame.object_name = name("MAIN");
+    frame.attributes = {
+        attribute("CHANNELS", std::vector< dl::obname >{
+            name("INDEX"), name("PAIR"), name("COUNT")
+        }),
+        attribute("INDEX-TYPE", std::vector< dl::ident >{
+            dl::ident{ "BOREHOLE-DEPTH" }
+        }),
+        attribute("INDEX-MIN", std::vector< dl::fdoubl >{ index.front() }),
+        attribute("INDEX-MAX", std::vector< dl::fdoubl >{ index.back() }),
+    };
+
+    dl::basic_object header;
+    header.object_name = name("0");
+    header.attributes = {
+        attribute("SEQUENCE-NUMBER", std::vector< dl::ascii >{
+            dl::ascii{ "1" }
+        }),
+    };
+
+    dl::writer out(path, 128);
+    out.storage_label(1, "repack test");
+    out.logical_file();
+    out.write_set(dl::ident{ "FILE-HEADER" }, dl::ident{}, { header });
+    out.write_set(dl::ident{ "CHANNEL" }, dl::ident{}, {
+        channel("INDEX", DLIS_FDOUBL, 1),
+        channel("PAIR",  DLIS_FSINGL, 2),
+        channel("COUNT", DLIS_SLONG,  1),
+    });
+    out.write_set(dl::ident{ "FRAME" }, dl::ident{}, { frame });
+    out.write_frames(frame.object_name, {
+        { dl::representation_code::fdoubl, 1, index.data()  },
+        { dl::representation_code::fsingl, 2, pairs.data()  },
+        { dl::representation_code::slong,  1, counts.data() },
+    }, 1, frames, 3);
+    out.close();
+}
+
+void repack(const std::string& src,
+            const std::string& dst,
+            const dl::repack_options& opts) {
+    logical_file in(src);
+    dl::writer out(dst, 128);
+    out.storage_label(1, "repack test");
+    out.logical_file();
+    dl::repack(in.file, in.offsets, opts, out, in.handler);
+    out.close();
+}
+
+}
+
+TEST_CASE("Repacking without options copies all records", "[repack]") {
+    const auto input = std::string("repack-all-input.dlis");
+    const auto output = std::string("repack-all-output.dlis");
+    write_input(input);
+    repack(input, output, dl::repack_options{});
+
+    {
+        logical_file in(input);
+        logical_file out(output);
+        CHECK(out.offsets.broken.empty());
+        CHECK(out.offsets.explicits.size() == in.offsets.explicits.size());
+        CHECK(out.offsets.implicits.size() == in.offsets.implicits.size());
+        CHECK(out.get("CHANNEL") == in.get("CHANNEL"));
+        CHECK(out.get("FRAME") == in.get("FRAME"));
+        CHECK(out.fdata() == in.fdata());
+    }
+
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+}
+
+TEST_CASE("Repacking a channel subset and index range", "[repack]") {
+    const auto input = std::string("repack-subset-input.dlis");
+    const auto output = std::string("repack-subset-output.dlis");
+    write_input(input);
+
+    dl::repack_options opts;
+    opts.channels = { "COUNT" };
+    opts.index_range = true;
+    opts.top = 1002.0;
+    opts.bottom = 1001.0;
+    repack(input, output, opts);
+
+    {
+        logical_file lf(output);
+        CHECK(lf.offsets.broken.empty());
+
+        const auto channels = lf.get("CHANNEL");
+        REQUIRE(channels.size() == 2);
+        CHECK(channels[0].object_name == name("INDEX"));
+        CHECK(channels[1].object_name == name("COUNT"));
+
+        const auto frame = lf.get("FRAME");
+        REQUIRE(frame.size() == 1);
+        const auto kept = std::vector< dl::obname >{
+            name("INDEX"), name("COUNT")
+        };
+        CHECK(frame[0].at("CHANNELS").value == dl::value_vector{ kept });
+        CHECK(frame[0].at("INDEX-MIN").value ==
+              dl::value_vector{ std::vector< dl::fdoubl >{ 1001.0 } });
+        CHECK(frame[0].at("INDEX-MAX").value ==
+              dl::value_vector{ std::vector< dl::fdoubl >{ 1002.0 } });
+
+        /*
+         * Frames 3, 4 and 5 (index 1001.0, 1001.5, 1002.0) are kept, and
+         * renumbered from 1. The last two records have no frames in the
+         * range, and are dropped entirely.
+         */
+        CHECK(lf.offsets.implicits.size() == 2);
+
+        struct {
+            std::int32_t frameno;
+            double index;
+            std::int32_t count;
+        } row;
+        const char* fmt = "iFl";
+        int src, dst;
+
+        std::size_t n = 0;
+        for (const auto tell : lf.offsets.implicits) {
+            const auto rec = dl::extract(lf.file, tell, lf.handler);
+            const auto* ptr = rec.data.data();
+            const auto* end = ptr + rec.data.size();
+            std::int32_t origin;
+            std::uint8_t copy;
+            ptr = dlis_obname(ptr, &origin, &copy, nullptr, nullptr);
+
+            while (ptr < end) {
+                REQUIRE(dlis_packflen(fmt, ptr, &src, &dst) == DLIS_OK);
+                char buffer[16];
+                dlis_packf(fmt, ptr, buffer);
+                ptr += src;
+
+                std::memcpy(&row.frameno, buffer, 4);
+                std::memcpy(&row.index,   buffer + 4, 8);
+                std::memcpy(&row.count,   buffer + 12, 4);
+
+                CHECK(row.frameno == std::int32_t(n + 1));
+                CHECK(row.index == 1001.0 + 0.5 * n);
+                CHECK(row.count == std::int32_t(n + 2) * 10);
+                ++n;
+            }
+        }
+        CHECK(n == 3);
+    }
+
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+}
+
+TEST_CASE("Frames without selected channels are dropped", "[repack]") {
+    const auto input = std::string("repack-drop-input.dlis");
+    const auto output = std::string("repack-drop-output.dlis");
+    write_input(input);
+
+    dl::repack_options opts;
+    opts.channels = { "NOT-IN-FILE" };
+    repack(input, output, opts);
+
+    {
+        logical_file lf(output);
+        CHECK(lf.offsets.broken.empty());
+        CHECK(lf.offsets.explicits.size() == 1);
+        CHECK(lf.offsets.implicits.empty());
+        CHECK(lf.get("CHANNEL").empty());
+        CHECK(lf.get("FRAME").empty());
+    }
+
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+}
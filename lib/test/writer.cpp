@@ -0,0 +1,279 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <dlisio/dlisio.h>
+#include <dlisio/types.h>
+#include <dlisio/ext/io.hpp>
+#include <dlisio/ext/types.hpp>
+#include <dlisio/ext/writer.hpp>
+
+namespace {
+
+struct fail_handler : public dl::error_handler {
+    void log(const dl::error_severity&, const std::string& context,
+             const std::string& problem, const std::string&,
+             const std::string&)
+    const noexcept (false) override {
+        FAIL(context + ": " + problem);
+    }
+};
+
+template < typename T >
+dl::object_attribute attribute(const std::string& label, std::vector< T > xs) {
+    dl::object_attribute attr;
+    attr.label = dl::ident{ label };
+    attr.count = dl::uvari{ std::int32_t(xs.size()) };
+    attr.reprc = dl::typeinfo< T >::reprc;
+    attr.value = std::move(xs);
+    return attr;
+}
+
+dl::obname name(const std::string& id) {
+    return dl::obname{ dl::origin{ 10 }, dl::ushort{ 2 }, dl::ident{ id } };
+}
+
+/*
+ * Open the (single) logical file written by dl::writer, i.e. a file with a
+ * SUL and no tapeimage
+ */
+struct logical_file {
+    explicit logical_file(const std::string& path)
+        : file(dl::open(path, 0))
+    {
+        const auto sul = dl::findsul(this->file);
+        const auto vrl = dl::findvrl(this->file, sul + DLIS_SUL_SIZE);
+        this->file.seek(vrl);
+        this->file = dl::open_rp66(this->file);
+        this->offsets = dl::findoffsets(this->file, this->handler);
+    }
+
+    ~logical_file() {
+        this->file.close();
+    }
+
+    fail_handler handler;
+    dl::stream file;
+    dl::stream_offsets offsets;
+};
+
+}
+
+TEST_CASE("Object sets round-trip through encode_set", "[writer]") {
+    dl::basic_object ch1;
+    ch1.object_name = name("CH1");
+    ch1.attributes = {
+        attribute("LONG-NAME", std::vector< dl::ascii >{ dl::ascii{"depth"} }),
+        attribute("DIMENSION", std::vector< dl::uvari >{ dl::uvari{ 4 },
+                                                        dl::uvari{ 3 } }),
+        attribute("REPRESENTATION-CODE", std::vector< dl::ushort >{ 2 }),
+    };
+    ch1.attributes[0].units = dl::units{ "m" };
+
+    dl::basic_object ch2;
+    ch2.object_name = name("CH2");
+    ch2.attributes = {
+        attribute("LONG-NAME", std::vector< dl::ident >{ dl::ident{"time"} }),
+        attribute("REPRESENTATION-CODE", std::vector< dl::ushort >{ 7 }),
+        attribute("SOURCE", std::vector< dl::objref >{
+            dl::objref{ dl::ident{ "TOOL" }, name("SONIC") }
+        }),
+        attribute("RANGE", std::vector< dl::fsing1 >{ { 1.5f, 0.5f } }),
+        attribute("CREATED", std::vector< dl::dtime >{
+            dl::dtime{ 2020, 0, 3, 14, 9, 26, 53, 589 }
+        }),
+    };
+
+    const auto objects = dl::object_vector{ ch1, ch2 };
+    const auto body = dl::encode_set(dl::ident{ "CHANNEL" },
+                                     dl::ident{ "main" },
+                                     objects);
+
+    dl::record rec;
+    rec.type = DLIS_CHANNL;
+    rec.attributes = DLIS_SEGATTR_EXFMTLR;
+    rec.consistent = true;
+    rec.data = body;
+
+    auto set = dl::object_set(rec);
+    CHECK(set.type == dl::ident{ "CHANNEL" });
+    CHECK(set.name == dl::ident{ "main" });
+
+    const auto& parsed = set.objects();
+    CHECK(set.log.empty());
+    REQUIRE(parsed.size() == 2);
+    CHECK(parsed[0] == ch1);
+    CHECK(parsed[1] == ch2);
+}
+
+TEST_CASE("Set type codes are looked up from Appendix A", "[writer]") {
+    CHECK(dl::eflr_type(dl::ident{ "FILE-HEADER" }) == DLIS_FHLR);
+    CHECK(dl::eflr_type(dl::ident{ "FRAME" })       == DLIS_FRAME);
+    CHECK(dl::eflr_type(dl::ident{ "PATH" })        == DLIS_FRAME);
+    CHECK(dl::eflr_type(dl::ident{ "TOOL" })        == DLIS_STATIC);
+    CHECK(dl::eflr_type(dl::ident{ "VENDOR-SET" })  == DLIS_STATIC);
+}
+
+TEST_CASE("Writer rejects invalid visible record lengths", "[writer]") {
+    CHECK_THROWS_AS(dl::writer("invalid.dlis", 18), std::invalid_argument);
+    CHECK_THROWS_AS(dl::writer("invalid.dlis", 1001), std::invalid_argument);
+    CHECK_THROWS_AS(dl::writer("invalid.dlis", 20000), std::invalid_argument);
+    CHECK_THROWS_AS(dl::writer("invalid.dlis", 1000, 10),
+                    std::invalid_argument);
+}
+
+TEST_CASE("Writer splits records into segments", "[writer]") {
+    const auto path = std::string("writer-segments.dlis");
+
+    std::vector< char > small(5, 'x');
+    std::vector< char > large(1001);
+    for (std::size_t i = 0; i < large.size(); ++i)
+        large[i] = char(i % 251);
+
+    {
+        dl::writer out(path, 64, 32);
+        out.storage_label(1, "writer test");
+        out.logical_file();
+        out.write(DLIS_FHLR, true, small.data(), small.size());
+        out.write(DLIS_CHANNL, true, large.data(), large.size());
+        out.write(0, false, small.data(), small.size());
+        out.close();
+    }
+
+    {
+        logical_file lf(path);
+        CHECK(lf.offsets.broken.empty());
+        REQUIRE(lf.offsets.explicits.size() == 2);
+        REQUIRE(lf.offsets.implicits.size() == 1);
+
+        const auto header = dl::extract(lf.file, lf.offsets.explicits[0],
+                                        lf.handler);
+        CHECK(header.type == DLIS_FHLR);
+        CHECK(header.isexplicit());
+        CHECK(header.data == small);
+
+        const auto channel = dl::extract(lf.file, lf.offsets.explicits[1],
+                                         lf.handler);
+        CHECK(channel.type == DLIS_CHANNL);
+        CHECK(channel.consistent);
+        CHECK(channel.data == large);
+
+        const auto fdata = dl::extract(lf.file, lf.offsets.implicits[0],
+                                       lf.handler);
+        CHECK(fdata.type == 0);
+        CHECK(not fdata.isexplicit());
+        CHECK(fdata.data == small);
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Writer packs frames from columns", "[writer]") {
+    const auto path = std::string("writer-frames.dlis");
+    const auto frame = name("MAIN");
+    const std::size_t frames = 10;
+
+    std::vector< double > index;
+    std::vector< float > pairs;
+    std::vector< std::int32_t > counts;
+    std::vector< int > times;
+    for (std::size_t i = 0; i < frames; ++i) {
+        index.push_back(1000.0 + 0.5 * i);
+        pairs.push_back(float(i));
+        pairs.push_back(-float(i));
+        counts.push_back(std::int32_t(i) - 5);
+        const int dt[] = { 120, 0, 3, 14, 9, 26, int(i), 589 };
+        times.insert(times.end(), dt, dt + 8);
+    }
+
+    const std::vector< dl::column > columns = {
+        { dl::representation_code::fdoubl, 1, index.data()  },
+        { dl::representation_code::fsingl, 2, pairs.data()  },
+        { dl::representation_code::slong,  1, counts.data() },
+        { dl::representation_code::dtime,  1, times.data()  },
+    };
+
+    {
+        dl::writer out(path, 128);
+        out.storage_label(1, "writer test");
+        out.logical_file();
+        out.write_frames(frame, columns, 1, frames, 3);
+        out.close();
+    }
+
+    {
+        logical_file lf(path);
+        CHECK(lf.offsets.broken.empty());
+        CHECK(lf.offsets.implicits.size() == 4);
+
+        const auto fdata = dl::findfdata(lf.file,
+                                         lf.offsets.implicits,
+                                         lf.handler);
+        const auto key = frame.fingerprint("FRAME");
+        REQUIRE(fdata.count(key) == 1);
+        REQUIRE(fdata.at(key).size() == 4);
+
+        struct {
+            std::int32_t frameno;
+            double index;
+            float pair[2];
+            std::int32_t count;
+            int time[8];
+        } row;
+        const char* fmt = "iFfflj";
+        int src, dst;
+
+        std::size_t n = 0;
+        for (const auto tell : fdata.at(key)) {
+            const auto rec = dl::extract(lf.file, tell, lf.handler);
+            const auto* ptr = rec.data.data();
+            const auto* end = ptr + rec.data.size();
+            std::int32_t origin;
+            std::uint8_t copy;
+            ptr = dlis_obname(ptr, &origin, &copy, nullptr, nullptr);
+
+            while (ptr < end) {
+                REQUIRE(dlis_packflen(fmt, ptr, &src, &dst) == DLIS_OK);
+                REQUIRE(dst <= int(sizeof(row)));
+                char buffer[sizeof(row)];
+                dlis_packf(fmt, ptr, buffer);
+                ptr += src;
+
+                std::memcpy(&row.frameno, buffer, 4);
+                std::memcpy(&row.index,   buffer + 4, 8);
+                std::memcpy(&row.pair,    buffer + 12, 8);
+                std::memcpy(&row.count,   buffer + 20, 4);
+                std::memcpy(&row.time,    buffer + 24, 32);
+
+                CHECK(row.frameno == std::int32_t(n + 1));
+                CHECK(row.index == index[n]);
+                CHECK(row.pair[0] == pairs[2*n]);
+                CHECK(row.pair[1] == pairs[2*n + 1]);
+                CHECK(row.count == counts[n]);
+                CHECK(std::memcmp(row.time, times.data() + 8*n, 32) == 0);
+                ++n;
+            }
+        }
+        CHECK(n == frames);
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Writer refuses to pack variable-length columns", "[writer]") {
+    const auto path = std::string("writer-varsize.dlis");
+    const std::vector< dl::column > columns = {
+        { dl::representation_code::ident, 1, nullptr },
+    };
+
+    dl::writer out(path);
+    out.logical_file();
+    CHECK_THROWS_AS(out.write_frames(name("MAIN"), columns, 1, 1),
+                    dl::not_implemented);
+    out.close();
+    std::remove(path.c_str());
+}
@@ -0,0 +1,189 @@
+/*
+ * dlisio-repack - copy a subset of channels and/or frames to a new file
+ *
+ * Delivering a few curves, or a depth interval, from a large file usually
+ * means loading the curves as floats and writing them back out. dlisio-repack
+ * instead copies the frame data as raw bytes (see dl::repack), so the output
+ * is bit-for-bit identical to the input for the samples that are kept, and
+ * the throughput is bound by IO rather than decoding.
+ *
+ * All logical files in the input are repacked with the same options.
+ */
+#include <cerrno>
+#include <ciso646>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <dlisio/dlisio.h>
+#include <dlisio/types.h>
+
+#include <dlisio/ext/io.hpp>
+#include <dlisio/ext/repack.hpp>
+#include <dlisio/ext/types.hpp>
+#include <dlisio/ext/writer.hpp>
+
+namespace {
+
+const char* usage =
+"usage: dlisio-repack [options] INPUT OUTPUT\n"
+"\n"
+"options:\n"
+"  --channels LIST        comma-separated channel mnemonics to keep (default:\n"
+"                         all). Index channels are always kept\n"
+"  --index-range TOP:BOT  only keep frames with index in [TOP, BOT]\n"
+"  --vr-size N            visible record length (default: 8192)\n";
+
+struct options {
+    std::vector< std::string > inputs;
+    dl::repack_options repack;
+    int vr_size = 8192;
+};
+
+std::vector< std::string > split(const std::string& s, char sep) {
+    std::vector< std::string > xs;
+    std::string::size_type begin = 0;
+    while (true) {
+        const auto end = s.find(sep, begin);
+        xs.push_back(s.substr(begin, end - begin));
+        if (end == std::string::npos) return xs;
+        begin = end + 1;
+    }
+}
+
+double number(const std::string& key, const std::string& value) {
+    char* end;
+    const auto x = std::strtod(value.c_str(), &end);
+    if (value.empty() or *end != '\0')
+        throw std::invalid_argument(key + ": expected number, got " + value);
+    return x;
+}
+
+options parse_args(int argc, char** argv) noexcept (false) {
+    options opts;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-h" or arg == "--help") {
+            std::fputs(usage, stdout);
+            std::exit(EXIT_SUCCESS);
+        }
+
+        if (arg.compare(0, 2, "--") != 0) {
+            opts.inputs.push_back(arg);
+            continue;
+        }
+
+        if (i + 1 == argc)
+            throw std::invalid_argument(arg + ": missing value");
+        const std::string value = argv[++i];
+
+        if (arg == "--channels") {
+            opts.repack.channels = split(value, ',');
+        }
+        else if (arg == "--index-range") {
+            const auto range = split(value, ':');
+            if (range.size() != 2)
+                throw std::invalid_argument(arg + ": expected TOP:BOTTOM");
+            opts.repack.index_range = true;
+            opts.repack.top    = number(arg, range[0]);
+            opts.repack.bottom = number(arg, range[1]);
+        }
+        else if (arg == "--vr-size") {
+            opts.vr_size = int(number(arg, value));
+        }
+        else throw std::invalid_argument("unknown option " + arg);
+    }
+
+    if (opts.inputs.size() != 2)
+        throw std::invalid_argument("expected INPUT and OUTPUT");
+
+    return opts;
+}
+
+struct stderr_handler : public dl::error_handler {
+    void log(const dl::error_severity& level, const std::string& context,
+             const std::string& problem, const std::string&,
+             const std::string& action)
+    const noexcept (false) override {
+        if (level < dl::error_severity::MINOR) return;
+        std::fprintf(stderr, "dlisio-repack: %s: %s (%s)\n",
+                     context.c_str(), problem.c_str(), action.c_str());
+    }
+};
+
+/*
+ * Walk the logical files the same way dlisio.load does, and repack every one
+ * of them
+ */
+int repack(const options& opts) noexcept (false) {
+    const auto& input = opts.inputs[0];
+    stderr_handler handler;
+
+    auto file = dl::open(input, 0);
+    long long vrl = 0;
+    try {
+        vrl = dl::findsul(file) + DLIS_SUL_SIZE;
+    } catch (const std::exception&) {}
+    const bool tapeimage = dl::hastapemark(file);
+    vrl = dl::findvrl(file, vrl);
+
+    dl::writer out(opts.inputs[1], opts.vr_size);
+    out.storage_label(1, "dlisio-repack");
+
+    int logical_files = 0;
+    while (true) {
+        /* the tapeimage header precedes the visible record */
+        file.seek(tapeimage ? vrl - 12 : vrl);
+        if (tapeimage) file = dl::open_tapeimage(file);
+        file = dl::open_rp66(file);
+
+        const auto offsets = dl::findoffsets(file, handler);
+        auto hint = file.absolute_tell() - DLIS_VRL_SIZE;
+        if (tapeimage) hint -= 12;
+
+        out.logical_file();
+        dl::repack(file, offsets, opts.repack, out, handler);
+        ++logical_files;
+
+        if (not offsets.broken.empty()) break;
+
+        file.close();
+        file = dl::open(input, 0);
+        try {
+            vrl = dl::findvrl(file, hint);
+        } catch (const std::runtime_error&) {
+            if (file.eof()) break;
+            throw;
+        }
+    }
+
+    file.close();
+    out.close();
+    return logical_files;
+}
+
+}
+
+int main(int argc, char** argv) {
+    options opts;
+    try {
+        opts = parse_args(argc, argv);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "dlisio-repack: %s\n\n%s", e.what(), usage);
+        return EXIT_FAILURE;
+    }
+
+    try {
+        const auto n = repack(opts);
+        std::fprintf(stderr, "dlisio-repack: %d logical file(s) written to %s\n",
+                     n, opts.inputs[1].c_str());
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "dlisio-repack: %s\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
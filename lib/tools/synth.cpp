@@ -0,0 +1,392 @@
+/*
+ * dlisio-synth - generate synthetic DLIS files of arbitrary size
+ *
+ * Real-world files large enough to be interesting for benchmarking are rarely
+ * shareable, and the files in the test suite are tiny. This program writes
+ * well-formed RP66 v1 files with a configurable layout, using the same
+ * encoders (dlis_*o) that the test suite relies on, so that the whole loading
+ * pipeline can be measured on files of any size.
+ *
+ * The generated file has one FRAME per logical file, with an index channel
+ * (INDEX, FDOUBL, increasing depth) followed by --channels data channels.
+ * The representation codes and dimensions are assigned round-robin from
+ * --reprc and --dimensions.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <ciso646>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <dlisio/dlisio.h>
+#include <dlisio/types.h>
+
+#include <dlisio/ext/types.hpp>
+#include <dlisio/ext/writer.hpp>
+
+namespace {
+
+const char* usage =
+"usage: dlisio-synth [options] OUTPUT\n"
+"\n"
+"options:\n"
+"  --logical-files N      number of logical files (default: 1)\n"
+"  --frames N             frames per logical file (default: 1000)\n"
+"  --frames-per-record N  frames per FDATA record (default: 1)\n"
+"  --channels N           data channels, excluding the index (default: 8)\n"
+"  --reprc LIST           comma-separated representation codes, assigned\n"
+"                         round-robin to channels (default: fdoubl)\n"
+"  --dimensions LIST      comma-separated sample dimensions, e.g. 1,4x3,\n"
+"                         assigned round-robin to channels (default: 1)\n"
+"  --vr-size N            visible record length (default: 8192)\n"
+"  --segment-size N       max logical record segment length (default: no\n"
+"                         limit other than the visible record)\n";
+
+struct options {
+    int logical_files     = 1;
+    int frames            = 1000;
+    int frames_per_record = 1;
+    int channels          = 8;
+    std::vector< int > reprcs = { DLIS_FDOUBL };
+    std::vector< std::vector< int > > dimensions = { { 1 } };
+    int vr_size           = 8192;
+    int segment_size      = 0;
+    std::string output;
+};
+
+const std::map< std::string, int > reprc_names = {
+    { "fsingl", DLIS_FSINGL },
+    { "fsing1", DLIS_FSING1 },
+    { "fsing2", DLIS_FSING2 },
+    { "isingl", DLIS_ISINGL },
+    { "vsingl", DLIS_VSINGL },
+    { "fdoubl", DLIS_FDOUBL },
+    { "fdoub1", DLIS_FDOUB1 },
+    { "fdoub2", DLIS_FDOUB2 },
+    { "csingl", DLIS_CSINGL },
+    { "cdoubl", DLIS_CDOUBL },
+    { "sshort", DLIS_SSHORT },
+    { "snorm",  DLIS_SNORM  },
+    { "slong",  DLIS_SLONG  },
+    { "ushort", DLIS_USHORT },
+    { "unorm",  DLIS_UNORM  },
+    { "ulong",  DLIS_ULONG  },
+    { "uvari",  DLIS_UVARI  },
+    { "ident",  DLIS_IDENT  },
+    { "ascii",  DLIS_ASCII  },
+    { "dtime",  DLIS_DTIME  },
+    { "status", DLIS_STATUS },
+    { "units",  DLIS_UNITS  },
+};
+
+std::vector< std::string > split(const std::string& s, char sep) {
+    std::vector< std::string > xs;
+    std::string::size_type begin = 0;
+    while (true) {
+        const auto end = s.find(sep, begin);
+        xs.push_back(s.substr(begin, end - begin));
+        if (end == std::string::npos) return xs;
+        begin = end + 1;
+    }
+}
+
+int positive(const std::string& key, const std::string& value) {
+    char* end;
+    const auto x = std::strtol(value.c_str(), &end, 10);
+    if (*end != '\0' or x <= 0 or x > INT32_MAX)
+        throw std::invalid_argument(key + ": expected positive integer, got "
+                                    + value);
+    return int(x);
+}
+
+options parse_args(int argc, char** argv) noexcept (false) {
+    options opts;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-h" or arg == "--help") {
+            std::fputs(usage, stdout);
+            std::exit(EXIT_SUCCESS);
+        }
+
+        if (arg.compare(0, 2, "--") != 0) {
+            if (not opts.output.empty())
+                throw std::invalid_argument("multiple output files given");
+            opts.output = arg;
+            continue;
+        }
+
+        if (i + 1 == argc)
+            throw std::invalid_argument(arg + ": missing value");
+        const std::string value = argv[++i];
+
+        if      (arg == "--logical-files")     opts.logical_files = positive(arg, value);
+        else if (arg == "--frames")            opts.frames = positive(arg, value);
+        else if (arg == "--frames-per-record") opts.frames_per_record = positive(arg, value);
+        else if (arg == "--channels")          opts.channels = positive(arg, value);
+        else if (arg == "--vr-size")           opts.vr_size = positive(arg, value);
+        else if (arg == "--segment-size")      opts.segment_size = positive(arg, value);
+        else if (arg == "--reprc") {
+            opts.reprcs.clear();
+            for (const auto& name : split(value, ',')) {
+                const auto itr = reprc_names.find(name);
+                if (itr == reprc_names.end())
+                    throw std::invalid_argument("--reprc: unsupported "
+                                                "representation code " + name);
+                opts.reprcs.push_back(itr->second);
+            }
+        }
+        else if (arg == "--dimensions") {
+            opts.dimensions.clear();
+            for (const auto& dim : split(value, ',')) {
+                std::vector< int > d;
+                for (const auto& x : split(dim, 'x'))
+                    d.push_back(positive(arg, x));
+                opts.dimensions.push_back(d);
+            }
+        }
+        else throw std::invalid_argument("unknown option " + arg);
+    }
+
+    if (opts.output.empty())
+        throw std::invalid_argument("no output file given");
+
+    return opts;
+}
+
+template < typename T >
+dl::object_attribute attribute(const std::string& label, std::vector< T > xs) {
+    dl::object_attribute attr;
+    attr.label = dl::ident{ label };
+    attr.count = dl::uvari{ std::int32_t(xs.size()) };
+    attr.reprc = dl::typeinfo< T >::reprc;
+    attr.value = std::move(xs);
+    return attr;
+}
+
+dl::basic_object object(int origin,
+                        const std::string& id,
+                        std::vector< dl::object_attribute > attributes) {
+    dl::basic_object obj;
+    obj.object_name = dl::obname{ dl::origin{ origin },
+                                  dl::ushort{ 0 },
+                                  dl::ident{ id } };
+    obj.attributes = std::move(attributes);
+    return obj;
+}
+
+struct channel {
+    std::string name;
+    int reprc;
+    std::vector< int > dimension;
+    int samples;
+};
+
+std::vector< channel > make_channels(const options& opts) {
+    std::vector< channel > channels;
+    channels.push_back({ "INDEX", DLIS_FDOUBL, { 1 }, 1 });
+
+    for (int i = 0; i < opts.channels; ++i) {
+        channel ch;
+        ch.name = "CH" + std::to_string(i);
+        ch.reprc = opts.reprcs[i % opts.reprcs.size()];
+        ch.dimension = opts.dimensions[i % opts.dimensions.size()];
+        ch.samples = 1;
+        for (auto x : ch.dimension) ch.samples *= x;
+        channels.push_back(ch);
+    }
+
+    return channels;
+}
+
+double depth(int frame) {
+    return 1000.0 + 0.5 * frame;
+}
+
+/*
+ * Write a single sample of a channel. The values are deterministic and cheap
+ * to compute, and are chosen to stay in range for every representation code.
+ */
+char* sample(char* dst, int reprc, int frame, int channel, int i) {
+    const auto x = double(frame) + 0.25 * channel + 0.001 * i;
+    const auto n = frame + channel + i;
+
+    void* p = dst;
+    switch (reprc) {
+        case DLIS_FSINGL: p = dlis_fsinglo(p, float(x)); break;
+        case DLIS_FSING1: p = dlis_fsing1o(p, float(x), 0.5f); break;
+        case DLIS_FSING2: p = dlis_fsing2o(p, float(x), 0.5f, 0.25f); break;
+        case DLIS_ISINGL: p = dlis_isinglo(p, float(x)); break;
+        case DLIS_VSINGL: p = dlis_vsinglo(p, float(x)); break;
+        case DLIS_FDOUBL: p = dlis_fdoublo(p, x); break;
+        case DLIS_FDOUB1: p = dlis_fdoub1o(p, x, 0.5); break;
+        case DLIS_FDOUB2: p = dlis_fdoub2o(p, x, 0.5, 0.25); break;
+        case DLIS_CSINGL: p = dlis_csinglo(p, float(x), float(-x)); break;
+        case DLIS_CDOUBL: p = dlis_cdoublo(p, x, -x); break;
+        case DLIS_SSHORT: p = dlis_sshorto(p, std::int8_t(n % 128)); break;
+        case DLIS_SNORM:  p = dlis_snormo(p, std::int16_t(n % 32768)); break;
+        case DLIS_SLONG:  p = dlis_slongo(p, -n); break;
+        case DLIS_USHORT: p = dlis_ushorto(p, std::uint8_t(n % 256)); break;
+        case DLIS_UNORM:  p = dlis_unormo(p, std::uint16_t(n % 65536)); break;
+        case DLIS_ULONG:  p = dlis_ulongo(p, std::uint32_t(n)); break;
+        case DLIS_UVARI:  p = dlis_uvario(p, n % 0x3FFFFFFF, 0); break;
+        case DLIS_STATUS: p = dlis_statuso(p, std::uint8_t(n % 2)); break;
+
+        case DLIS_DTIME: {
+            const auto ms = n % 1000;
+            const auto s  = n / 1000 % 60;
+            const auto mn = n / 60000 % 60;
+            const auto h  = n / 3600000 % 24;
+            p = dlis_dtimeo(p, dlis_yearo(2000), 0, 1, 1, h, mn, s, ms);
+            break;
+        }
+
+        case DLIS_IDENT:
+        case DLIS_UNITS:
+        case DLIS_ASCII: {
+            const auto s = std::to_string(n);
+            if (reprc == DLIS_ASCII)
+                p = dlis_asciio(p, std::int32_t(s.size()), s.data(), 0);
+            else
+                p = dlis_idento(p, std::uint8_t(s.size()), s.data());
+            break;
+        }
+
+        default:
+            throw std::invalid_argument("unsupported reprc "
+                                        + std::to_string(reprc));
+    }
+
+    return static_cast< char* >(p);
+}
+
+void write_logical_file(dl::writer& out, const options& opts, int lf) {
+    const int origin = lf + 1;
+    const auto channels = make_channels(opts);
+    out.logical_file();
+
+    auto seqnum = std::to_string(lf + 1);
+    seqnum.insert(0, 10 - seqnum.size(), ' ');
+    std::string id = "dlisio-synth";
+    id.resize(65, ' ');
+
+    out.write_set(dl::ident{ "FILE-HEADER" }, dl::ident{}, {
+        object(origin, "0", {
+            attribute("SEQUENCE-NUMBER", std::vector< dl::ascii >{
+                dl::ascii{ seqnum }
+            }),
+            attribute("ID", std::vector< dl::ascii >{ dl::ascii{ id } }),
+        }),
+    });
+
+    out.write_set(dl::ident{ "ORIGIN" }, dl::ident{}, {
+        object(origin, "DEFINING_ORIGIN", {
+            attribute("FILE-ID", std::vector< dl::ascii >{
+                dl::ascii{ "synthetic" }
+            }),
+            attribute("FILE-SET-NAME", std::vector< dl::ident >{
+                dl::ident{ "SYNTH" }
+            }),
+            attribute("FILE-NUMBER", std::vector< dl::ushort >{
+                dl::ushort(lf + 1)
+            }),
+        }),
+    });
+
+    dl::object_vector chobjs;
+    std::vector< dl::obname > names;
+    for (const auto& ch : channels) {
+        std::vector< dl::uvari > dimension;
+        for (auto x : ch.dimension) dimension.push_back(dl::uvari{ x });
+
+        chobjs.push_back(object(origin, ch.name, {
+            attribute("LONG-NAME", std::vector< dl::ascii >{
+                dl::ascii{ "synthetic " + ch.name }
+            }),
+            attribute("REPRESENTATION-CODE", std::vector< dl::ushort >{
+                dl::ushort(ch.reprc)
+            }),
+            attribute("UNITS", std::vector< dl::units >{
+                dl::units{ ch.name == "INDEX" ? "m" : "" }
+            }),
+            attribute("DIMENSION", dimension),
+        }));
+        names.push_back(chobjs.back().object_name);
+    }
+    out.write_set(dl::ident{ "CHANNEL" }, dl::ident{}, chobjs);
+
+    out.write_set(dl::ident{ "FRAME" }, dl::ident{}, {
+        object(origin, "MAIN", {
+            attribute("CHANNELS", names),
+            attribute("INDEX-TYPE", std::vector< dl::ident >{
+                dl::ident{ "BOREHOLE-DEPTH" }
+            }),
+            attribute("DIRECTION", std::vector< dl::ident >{
+                dl::ident{ "INCREASING" }
+            }),
+            attribute("SPACING", std::vector< dl::fdoubl >{
+                depth(1) - depth(0)
+            }),
+            attribute("INDEX-MIN", std::vector< dl::fdoubl >{ depth(0) }),
+            attribute("INDEX-MAX", std::vector< dl::fdoubl >{
+                depth(opts.frames - 1)
+            }),
+        }),
+    });
+
+    /*
+     * Data channels are not packed with writer::write_frames, since the
+     * synthetic files also cover variable-length representation codes.
+     * Every sample is at most 255 + 1 bytes (ident), and the frame number at
+     * most 4.
+     */
+    std::size_t framesize = 4;
+    for (const auto& ch : channels)
+        framesize += std::size_t(ch.samples) * 256;
+
+    std::vector< char > body;
+    int frame = 0;
+    while (frame < opts.frames) {
+        body.resize(4 + 1 + 1 + 4);
+        dlis_obnameo(body.data(), origin, 0, 4, "MAIN");
+
+        const auto last = std::min(opts.frames, frame + opts.frames_per_record);
+        for (; frame < last; ++frame) {
+            const auto size = body.size();
+            body.resize(size + framesize);
+            auto* p = body.data() + size;
+            p = static_cast< char* >(dlis_uvario(p, frame + 1, 0));
+            p = static_cast< char* >(dlis_fdoublo(p, depth(frame)));
+            for (std::size_t c = 1; c < channels.size(); ++c) {
+                for (int i = 0; i < channels[c].samples; ++i)
+                    p = sample(p, channels[c].reprc, frame, int(c), i);
+            }
+            body.resize(p - body.data());
+        }
+
+        out.write(0, false, body.data(), body.size());
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    try {
+        const auto opts = parse_args(argc, argv);
+        dl::writer out(opts.output, opts.vr_size, opts.segment_size);
+        out.storage_label(1, "dlisio synthetic file");
+        for (int lf = 0; lf < opts.logical_files; ++lf)
+            write_logical_file(out, opts, lf);
+        out.close();
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "dlisio-synth: %s\n\n%s", e.what(), usage);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""End-to-end benchmark of dlisio.load and curve reading
+
+Loads a file with dlisio.load(), touches all frames and channels, and reads
+the curves of every frame. The time spent is broken down into three stages:
+
+    indexing  - locating the storage label, visible records, logical record
+                offsets and FDATA (findsul, findvrl, findoffsets, resyncvrl,
+                indexfdata)
+    metadata  - reading and parsing the explicit records (extract,
+                parse_objects), including the lazy parsing of frames and
+                channels
+    curves    - decoding frame data (read_fdata, read_fdata_many), and finding
+                the records of an index range (indexvalues)
+
+Use the dlisio-synth program to generate input files of arbitrary size and
+layout, either up-front or through --synth:
+
+    python benchmarks/load.py large.dlis
+    python benchmarks/load.py --synth ../build/lib/dlisio-synth large.dlis \\
+        -- --frames 1000000 --channels 20 --reprc fsingl,fdoubl,slong
+
+The stage timings are collected by wrapping the functions in dlisio.core, so
+the benchmark measures exactly what dlisio.load and Frame.curves do.
+"""
+
+import argparse
+import collections
+import contextlib
+import os
+import subprocess
+import sys
+import time
+
+import dlisio
+from dlisio import core
+
+stages = collections.OrderedDict([
+    ('indexing', ['findsul', 'findvrl', 'hastapemark', 'findoffsets',
+                  'findoffsets_vr', 'resyncvrl', 'findfdata', 'indexfdata']),
+    ('metadata', ['extract', 'parse_objects']),
+    ('curves',   ['read_fdata', 'read_fdata_many', 'indexvalues']),
+])
+
+@contextlib.contextmanager
+def instrumented(timings):
+    """Accumulate the time spent in dlisio.core functions per stage"""
+    originals = {}
+
+    def timed(stage, fn):
+        def wrapper(*args, **kwargs):
+            start = time.perf_counter()
+            try:
+                return fn(*args, **kwargs)
+            finally:
+                timings[stage] += time.perf_counter() - start
+        return wrapper
+
+    for stage, names in stages.items():
+        for name in names:
+            originals[name] = getattr(core, name)
+            setattr(core, name, timed(stage, originals[name]))
+
+    try:
+        yield
+    finally:
+        for name, fn in originals.items():
+            setattr(core, name, fn)
+
+def run(path):
+    timings = collections.OrderedDict((stage, 0.0) for stage in stages)
+    frames = 0
+    rows = 0
+
+    start = time.perf_counter()
+    with instrumented(timings):
+        with dlisio.load(path) as files:
+            loaded = time.perf_counter()
+            for f in files:
+                # objects are parsed lazily, so accessing frames and channels
+                # is a part of the metadata cost
+                lazy = time.perf_counter()
+                _ = f.channels
+                fs = f.frames
+                timings['metadata'] += time.perf_counter() - lazy
+
+                for frame in fs:
+                    rows += len(frame.curves())
+                    frames += 1
+    end = time.perf_counter()
+
+    return {
+        'load'    : loaded - start,
+        'total'   : end - start,
+        'frames'  : frames,
+        'rows'    : rows,
+        'timings' : timings,
+    }
+
+def report(path, results):
+    size = os.path.getsize(path)
+    best = min(results, key = lambda r: r['total'])
+    mb = size / (1024 * 1024)
+
+    print('file:     {} ({:.1f} MB)'.format(path, mb))
+    print('frames:   {} ({} rows)'.format(best['frames'], best['rows']))
+    print('runs:     {} (reporting the fastest)'.format(len(results)))
+    print('')
+    for stage, t in best['timings'].items():
+        print('{:<10}{:>10.3f} s'.format(stage, t))
+    print('{:<10}{:>10.3f} s'.format('load()', best['load']))
+    print('{:<10}{:>10.3f} s  ({:.1f} MB/s)'.format('total',
+                                                   best['total'],
+                                                   mb / best['total']))
+
+def main(argv):
+    parser = argparse.ArgumentParser(
+        description = 'Benchmark dlisio.load and curve reading',
+    )
+    parser.add_argument('path', help = 'DLIS file to load')
+    parser.add_argument('--repeat', type = int, default = 3,
+        help = 'number of runs (default: 3)')
+    parser.add_argument('--synth', metavar = 'PROGRAM',
+        help = 'generate PATH with dlisio-synth first, passing arguments '
+               'after --')
+    parser.add_argument('synthargs', nargs = argparse.REMAINDER,
+        help = argparse.SUPPRESS)
+    args = parser.parse_args(argv)
+
+    if args.synth:
+        synthargs = [x for x in args.synthargs if x != '--']
+        subprocess.check_call([args.synth] + synthargs + [args.path])
+
+    results = [run(args.path) for _ in range(args.repeat)]
+    report(args.path, results)
+
+if __name__ == '__main__':
+    main(sys.argv[1:])
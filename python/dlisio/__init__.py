@@ -1,7 +1,13 @@
 from . import core
 from . import plumbing
 from . import errors
+from . import stats
+from . import cache
 from .settings import get_encodings, set_encodings
+from .settings import get_native_curves, set_native_curves
+from .settings import get_ident_bytes, set_ident_bytes
+from .settings import get_big_endian_curves, set_big_endian_curves
+from .settings import get_verify_checksums, set_verify_checksums
 from .file import physicalfile, logicalfile
 from .load import open, load
 
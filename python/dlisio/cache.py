@@ -0,0 +1,106 @@
+import os
+import threading
+
+from collections import OrderedDict, namedtuple
+
+from . import settings
+
+class lfindex(namedtuple('lfindex', 'offset tif pool fdata framenos vrs')):
+    """ For internal use.
+    The immutable parts of a loaded logical file. offset is where the logical
+    file is opened on the raw file, and tif is True if it is wrapped in
+    tapeimage. vrs is the visible record index of the logical file, or None
+    for tapeimage files.
+    """
+    __slots__ = ()
+
+class entry(object):
+    """ For internal use.
+    A loaded physical file in the filecache. refs is the number of open
+    logical file handles that use it.
+    """
+    def __init__(self, cache, key, sul, lfs, nbytes):
+        self.cache = cache
+        self.key = key
+        self.sul = sul
+        self.lfs = lfs
+        self.nbytes = nbytes
+        self.refs = 0
+
+    def release(self):
+        self.cache.release(self)
+
+class filecache(object):
+    """ For internal use.
+    Process-wide cache of loaded physical files, for load(cache=True).
+
+    Entries are keyed by the canonical path, size and modification time of
+    the file, so a file that is changed on disk is loaded again. Every
+    logical file handle holds a reference to its entry, and only entries
+    without references are evicted, least-recently-used first, when the
+    total (estimated) size goes over settings.file_cache_size.
+
+    The cache is safe to use from multiple threads.
+    """
+    def __init__(self):
+        self.entries = OrderedDict()
+        self.size = 0
+        self.lock = threading.Lock()
+
+    @staticmethod
+    def key(path, resync):
+        st = os.stat(path)
+        return (os.path.realpath(path), st.st_size, st.st_mtime_ns, resync)
+
+    def acquire(self, key):
+        """Get the entry for key, with a reference for every logical file, or
+        None if it is not cached
+        """
+        with self.lock:
+            e = self.entries.pop(key, None)
+            if e is None: return None
+            self.entries[key] = e
+            e.refs += len(e.lfs)
+            return e
+
+    def insert(self, key, sul, lfs, nbytes):
+        """Add a newly loaded file, with a reference for every logical file
+
+        The returned entry is not cached if it is larger than the budget, or
+        if another thread got there first, but references can be released
+        all the same.
+        """
+        e = entry(self, key, sul, lfs, nbytes)
+        e.refs = len(lfs)
+        with self.lock:
+            if key in self.entries: return e
+            if nbytes > settings.file_cache_size: return e
+            self.entries[key] = e
+            self.size += nbytes
+            self.evict()
+        return e
+
+    def release(self, e):
+        with self.lock:
+            e.refs -= 1
+            self.evict()
+
+    def evict(self):
+        budget = settings.file_cache_size
+        for key in list(self.entries):
+            if self.size <= budget: break
+            e = self.entries[key]
+            if e.refs > 0: continue
+            del self.entries[key]
+            self.size -= e.nbytes
+
+    def clear(self):
+        """Drop all entries that are not in use"""
+        with self.lock:
+            for key in list(self.entries):
+                e = self.entries[key]
+                if e.refs > 0: continue
+                del self.entries[key]
+                self.size -= e.nbytes
+
+files = filecache()
@@ -2,27 +2,289 @@
 Supporing methods for dlis class.
 Are moved into separate file in order not to clutter interface
 """
+import math
+import sys
 import numpy as np
+from collections import OrderedDict
+
 from . import core
 
-def curves(dlis, frame, dtype, pre_fmt, fmt, post_fmt):
+def storage(dtype):
+    """ For internal use.
+    The dtype used to allocate curves for dtype. numpy cannot make buffers of
+    datetime64 [1], so datetime64 (native DTIME, see set_native_curves) is
+    stored as int64, and the array viewed as dtype after decoding.
+
+    [1] https://github.com/numpy/numpy/issues/4983
+    """
+    if dtype.fields is not None:
+        names = dtype.names
+        fields = [dtype.fields[name] for name in names]
+        return np.dtype({
+            'names'   : names,
+            'formats' : [storage(field[0]) for field in fields],
+            'offsets' : [field[1] for field in fields],
+            'titles'  : [field[2] if len(field) > 2 else None
+                         for field in fields],
+            'itemsize': dtype.itemsize,
+        })
+
+    if dtype.subdtype is not None:
+        base, shape = dtype.subdtype
+        return np.dtype((storage(base), shape))
+
+    if dtype.kind == 'M':
+        return np.dtype('i8')
+
+    return dtype
+
+def curves(dlis, frame, dtype, mode, pre_fmt, fmt, post_fmt, frames=None,
+           index_range=None):
     """ For internal use.
     Reads curves for provided frame and position defined by frame format:
-    pre_fmt (to skip), fmt (to read), post_fmt (to skip)
+    pre_fmt (to skip), fmt (to read), post_fmt (to skip). dtype must have
+    been made with the curve mode, mode.
+
+    If frames = (first, last) is given, only frames with frame numbers in
+    [first, last] are returned, and only the records that may contain them
+    are read. Likewise for index_range = (top, bottom) and the values of the
+    index channel.
+    """
+    try:
+        indices = dlis.fdata_index[frame.fingerprint]
+    except KeyError:
+        indices = []
+
+    if frames is not None and index_range is not None:
+        msg = 'frames and index_range are mutually exclusive'
+        raise ValueError(msg)
+
+    label = None
+    if index_range is not None:
+        if frame.index_type is None:
+            # Frames without an index channel are indexed by FRAMENO
+            lo, hi = sorted(index_range)
+            frames = (int(math.ceil(lo)), int(math.floor(hi)))
+            index_range = None
+        else:
+            indices = index_records(dlis, frame, indices, index_range)
+            label = dtype.names[1]
+
+    framenos = None
+    if frames is not None and dlis.fdata_framenos is not None:
+        framenos = dlis.fdata_framenos.get(frame.fingerprint)
+
+    alloc = lambda size: np.empty(shape = size, dtype = storage(dtype))
+    if framenos is None:
+        data = core.read_fdata(
+            pre_fmt,
+            fmt,
+            post_fmt,
+            dlis.file,
+            indices,
+            dtype.itemsize,
+            mode,
+            alloc,
+            dlis.error_handler,
+            reader = dlis.reader,
+        )
+    else:
+        data = core.read_fdata(
+            pre_fmt,
+            fmt,
+            post_fmt,
+            dlis.file,
+            indices,
+            framenos,
+            frames[0],
+            frames[1],
+            dtype.itemsize,
+            mode,
+            alloc,
+            dlis.error_handler,
+            reader = dlis.reader,
+        )
+
+    data = data.view(dtype)
+
+    # The first and last record may have frames outside the range
+    if frames is not None:
+        first, last = frames
+        frameno = data['FRAMENO']
+        return data[(frameno >= first) & (frameno <= last)]
+
+    if index_range is not None:
+        lo, hi = sorted(index_range)
+        index = data[label]
+        return data[(index >= lo) & (index <= hi)]
+
+    return data
+
+def manycurves(dlis, frames, strict, threads):
+    """ For internal use.
+    Reads all curves for every frame in frames, in a single pass over the
+    records of all the frames. Returns a list of arrays, in the same order as
+    frames.
+    """
+    mode = core.curve_mode()
+    dtypes = [frame.modedtype(mode, strict=strict) for frame in frames]
+
+    def alloc(dtype):
+        return lambda size: np.empty(shape = size, dtype = storage(dtype))
+
+    jobs = [
+        core.fdata_job(
+            frame.fmtstr(),
+            dlis.fdata_index.get(frame.fingerprint, []),
+            dtype.itemsize,
+            mode,
+            alloc(dtype),
+        )
+        for frame, dtype in zip(frames, dtypes)
+    ]
+
+    arrays = core.read_fdata_many(jobs, dlis.file, dlis.error_handler, threads,
+                                  reader = dlis.reader)
+    return [data.view(dtype) for data, dtype in zip(arrays, dtypes)]
+
+def index_records(dlis, frame, indices, index_range):
+    """ For internal use.
+    The records of the frame that may contain index values in index_range,
+    found from the index value of the first frame in every record. The
+    index values are read once per frame, and kept on the logical file.
     """
+    # Only scalar, numeric index channels can be searched and compared
+    supported = 'rfxVFdDluUL'
+    fmt = frame.channels[0].fmtstr()
+    if len(fmt) != 1 or fmt not in supported:
+        msg = 'index_range requires a scalar, numeric index channel, {} is {}'
+        raise ValueError(msg.format(frame.channels[0], fmt))
+
+    try:
+        values = dlis.fdata_indexvalues[frame.fingerprint]
+    except KeyError:
+        # The records are read with the batch reader when there is one
+        source = dlis.file if dlis.reader is None else dlis.reader
+        values = core.indexvalues(source, indices, fmt, dlis.error_handler)
+        dlis.fdata_indexvalues[frame.fingerprint] = values
+
+    top, bottom = index_range
+    return core.findindex(indices, values, top, bottom)
+
+def itercurves(dlis, frame, dtype, mode, fmt, chunk_frames):
+    """ For internal use.
+    Iterator of chunks of at most chunk_frames frames. The same array is
+    re-used for every chunk, and each yielded chunk is a view of it. Every
+    chunk is decoded with mode, which dtype must have been made with.
+    """
+    if chunk_frames < 1:
+        msg = 'chunk_frames must be positive, was {}'
+        raise ValueError(msg.format(chunk_frames))
+
     try:
         indices = dlis.fdata_index[frame.fingerprint]
     except KeyError:
         indices = []
 
-    alloc = lambda size: np.empty(shape = size, dtype = dtype)
-    return core.read_fdata(
-        pre_fmt,
+    cursor = core.fdata_cursor(
         fmt,
-        post_fmt,
         dlis.file,
         indices,
         dtype.itemsize,
-        alloc,
+        mode,
         dlis.error_handler
     )
+
+    def chunks():
+        buffer = np.empty(shape = chunk_frames, dtype = storage(dtype))
+        chunk = buffer.view(dtype)
+        while True:
+            frames = cursor.read(buffer)
+            if frames == 0: return
+            yield chunk[:frames]
+
+    return chunks()
+
+def cachedsize(curves, samples = 256):
+    """ For internal use.
+    Estimated memory (in bytes) of curves. For object fields, nbytes only
+    counts the pointers, so the size of the python objects (and of the items
+    of tuples) is estimated from at most samples evenly spaced frames.
+    Measuring every object would cost about as much as decoding them.
+    """
+    size = curves.nbytes
+    dtype = curves.dtype
+    if not dtype.hasobject or len(curves) == 0:
+        return size
+
+    def objsize(x):
+        n = sys.getsizeof(x)
+        if isinstance(x, tuple):
+            n += sum(sys.getsizeof(item) for item in x)
+        return n
+
+    rows = np.linspace(0, len(curves) - 1, num = min(len(curves), samples))
+    sample = curves[rows.astype(np.intp)]
+    names = [name for name in dtype.names if dtype[name].hasobject]
+    objects = sum(objsize(x)
+                  for name in names
+                  for x in sample[name].ravel())
+    return size + objects * len(curves) // len(sample)
+
+class framecache(object):
+    """ For internal use.
+    Least-recently-used cache of decoded frames, bounded by the total size
+    (in bytes) of the cached arrays. Arrays larger than the budget are never
+    cached, and a budget of 0 disables the cache.
+
+    The size of frames with python objects is estimated (see cachedsize),
+    rather than these frames being left out, as it is the slow-to-decode
+    frames with objects that gain the most from the cache.
+    """
+    def __init__(self, budget):
+        self.budget = budget
+        self.size = 0
+        self.entries = OrderedDict()
+
+    def get(self, key):
+        try:
+            curves, size = self.entries.pop(key)
+        except KeyError:
+            return None
+
+        self.entries[key] = (curves, size)
+        return curves
+
+    def put(self, key, curves):
+        size = cachedsize(curves)
+        if size > self.budget:
+            return
+
+        while self.entries and self.size + size > self.budget:
+            _, (_, evicted) = self.entries.popitem(last = False)
+            self.size -= evicted
+
+        self.entries[key] = (curves, size)
+        self.size += size
+
+    def clear(self):
+        self.entries.clear()
+        self.size = 0
+
+def cachedcurves(dlis, frame, strict):
+    """ For internal use.
+    Reads all curves for the frame, like Frame.curves(), but goes through the
+    frame cache of the logical file. The returned array is shared with the
+    cache, and must not be modified.
+    """
+    mode = core.curve_mode()
+    dtype = frame.modedtype(mode, strict=strict)
+    key = (frame.fingerprint, strict, dtype)
+
+    cached = dlis.frame_cache.get(key)
+    if cached is not None:
+        return cached
+
+    data = curves(dlis, frame, dtype, mode, "", frame.fmtstr(), "")
+    dlis.frame_cache.put(key, data)
+    return data
@@ -204,3 +204,66 @@ class ErrorHandler(core.error_handler):
 
         msg = "{}{}{}{}{}"
         return msg.format(problem, context, severity, spec, action)
+
+class ErrorCollector(core.error_sink):
+    """Collect errors rather than acting on them
+
+    An alternative to ErrorHandler for badly formatted files, where dlisio
+    may report the same problem for every record. Every ErrorHandler.log
+    call crosses from C++ into Python and formats a message, which can
+    dominate the time spent loading such files. The ErrorCollector is
+    implemented in C++: problems are de-duplicated and counted as they
+    happen, and the messages are only formatted when asked for.
+
+    Critical errors are still raised by default, like with ErrorHandler.
+
+    Parameters
+    ----------
+    raise_critical : bool
+        Raise RuntimeError on critical errors, after recording them
+    max_tells : int
+        Keep the offsets of the first max_tells occurrences of every problem
+
+    Examples
+    --------
+    Load a file and look at the problems afterwards:
+
+    >>> from dlisio.errors import ErrorCollector
+    >>> errors = ErrorCollector(raise_critical=False)
+    >>> files = dlisio.load(path, error_handler=errors)
+    >>> len(errors)
+    1
+    >>> for msg in errors.messages():
+    ...     print(msg)
+    Problem:      checksum mismatch in logical record segment at tell 80: ...
+    Where:        dl::findoffsets (checksum)
+    Severity:     major
+    RP66V1 ref:   [2.2.2.4 Logical Record Segment Trailer (LRST)]
+    Action taken: Record is indexed as-is
+    Occurrences:  1200
+
+    The problems are also available as objects with the attributes
+    severity, context, problem, specification, action, count and tells (the
+    offsets of the first occurrences):
+
+    >>> problem = errors.problems()[0]
+    >>> problem.count, problem.tells[:3]
+    (1200, [80, 8272, 16464])
+    """
+    def __init__(self, raise_critical = True, max_tells = 64):
+        core.error_sink.__init__(self, raise_critical, max_tells)
+
+    def messages(self):
+        """Formatted messages for all distinct problems
+
+        Returns
+        -------
+        messages : list of str
+        """
+        msgs = []
+        for p in self.problems():
+            msg = ErrorHandler.format_error(
+                p.severity, p.context, p.problem, p.specification, p.action)
+            msg += '\n{:<{align}} {}'.format('Occurrences:', p.count, align=13)
+            msgs.append(msg)
+        return msgs
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <atomic>
 #include <bitset>
 #include <cerrno>
 #include <cstdint>
@@ -7,25 +9,34 @@
 #include <fstream>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <vector>
 #include <limits>
 #include <functional>
 
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
 #include <pybind11/stl_bind.h>
 #include <pybind11/stl.h>
 #include <datetime.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include <dlisio/dlisio.h>
 #include <dlisio/types.h>
 
 namespace py = pybind11;
 using namespace py::literals;
 
+#include <dlisio/ext/errors.hpp>
 #include <dlisio/ext/exception.hpp>
 #include <dlisio/ext/io.hpp>
+#include <dlisio/ext/stats.hpp>
 #include <dlisio/ext/types.hpp>
 
 namespace {
@@ -63,6 +74,159 @@ const std::vector< std::string >& get_encodings() {
     return encodings;
 }
 
+/*
+ * Global switch for decoding object-typed curve samples (fsing1/2, fdoub1/2,
+ * dtime, obname and objref) to native numpy types, rather than one python
+ * object per sample.
+ *
+ * It is global for the same reason as the encodings. The dtypes are created
+ * in python (see dlisio.reprc), so the switch is read once, into a
+ * curve_mode, when the dtype is made, and the decoding is done with that
+ * mode, not with the switch as it is when decoding.
+ */
+bool native_curves = false;
+
+void set_native_curves(bool native) {
+    native_curves = native;
+}
+
+bool get_native_curves() {
+    return native_curves;
+}
+
+/*
+ * Global switch for decoding IDENT and UNITS curve samples to S255 (bytes),
+ * rather than U255. U255 is 4 bytes per character, so ident channels take
+ * four times the memory, and the characters have to be widened. Like
+ * native_curves, it is read into a curve_mode when the dtype is made.
+ */
+bool ident_bytes = false;
+
+void set_ident_bytes(bool bytes) {
+    ident_bytes = bytes;
+}
+
+bool get_ident_bytes() {
+    return ident_bytes;
+}
+
+/*
+ * Global switch for leaving IEEE floats and integers in their on-disk,
+ * big-endian byte order. The dtype of these channels is then big-endian, and
+ * the samples are copied as-is, rather than decoded. Like native_curves, it is
+ * read into a curve_mode when the dtype is made.
+ */
+bool big_endian_curves = false;
+
+void set_big_endian_curves(bool big_endian) {
+    big_endian_curves = big_endian;
+}
+
+bool get_big_endian_curves() {
+    return big_endian_curves;
+}
+
+/*
+ * The curve switches, as they were when the dtype of a frame was made
+ *
+ * The decoders write samples in the layout given by the mode, and the dtype
+ * must have been made from the same mode, or samples are written in the
+ * wrong layout. A default-constructed mode is the current switches.
+ */
+struct curve_mode {
+    curve_mode()
+        : native(native_curves)
+        , ident_bytes(::ident_bytes)
+        , big_endian(big_endian_curves)
+    {}
+
+    bool native;
+    bool ident_bytes;
+    bool big_endian;
+};
+
+/*
+ * Global switch for verifying the checksums of logical record segments, when
+ * indexing and reading records. Off by default, since very few files have
+ * checksums, and the ones that do are read in full when indexing.
+ */
+bool verify_checksums = false;
+
+void set_verify_checksums(bool verify) {
+    verify_checksums = verify;
+}
+
+bool get_verify_checksums() {
+    return verify_checksums;
+}
+
+/*
+ * Curves of fewer bytes than this (per thread) are decoded in the calling
+ * thread, as starting threads is not free. It is a switch mainly so that the
+ * threaded decoding can be tested on small files.
+ */
+std::size_t fdata_thread_bytes = 1 << 20;
+
+void set_fdata_thread_bytes(std::size_t bytes) {
+    fdata_thread_bytes = bytes;
+}
+
+std::size_t get_fdata_thread_bytes() {
+    return fdata_thread_bytes;
+}
+
+/*
+ * Records are extracted and decoded this many bytes at a time, so that only
+ * a bounded number of records are in memory at once. It is a switch mainly
+ * so that curves of several chunks can be tested on small files.
+ */
+std::size_t fdata_chunk_bytes = 16 << 20;
+
+void set_fdata_chunk_bytes(std::size_t bytes) {
+    fdata_chunk_bytes = bytes;
+}
+
+std::size_t get_fdata_chunk_bytes() {
+    return fdata_chunk_bytes;
+}
+
+/*
+ * Hot-path counters and stage timers, as a dict:
+ *
+ *  {
+ *      'enabled': bool,
+ *      'bytes_read': int, 'seeks': int, ...,
+ *      'stages': { 'findoffsets': { 'calls': int, 'seconds': float }, ... },
+ *  }
+ *
+ * When dlisio is built without DLISIO_STATS, everything is zero.
+ */
+py::dict stats() {
+    const auto snap = dl::stats::read();
+
+    py::dict d;
+    d["enabled"] = dl::stats::enabled();
+    for (int i = 0; i < dl::stats::counters; ++i) {
+        const auto c = dl::stats::counter(i);
+        d[dl::stats::name(c)] = snap.count[i];
+    }
+
+    py::dict stages;
+    for (int i = 0; i < dl::stats::stages; ++i) {
+        const auto s = dl::stats::stage(i);
+        py::dict stage;
+        stage["calls"] = snap.calls[i];
+        stage["seconds"] = double(snap.nanoseconds[i]) * 1e-9;
+        stages[dl::stats::name(s)] = stage;
+    }
+    d["stages"] = stages;
+    return d;
+}
+
+void reset_stats() {
+    dl::stats::reset();
+}
+
 }
 
 namespace pybind11 { namespace detail {
@@ -333,8 +497,194 @@ void assert_overflow(const char* ptr, const char* end, int skip) {
     }
 }
 
+/*
+ * Widen len bytes to uint32 (UCS-4), 16 bytes at a time when SSE2 is
+ * available. Bytes are widened as unsigned, i.e. interpreted as latin-1.
+ */
+void widen(unsigned char* dst, const char* src, std::int32_t len)
+noexcept (true) {
+    std::int32_t i = 0;
+#if defined(__SSE2__)
+    const auto zero = _mm_setzero_si128();
+    for (; i + 16 <= len; i += 16) {
+        const auto x  = _mm_loadu_si128(
+            reinterpret_cast< const __m128i* >(src + i)
+        );
+        const auto lo = _mm_unpacklo_epi8(x, zero);
+        const auto hi = _mm_unpackhi_epi8(x, zero);
+        auto* out = reinterpret_cast< __m128i* >(dst + i * 4);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, zero));
+    }
+#endif
+    for (; i < len; ++i) {
+        const auto x = std::uint32_t(std::uint8_t(src[i]));
+        std::memcpy(dst + i * sizeof(x), &x, sizeof(x));
+    }
+}
+
+/*
+ * Write an ident as numpy's U255 (255 uint32s) or, with mode.ident_bytes,
+ * S255. Both are zero-padded, but only the tail not covered by the string is
+ * zeroed.
+ */
+void write_ident(unsigned char*& dst,
+                 const char* src,
+                 std::int32_t len,
+                 const curve_mode& mode)
+noexcept (true) {
+    constexpr auto chars = 255;
+
+    if (mode.ident_bytes) {
+        std::memcpy(dst, src, len);
+        std::memset(dst + len, 0, chars - len);
+        dst += chars;
+        return;
+    }
+
+    constexpr auto charsize = sizeof(std::uint32_t);
+    widen(dst, src, len);
+    std::memset(dst + len * charsize, 0, (chars - len) * charsize);
+    dst += chars * charsize;
+}
+
+/*
+ * Days since 1970-01-01 of a date in the proleptic gregorian calendar [1]
+ *
+ * [1] http://howardhinnant.github.io/date_algorithms.html#days_from_civil
+ */
+std::int64_t days_from_civil(std::int64_t y, int m, int d) noexcept (true) {
+    y -= m <= 2;
+    const auto era = (y >= 0 ? y : y - 399) / 400;
+    const auto yoe = y - era * 400;
+    const auto doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const auto doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+/*
+ * On-disk size of the codes that are copied as-is with mode.big_endian, or 0
+ * if the code is always decoded
+ */
+int passthrough_size(char f) noexcept (true) {
+    switch (f) {
+        case DLIS_FMT_SSHORT:
+        case DLIS_FMT_USHORT: return 1;
+        case DLIS_FMT_SNORM:
+        case DLIS_FMT_UNORM:  return 2;
+        case DLIS_FMT_FSINGL:
+        case DLIS_FMT_SLONG:
+        case DLIS_FMT_ULONG:  return 4;
+        case DLIS_FMT_FDOUBL:
+        case DLIS_FMT_CSINGL: return 8;
+        case DLIS_FMT_CDOUBL: return 16;
+        default:              return 0;
+    }
+}
+
+/*
+ * Read a curve sample into its native numpy representation (see
+ * native_curves). Returns false if the sample has no native representation
+ * different from the default, and nothing is read.
+ *
+ *  fsing1, fdoub1: (V, A) of float32/float64
+ *  fsing2, fdoub2: (V, A, B) of float32/float64
+ *  dtime:          datetime64[ms], ignoring the time zone like the
+ *                  datetime objects do. Invalid dates are NaT
+ *  obname:         (origin u4, copynumber u1, id U255)
+ *  objref:         (type U255, origin u4, copynumber u1, id U255)
+ */
+bool read_native_sample(const char* f, const char*& ptr, const char* end,
+                        unsigned char*& dst, const curve_mode& mode)
+noexcept (false) {
+    switch (*f) {
+        case DLIS_FMT_FSING1:
+        case DLIS_FMT_FSING2:
+        case DLIS_FMT_FDOUB1:
+        case DLIS_FMT_FDOUB2: {
+            /* dlis_packf writes the value and bounds back-to-back */
+            int src_skip, dst_skip;
+            const char localfmt[] = {*f, '\0'};
+            dlis_packflen(localfmt, ptr, &src_skip, &dst_skip);
+            assert_overflow(ptr, end, src_skip);
+            dlis_packf(localfmt, ptr, dst);
+            dst += dst_skip;
+            ptr += src_skip;
+            return true;
+        }
+
+        case DLIS_FMT_DTIME: {
+            assert_overflow(ptr, end, DLIS_SIZEOF_DTIME);
+            int Y, TZ, M, D, H, MN, S, MS;
+            ptr = dlis_dtime(ptr, &Y, &TZ, &M, &D, &H, &MN, &S, &MS);
+            Y = dlis_year(Y);
+
+            auto ms = std::numeric_limits< std::int64_t >::min(); /* NaT */
+            if (M >= 1 and M <= 12 and D >= 1 and D <= 31) {
+                const auto days = days_from_civil(Y, M, D);
+                const auto secs = ((days * 24 + H) * 60 + MN) * 60 + S;
+                ms = secs * 1000 + MS;
+            }
+
+            std::memcpy(dst, &ms, sizeof(ms));
+            dst += sizeof(ms);
+            return true;
+        }
+
+        case DLIS_FMT_OBNAME: {
+            std::int32_t origin;
+            std::uint8_t copy;
+            std::int32_t idlen;
+            char id[255];
+            const auto* next = dlis_obname(ptr, &origin, &copy, &idlen, id);
+            assert_overflow(ptr, end, next - ptr);
+            ptr = next;
+
+            const auto uorigin = std::uint32_t(origin);
+            std::memcpy(dst, &uorigin, sizeof(uorigin));
+            dst += sizeof(uorigin);
+            std::memcpy(dst, &copy, sizeof(copy));
+            dst += sizeof(copy);
+            write_ident(dst, id, idlen, mode);
+            return true;
+        }
+
+        case DLIS_FMT_OBJREF: {
+            std::int32_t typelen;
+            char type[255];
+            std::int32_t origin;
+            std::uint8_t copy;
+            std::int32_t idlen;
+            char id[255];
+            const auto* next = dlis_objref(ptr,
+                                           &typelen,
+                                           type,
+                                           &origin,
+                                           &copy,
+                                           &idlen,
+                                           id);
+            assert_overflow(ptr, end, next - ptr);
+            ptr = next;
+
+            write_ident(dst, type, typelen, mode);
+            const auto uorigin = std::uint32_t(origin);
+            std::memcpy(dst, &uorigin, sizeof(uorigin));
+            dst += sizeof(uorigin);
+            std::memcpy(dst, &copy, sizeof(copy));
+            dst += sizeof(copy);
+            write_ident(dst, id, idlen, mode);
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
 void read_curve_sample(const char* f, const char*& ptr, const char* end,
-                      unsigned char*& dst)
+                      unsigned char*& dst, const curve_mode& mode)
 {
     /*
      * Reads to dst buffer a singular curve where:
@@ -400,6 +750,20 @@ void read_curve_sample(const char* f, const char*& ptr, const char* end,
          dst += sizeof(p);
      };
 
+    if (mode.big_endian) {
+        const auto size = passthrough_size(*f);
+        if (size) {
+            assert_overflow(ptr, end, size);
+            std::memcpy(dst, ptr, size);
+            dst += size;
+            ptr += size;
+            return;
+        }
+    }
+
+    if (mode.native and read_native_sample(f, ptr, end, dst, mode))
+        return;
+
      if (*f == DLIS_FMT_FSING1) {
         float v;
         float a;
@@ -444,7 +808,6 @@ void read_curve_sample(const char* f, const char*& ptr, const char* end,
 
     if (*f == DLIS_FMT_IDENT || *f == DLIS_FMT_UNITS) {
         constexpr auto chars = 255;
-        constexpr auto ident_size = chars * sizeof(std::uint32_t);
 
         std::int32_t len;
         char tmp[chars];
@@ -456,12 +819,7 @@ void read_curve_sample(const char* f, const char*& ptr, const char* end,
          * and pad with zero. This means the string is both null
          * and length terminated, whichever comes first.
          */
-        std::memset(dst, 0, ident_size);
-        for (auto i = 0; i < len; ++i) {
-            const auto x = std::uint32_t(tmp[i]);
-            std::memcpy(dst + i * sizeof(x), &x, sizeof(x));
-        }
-        dst += ident_size;
+        write_ident(dst, tmp, len, mode);
         return;
     }
 
@@ -590,9 +948,126 @@ void read_curve_sample(const char* f, const char*& ptr, const char* end,
 }
 
 void read_fdata_frame(const char* fmt, const char*& ptr, const char* end,
-                      unsigned char*& dst) noexcept (false) {
+                      unsigned char*& dst, const curve_mode& mode)
+noexcept (false) {
+    for (auto* f = fmt; *f; ++f) {
+        read_curve_sample(f, ptr, end, dst, mode);
+    }
+}
+
+/*
+ * Is a sample of format f decoded to a python object with the curve mode
+ */
+bool object_sample(char f, const curve_mode& mode) noexcept (true) {
+    switch (f) {
+        case DLIS_FMT_ASCII:
+        case DLIS_FMT_ATTREF:
+            return true;
+
+        case DLIS_FMT_FSING1:
+        case DLIS_FMT_FSING2:
+        case DLIS_FMT_FDOUB1:
+        case DLIS_FMT_FDOUB2:
+        case DLIS_FMT_DTIME:
+        case DLIS_FMT_OBNAME:
+        case DLIS_FMT_OBJREF:
+            return not mode.native;
+
+        default:
+            return false;
+    }
+}
+
+/*
+ * Size of a decoded sample of format f in the output array, with the curve
+ * mode. Throws if f is not a valid format.
+ */
+std::size_t sample_size(char f, const curve_mode& mode) noexcept (false) {
+    if (mode.big_endian) {
+        const auto size = passthrough_size(f);
+        if (size) return size;
+    }
+
+    if (object_sample(f, mode)) return sizeof(PyObject*);
+
+    constexpr std::size_t chars = 255;
+    const auto ident = mode.ident_bytes ? chars
+                                        : chars * sizeof(std::uint32_t);
+    const auto origin = sizeof(std::uint32_t) + sizeof(std::uint8_t);
+    switch (f) {
+        case DLIS_FMT_IDENT:
+        case DLIS_FMT_UNITS:  return ident;
+        case DLIS_FMT_FSING1: return 2 * sizeof(float);
+        case DLIS_FMT_FSING2: return 3 * sizeof(float);
+        case DLIS_FMT_FDOUB1: return 2 * sizeof(double);
+        case DLIS_FMT_FDOUB2: return 3 * sizeof(double);
+        case DLIS_FMT_DTIME:  return sizeof(std::int64_t);
+        case DLIS_FMT_OBNAME: return origin + ident;
+        case DLIS_FMT_OBJREF: return ident + origin + ident;
+        default:              break;
+    }
+
+    int dst;
+    const char localfmt[] = { f, '\0' };
+    if (dlis_pack_size(localfmt, nullptr, &dst) != DLIS_OK)
+        throw std::invalid_argument("invalid format string");
+    return std::size_t(dst);
+}
+
+/*
+ * Does a frame of fmt decode to python objects with the curve mode
+ */
+bool object_frame(const char* fmt, const curve_mode& mode) noexcept (true) {
     for (auto* f = fmt; *f; ++f) {
-        read_curve_sample(f, ptr, end, dst);
+        if (object_sample(*f, mode)) return true;
+    }
+    return false;
+}
+
+/*
+ * Throws unless a frame of fmt decodes to exactly itemsize bytes with the
+ * curve mode. Every frame is decoded straight into its row, so a dtype that
+ * does not match the mode would have frames written past the end of their
+ * rows, or python objects written into plain bytes.
+ */
+void assert_itemsize(const char* fmt,
+                     std::size_t itemsize,
+                     const curve_mode& mode) noexcept (false) {
+    std::size_t size = 0;
+    for (auto* f = fmt; *f; ++f)
+        size += sample_size(*f, mode);
+
+    if (size != itemsize) {
+        const auto msg = "read_fdata: frames of format '"
+                       + std::string(fmt)
+                       + "' are " + std::to_string(size)
+                       + " bytes with the curve mode, but itemsize was "
+                       + std::to_string(itemsize);
+        throw std::invalid_argument(msg);
+    }
+}
+
+/*
+ * Decode the frame at ptr into the row at dst, and move dst to the next row.
+ * Throws if the frame did not take up exactly itemsize bytes, which
+ * assert_itemsize should rule out before any frame is decoded.
+ */
+void read_fdata_row(const char* fmt,
+                    const char*& ptr,
+                    const char* end,
+                    unsigned char*& dst,
+                    std::size_t itemsize,
+                    const curve_mode& mode)
+noexcept (false) {
+    const auto* row = dst;
+    read_fdata_frame(fmt, ptr, end, dst, mode);
+    if (std::size_t(dst - row) != itemsize) {
+        const auto msg = "read_fdata: frame of format '"
+                       + std::string(fmt)
+                       + "' was " + std::to_string(dst - row)
+                       + " bytes, expected itemsize "
+                       + std::to_string(itemsize);
+        throw std::logic_error(msg);
     }
 }
 
@@ -605,7 +1080,8 @@ void read_fdata_record(const char* pre_fmt,
                        int& frames,
                        const std::size_t& itemsize,
                        std::size_t allocated_rows,
-                       std::function<void (std::size_t)> resize)
+                       std::function<void (std::size_t)> resize,
+                       const curve_mode& mode)
 noexcept (false) {
 
     /* get frame number and slots */
@@ -621,7 +1097,7 @@ noexcept (false) {
         assert_overflow(ptr, end, src_skip);
         ptr += src_skip;
 
-        read_fdata_frame(fmt, ptr, end, dst);
+        read_fdata_row(fmt, ptr, end, dst, itemsize, mode);
 
         dlis_packflen(post_fmt, ptr, &src_skip, nullptr);
         assert_overflow(ptr, end, src_skip);
@@ -631,128 +1107,1074 @@ noexcept (false) {
     }
 }
 
-py::object read_fdata(const char* pre_fmt,
-                      const char* fmt,
-                      const char* post_fmt,
-                      dl::stream& file,
-                      const std::vector< long long >& indices,
-                      std::size_t itemsize,
-                      py::object alloc,
-                      dl::error_handler& errorhandler)
-noexcept (false) {
-    // TODO: reverse fingerprint to skip bytes ahead-of-time
+/*
+ * Two-phase FDATA decoding
+ *
+ * When every channel in the frame is fixed-size on disk, the only
+ * variable-size part of a frame is the frame number (uvari), whose size is
+ * given by its first byte. Counting the frames in a record is then just a
+ * walk over the frame numbers, which is cheap compared to decoding.
+ *
+ * The first phase extracts the records, and counts the frames and the output
+ * row of every record. The output array is then allocated once, with the
+ * exact number of rows, and the records are decoded straight into their rows.
+ *
+ * When the frame also decodes to plain bytes (no python objects), the records
+ * are decoded in parallel. Since every record has its own rows, the output
+ * does not depend on the number of threads.
+ *
+ * With mode.big_endian, frames where every sample is copied as-is need no
+ * decoding at all, and everything but the frame number is a single memcpy.
+ */
+struct fdata_layout {
+    /* on-disk size of a frame, excluding the frame number */
+    int framesize;
+    /* decodes to plain bytes, with dlis_packf */
+    bool plain;
+    /* the frame, excluding the frame number, is copied as-is */
+    bool raw;
+};
+
+bool fixed_layout(const char* fmt,
+                  std::size_t itemsize,
+                  const curve_mode& mode,
+                  fdata_layout& layout)
+noexcept (true) {
+    if (fmt[0] != DLIS_FMT_UVARI) return false;
+
+    int varsrc, vardst;
+    if (dlis_pack_varsize(fmt + 1, &varsrc, &vardst) != DLIS_OK) return false;
+    if (varsrc or vardst) return false;
+
     /*
-     * TODO: error has already been checked (in python), but should be more
-     * thorough
-     *
-     * TODO: veriy that format string is valid
+     * The frame number is left out, as dlis_pack_size does not report the
+     * source size of formats with variable-size codes
      */
+    int src, dst;
+    if (dlis_pack_size(fmt + 1, &src, &dst) != DLIS_OK) return false;
+
     /*
-     * This function goes through a lot of ceremony to use numpy arrays
-     * directly, and to write output data in-place in the return value. The
-     * main reason is *exception safety*.
-     *
-     * Virtually every operation that goes into this can throw an exception,
-     * and when that happens it's important that not-yet-complete data is
-     * cleaned up.
-     *
-     * Of course, for all non-object types this is not a problem, as they're
-     * just bytes in an array, and std::vector would've been plenty. It's made
-     * more complicated by the presence of PyObject* pointers embedded in the
-     * data stream - there are no C++ destructors that can elegantly reach
-     * them, and doing that would pretty much be replicating numpy
-     * functionality anyway.
-     *
-     * By writing directly into the numpy array as we go, PyObjects are either
-     * default-constructed (set to None) by numpy, or properly created (and
-     * replaced) here.
+     * These codes are fixed-size on disk, but are decoded to python objects,
+     * or in the case of native dtime, converted from the dlis_packf output
      */
-    auto allocated_rows = indices.size();
-    auto dstobj = alloc(allocated_rows);
-    auto dstb = py::buffer(dstobj);
-    auto info = dstb.request(true);
-    auto* dst = static_cast< unsigned char* >(info.ptr);
+    static const std::string objects = {
+        DLIS_FMT_FSING1, DLIS_FMT_FSING2,
+        DLIS_FMT_FDOUB1, DLIS_FMT_FDOUB2,
+        DLIS_FMT_DTIME,
+    };
+    static const std::string native_objects = { DLIS_FMT_DTIME };
+    const auto& converted = mode.native ? native_objects : objects;
+    const auto hasobjects =
+        std::string(fmt).find_first_of(converted) != std::string::npos;
+
+    layout.framesize = src;
+    layout.plain = not hasobjects
+               and std::size_t(dst) + sizeof(std::int32_t) == itemsize;
 
     /*
-     * Resizing is clumsy, because in-place resize (through the method)
-     * requires there to be no references to the underlying data. That means
-     * the buffer-info and buffer must be wiped before resizing takes place,
-     * and then carefully restored to the new memory.
+     * dlis_packf would swap the samples that are copied as-is, so frames that
+     * mix them with decoded samples must go through read_curve_sample
      */
-    auto resize = [&](std::size_t n) {
-        info = py::buffer_info {};
-        dstb = py::buffer {};
-        dstobj.attr("resize")(n);
-        allocated_rows = n;
-        dstb = py::buffer(dstobj);
-        info = dstb.request(true);
-        dst = static_cast< unsigned char* >(info.ptr);
-    };
+    layout.raw = false;
+    if (mode.big_endian) {
+        std::size_t copied = 0;
+        for (auto* f = fmt + 1; *f; ++f)
+            copied += passthrough_size(*f) > 0;
+
+        layout.raw = layout.plain and copied == std::strlen(fmt + 1);
+        if (copied and not layout.raw) layout.plain = false;
+    }
+    return true;
+}
+
+int uvari_size(const char* ptr) noexcept (true) {
+    const auto x = std::uint8_t(*ptr);
+    if ((x & 0x80) == 0)    return 1;
+    if ((x & 0xC0) == 0x80) return 2;
+    return 4;
+}
+
+/*
+ * Number of frames in [ptr, end), or throws if the last frame is truncated
+ */
+std::size_t count_frames(const fdata_layout& layout,
+                         const char* ptr,
+                         const char* end) noexcept (false) {
+    std::size_t frames = 0;
+    while (ptr < end) {
+        const auto skip = uvari_size(ptr) + layout.framesize;
+        assert_overflow(ptr, end, skip);
+        ptr += skip;
+        ++frames;
+    }
+    return frames;
+}
+
+/*
+ * Decode the frames in [ptr, end) of a fixed layout, one row of itemsize
+ * bytes each. fixed_layout only accepts layouts where a frame fills the row
+ * exactly, so dst moves by itemsize per frame on both paths.
+ */
+void decode_frames(const char* fmt,
+                   const fdata_layout& layout,
+                   const char* ptr,
+                   const char* end,
+                   unsigned char* dst,
+                   std::size_t itemsize) noexcept (true) {
+    if (layout.raw) {
+        while (ptr < end) {
+            std::int32_t frameno;
+            ptr = dlis_uvari(ptr, &frameno);
+            std::memcpy(dst, &frameno, sizeof(frameno));
+            std::memcpy(dst + sizeof(frameno), ptr, layout.framesize);
+            ptr += layout.framesize;
+            dst += itemsize;
+        }
+        return;
+    }
+
+    while (ptr < end) {
+        dlis_packf(fmt, ptr, dst);
+        ptr += uvari_size(ptr) + layout.framesize;
+        dst += itemsize;
+    }
+}
+
+/*
+ * The records at tells, in the same order. With a batch reader, the records
+ * are read concurrently, otherwise one by one from the stream. Records that
+ * cannot be read are returned with the error, for the caller to handle.
+ */
+std::vector< dl::batch_record > extract_all(dl::stream& file,
+                                            const dl::batch_reader* reader,
+                                            const std::vector< long long >& tells,
+                                            dl::error_handler& errorhandler)
+noexcept (false) {
+    if (reader) {
+        const auto all = std::numeric_limits< long long >::max();
+        return reader->extract(tells, all, errorhandler, verify_checksums);
+    }
 
+    std::vector< dl::batch_record > recs(tells.size());
+    for (std::size_t i = 0; i < tells.size(); ++i) {
+        auto& rec = recs[i];
+        rec.tell = tells[i];
+        try {
+            rec.record = dl::extract(file, rec.tell, errorhandler,
+                                     verify_checksums);
+        } catch (const std::exception& e) {
+            rec.error = e.what();
+        }
+    }
+    return recs;
+}
 
+int fdata_threads(int threads, std::size_t records, std::size_t bytes)
+noexcept (true) {
     /*
-     * The frameno is a part of the dtype, and only frame.channels is allowed
-     * to call this function. If pre/post format is set, wrong data is read.
-     *
-     * The interface is not changed for now as they're to be reintroduced at
-     * some point.
+     * Starting threads is not free, so small curves are decoded in the
+     * calling thread
      */
-    assert(std::string(pre_fmt) == "");
-    assert(std::string(post_fmt) == "");
+    if (threads <= 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
 
-    auto record_dst = dst;
+    const auto by_size = fdata_thread_bytes == 0
+                       ? records
+                       : std::max< std::size_t >(1, bytes / fdata_thread_bytes);
+    return int(std::min({ std::size_t(threads), records, by_size }));
+}
 
+py::object read_fdata_fixed(const char* fmt,
+                            const fdata_layout& layout,
+                            dl::stream& file,
+                            const std::vector< long long >& indices,
+                            std::size_t itemsize,
+                            const curve_mode& mode,
+                            py::object alloc,
+                            dl::error_handler& errorhandler,
+                            int threads,
+                            const dl::batch_reader* reader)
+noexcept (false) {
     const auto handle = [&]( const std::string& problem ) {
         const auto context = "dl::read_fdata: reading curves";
         errorhandler.log(dl::error_severity::CRITICAL, context, problem, "",
                          "Record is skipped");
-        // we update the buffer as we go. Hence if error happened we need to
-        // go back and start rewriting updated data
-        dst = record_dst;
     };
 
-    int frames = 0;
-    for (auto i : indices) {
-        record_dst = dst;
-
-        /* get record */
+    struct slot {
         dl::record record;
-        try {
-            record = dl::extract(file, i, errorhandler);
-        } catch (std::exception& e) {
-            handle(e.what());
-            continue;
-        }
+        std::size_t begin; /* offset of the first frame in record.data */
+        std::size_t frames;
+        std::size_t row;
+    };
 
-        if (record.isencrypted()) {
-            handle("encrypted FDATA record");
-            continue;
-        }
+    /*
+     * The frames in a record, and the offset of the first frame. Throws if
+     * the record cannot be decoded.
+     */
+    const auto frames_in = [&](const dl::record& rec, std::size_t& first)
+    -> std::size_t {
+        if (rec.isencrypted())
+            throw std::runtime_error("encrypted FDATA record");
 
-        const auto* ptr = record.data.data();
-        const auto* end = ptr + record.data.size();
+        const auto* begin = rec.data.data();
+        const auto* end = begin + rec.data.size();
 
-        /* read fingerprint */
         std::int32_t origin;
         std::uint8_t copy;
-        ptr = dlis_obname(ptr, &origin, &copy, nullptr, nullptr);
+        const auto* ptr = dlis_obname(begin, &origin, &copy, nullptr, nullptr);
+        first = ptr - begin;
+        return count_frames(layout, ptr, end);
+    };
 
-        try {
-            read_fdata_record(pre_fmt, fmt, post_fmt, ptr, end, dst, frames,
-                              itemsize, allocated_rows, resize);
-        } catch (std::exception& e) {
-            handle(e.what());
+    /*
+     * The records are extracted and decoded a chunk at a time, so that only
+     * a bounded number of records are in memory at once, no matter the size
+     * of the frame.
+     *
+     * The output is allocated once, with the exact number of rows. When the
+     * records do not fit in the first chunk, the rest of the records are
+     * first extracted and counted without being kept, i.e. they are read
+     * twice, which is cheaper than growing (and copying) the output. Only
+     * the rows of records with python objects that fail to decode are
+     * trimmed at the end.
+     */
+    const std::size_t batch = reader ? 64 * std::size_t(reader->depth()) : 1;
+
+    py::object dstobj;
+    py::buffer dstb;
+    py::buffer_info info;
+    std::size_t capacity = 0;
+    std::size_t rows = 0;
+
+    const auto allocate = [&](std::size_t n) {
+        dstobj = alloc(n);
+        dstb = py::buffer(dstobj);
+        info = dstb.request(true);
+        capacity = n;
+    };
+
+    /* see read_fdata for why resizing is this clumsy */
+    const auto resize = [&](std::size_t n) {
+        info = py::buffer_info {};
+        dstb = py::buffer {};
+        dstobj.attr("resize")(n);
+        dstb = py::buffer(dstobj);
+        info = dstb.request(true);
+        capacity = n;
+    };
+
+    /*
+     * The frames in the records [first, end), extracted a batch at a time.
+     * Records that fail are reported when they are decoded, not here.
+     */
+    const auto count = [&](std::size_t first) -> std::size_t {
+        std::size_t frames = 0;
+        while (first < indices.size()) {
+            const auto last = std::min(indices.size(), first + batch);
+            const std::vector< long long > tells(indices.begin() + first,
+                                                 indices.begin() + last);
+            first = last;
+
+            for (const auto& rec : extract_all(file, reader, tells,
+                                               errorhandler)) {
+                if (not rec.error.empty()) continue;
+                try {
+                    std::size_t begin;
+                    frames += frames_in(rec.record, begin);
+                } catch (std::exception&) {}
+            }
+        }
+        return frames;
+    };
+
+    std::size_t next = 0;
+    while (next < indices.size()) {
+        /* phase 1: extract a chunk of records, and count their frames */
+        std::vector< slot > slots;
+        std::size_t bytes = 0;
+        std::size_t chunk_rows = 0;
+        while (next < indices.size() and bytes < fdata_chunk_bytes) {
+            const auto last = std::min(indices.size(), next + batch);
+            const std::vector< long long > tells(indices.begin() + next,
+                                                 indices.begin() + last);
+            next = last;
+
+            for (auto& rec : extract_all(file, reader, tells, errorhandler)) {
+                if (not rec.error.empty()) {
+                    handle(rec.error);
+                    continue;
+                }
+
+                slot s;
+                s.record = std::move(rec.record);
+                try {
+                    s.frames = frames_in(s.record, s.begin);
+                } catch (std::exception& e) {
+                    handle(e.what());
+                    continue;
+                }
+
+                chunk_rows += s.frames;
+                bytes += s.record.data.size();
+                slots.push_back(std::move(s));
+            }
+        }
+
+        if (not dstobj)
+            allocate(chunk_rows + count(next));
+
+        if (rows + chunk_rows > capacity) {
+            const auto msg = "read_fdata: the records have more frames ("
+                           + std::to_string(rows + chunk_rows)
+                           + ") than when they were counted ("
+                           + std::to_string(capacity)
+                           + ")";
+            throw std::runtime_error(msg);
+        }
+
+        /* phase 2: decode the records into their rows */
+        auto* dst = static_cast< unsigned char* >(info.ptr);
+        if (not layout.plain) {
+            /*
+             * Samples that are decoded to python objects can fail, e.g. a
+             * DTIME that is not a valid date, so the records are decoded one
+             * at a time, and a record that fails is skipped like in
+             * read_fdata: its rows are overwritten by the next record, and
+             * the rows that are left over are trimmed at the end
+             */
+            for (const auto& s : slots) {
+                const auto* begin = s.record.data.data();
+                const auto* ptr = begin + s.begin;
+                const auto* end = begin + s.record.data.size();
+                auto* row = dst + rows * itemsize;
+                try {
+                    while (ptr < end)
+                        read_fdata_row(fmt, ptr, end, row, itemsize, mode);
+                } catch (std::exception& e) {
+                    handle(e.what());
+                    continue;
+                }
+                rows += s.frames;
+            }
             continue;
         }
+
+        for (auto& s : slots) {
+            s.row = rows;
+            rows += s.frames;
+        }
+
+        const auto decode = [&](const slot& s) {
+            const auto* begin = s.record.data.data();
+            decode_frames(fmt,
+                          layout,
+                          begin + s.begin,
+                          begin + s.record.data.size(),
+                          dst + s.row * itemsize,
+                          itemsize);
+        };
+
+        const auto nthreads = fdata_threads(threads, slots.size(), bytes);
+        if (nthreads <= 1) {
+            for (const auto& s : slots) decode(s);
+            continue;
+        }
+
+        py::gil_scoped_release nogil;
+        std::atomic< std::size_t > work_next{ 0 };
+        const auto work = [&]() {
+            while (true) {
+                const auto i = work_next.fetch_add(1);
+                if (i >= slots.size()) return;
+                decode(slots[i]);
+            }
+        };
+
+        dl::stats::add(dl::stats::workers, nthreads - 1);
+        std::vector< std::thread > pool;
+        for (int i = 1; i < nthreads; ++i)
+            pool.emplace_back(work);
+        work();
+        for (auto& t : pool) t.join();
+    }
+
+    dl::stats::add(dl::stats::frames, rows);
+
+    if (not dstobj)
+        allocate(rows);
+    else if (capacity != rows)
+        resize(rows);
+
+    info = py::buffer_info {};
+    dstb = py::buffer {};
+    return dstobj;
+}
+
+py::object read_fdata(const char* pre_fmt,
+                      const char* fmt,
+                      const char* post_fmt,
+                      dl::stream& file,
+                      const std::vector< long long >& indices,
+                      std::size_t itemsize,
+                      const curve_mode& mode,
+                      py::object alloc,
+                      dl::error_handler& errorhandler,
+                      int threads,
+                      const dl::batch_reader* reader)
+noexcept (false) {
+    dl::stats::timer timer(dl::stats::read_fdata);
+    assert_itemsize(fmt, itemsize, mode);
+
+    fdata_layout layout;
+    if (fixed_layout(fmt, itemsize, mode, layout)) {
+        return read_fdata_fixed(fmt, layout, file, indices, itemsize, mode,
+                                alloc, errorhandler, threads, reader);
+    }
+
+    // TODO: reverse fingerprint to skip bytes ahead-of-time
+    /*
+     * TODO: error has already been checked (in python), but should be more
+     * thorough
+     *
+     * TODO: veriy that format string is valid
+     */
+    /*
+     * This function goes through a lot of ceremony to use numpy arrays
+     * directly, and to write output data in-place in the return value. The
+     * main reason is *exception safety*.
+     *
+     * Virtually every operation that goes into this can throw an exception,
+     * and when that happens it's important that not-yet-complete data is
+     * cleaned up.
+     *
+     * Of course, for all non-object types this is not a problem, as they're
+     * just bytes in an array, and std::vector would've been plenty. It's made
+     * more complicated by the presence of PyObject* pointers embedded in the
+     * data stream - there are no C++ destructors that can elegantly reach
+     * them, and doing that would pretty much be replicating numpy
+     * functionality anyway.
+     *
+     * By writing directly into the numpy array as we go, PyObjects are either
+     * default-constructed (set to None) by numpy, or properly created (and
+     * replaced) here.
+     */
+    auto allocated_rows = indices.size();
+    auto dstobj = alloc(allocated_rows);
+    auto dstb = py::buffer(dstobj);
+    auto info = dstb.request(true);
+    auto* dst = static_cast< unsigned char* >(info.ptr);
+
+    /*
+     * Resizing is clumsy, because in-place resize (through the method)
+     * requires there to be no references to the underlying data. That means
+     * the buffer-info and buffer must be wiped before resizing takes place,
+     * and then carefully restored to the new memory.
+     */
+    auto resize = [&](std::size_t n) {
+        info = py::buffer_info {};
+        dstb = py::buffer {};
+        dstobj.attr("resize")(n);
+        allocated_rows = n;
+        dstb = py::buffer(dstobj);
+        info = dstb.request(true);
+        dst = static_cast< unsigned char* >(info.ptr);
+    };
+
+
+    /*
+     * The frameno is a part of the dtype, and only frame.channels is allowed
+     * to call this function. If pre/post format is set, wrong data is read.
+     *
+     * The interface is not changed for now as they're to be reintroduced at
+     * some point.
+     */
+    assert(std::string(pre_fmt) == "");
+    assert(std::string(post_fmt) == "");
+
+    int frames = 0;
+    int record_frames = 0;
+
+    const auto handle = [&]( const std::string& problem ) {
+        const auto context = "dl::read_fdata: reading curves";
+        errorhandler.log(dl::error_severity::CRITICAL, context, problem, "",
+                         "Record is skipped");
+        // we update the buffer as we go. Hence if error happened we need to
+        // go back and start rewriting updated data. The buffer may have been
+        // resized since the record started, so go by row
+        frames = record_frames;
+        dst = static_cast< unsigned char* >(info.ptr) + frames * itemsize;
+    };
+
+    /*
+     * With a batch reader, records are read a batch at a time, otherwise
+     * one at a time, so that only a few records are in memory at once
+     */
+    const std::size_t batch = reader ? 64 * std::size_t(reader->depth()) : 1;
+    for (std::size_t first = 0; first < indices.size(); first += batch) {
+        const auto last = std::min(indices.size(), first + batch);
+        const std::vector< long long > tells(indices.begin() + first,
+                                             indices.begin() + last);
+
+        for (const auto& rec : extract_all(file, reader, tells, errorhandler)) {
+            record_frames = frames;
+
+            if (not rec.error.empty()) {
+                handle(rec.error);
+                continue;
+            }
+
+            const auto& record = rec.record;
+            if (record.isencrypted()) {
+                handle("encrypted FDATA record");
+                continue;
+            }
+
+            const auto* ptr = record.data.data();
+            const auto* end = ptr + record.data.size();
+
+            /* read fingerprint */
+            std::int32_t origin;
+            std::uint8_t copy;
+            ptr = dlis_obname(ptr, &origin, &copy, nullptr, nullptr);
+
+            try {
+                read_fdata_record(pre_fmt, fmt, post_fmt, ptr, end, dst,
+                                  frames, itemsize, allocated_rows, resize,
+                                  mode);
+            } catch (std::exception& e) {
+                handle(e.what());
+                continue;
+            }
+        }
     }
 
     assert(allocated_rows >= frames);
     if (allocated_rows > frames)
         resize(frames);
 
+    dl::stats::add(dl::stats::frames, frames);
+
     return dstobj;
 }
 
+/*
+ * read_fdata, but only from the records that may contain frames in [first,
+ * last], as given by the first frame number of every record (see
+ * dl::indexfdata). The records are found by binary search, and may contain
+ * frames outside the range - it is up to the caller to filter on FRAMENO.
+ */
+py::object read_fdata_frames(const char* pre_fmt,
+                             const char* fmt,
+                             const char* post_fmt,
+                             dl::stream& file,
+                             const std::vector< long long >& indices,
+                             const std::vector< std::int32_t >& framenos,
+                             std::int32_t first,
+                             std::int32_t last,
+                             std::size_t itemsize,
+                             const curve_mode& mode,
+                             py::object alloc,
+                             dl::error_handler& errorhandler,
+                             int threads,
+                             const dl::batch_reader* reader)
+noexcept (false) {
+    if (indices.size() != framenos.size()) {
+        const auto msg = "read_fdata: expected len(indices) ("
+                       + std::to_string(indices.size())
+                       + ") == len(framenos) ("
+                       + std::to_string(framenos.size())
+                       + ")";
+        throw std::invalid_argument(msg);
+    }
+
+    std::vector< dl::fdata_record > recs;
+    recs.reserve(indices.size());
+    for (std::size_t i = 0; i < indices.size(); ++i)
+        recs.push_back({ indices[i], framenos[i] });
+
+    const auto tells = dl::findframes(recs, first, last);
+    return read_fdata(pre_fmt, fmt, post_fmt, file, tells, itemsize, mode,
+                      alloc, errorhandler, threads, reader);
+}
+
+/*
+ * Number of frames in [ptr, end) for any format, or throws if the format is
+ * invalid or the last frame is truncated
+ */
+std::size_t count_frames(const char* fmt, const char* ptr, const char* end)
+noexcept (false) {
+    std::size_t frames = 0;
+    while (ptr < end) {
+        int src_skip;
+        const auto err = dlis_packflen(fmt, ptr, &src_skip, nullptr);
+        if (err != DLIS_OK)
+            throw std::runtime_error("invalid format string");
+        assert_overflow(ptr, end, src_skip);
+        ptr += src_skip;
+        ++frames;
+    }
+    return frames;
+}
+
+/*
+ * A single frame in read_fdata_many, with the curve mode its dtype was made
+ * with
+ */
+struct fdata_job {
+    std::string fmt;
+    std::vector< long long > indices;
+    std::size_t itemsize;
+    curve_mode mode;
+    py::object alloc;
+};
+
+/*
+ * Read all curves of many frames at once
+ *
+ * Reading the frames one by one means a pass over the file per frame, and the
+ * FDATA records of different frames are usually interleaved. Instead, the
+ * records of all the frames are extracted in a single pass in file order.
+ *
+ * Like in read_fdata_fixed, the records are extracted and decoded a chunk at
+ * a time, so only a bounded number of records are in memory at once. Every
+ * output array is allocated when the first chunk with frames for it is
+ * counted, grown geometrically when needed, and trimmed at the end.
+ *
+ * The records of a chunk are decoded by a pool of threads without the GIL,
+ * one record at a time, while the calling thread decodes the frames with
+ * python objects. Whether a frame has python objects is given by its format
+ * and curve mode, so the pool never makes python objects. A record that
+ * fails to decode is skipped like in read_fdata, and the records of the
+ * other frames are unaffected.
+ */
+py::list read_fdata_many(std::vector< fdata_job >& jobs,
+                         dl::stream& file,
+                         dl::error_handler& errorhandler,
+                         int threads,
+                         const dl::batch_reader* reader)
+noexcept (false) {
+    dl::stats::timer timer(dl::stats::read_fdata);
+    const auto handle = [&]( const std::string& problem ) {
+        const auto context = "dl::read_fdata: reading curves";
+        errorhandler.log(dl::error_severity::CRITICAL, context, problem, "",
+                         "Record is skipped");
+    };
+
+    struct slot {
+        dl::record record;
+        std::size_t job;
+        std::size_t begin; /* offset of the first frame in record.data */
+        std::size_t frames;
+        std::size_t row;
+        bool failed;
+        std::string error; /* set by the pool, reported by the caller */
+    };
+
+    struct output {
+        py::object obj;
+        py::buffer buffer;
+        py::buffer_info info;
+        std::size_t capacity = 0;
+        std::size_t rows = 0;
+    };
+
+    std::vector< fdata_layout > layouts(jobs.size());
+    std::vector< char > fixed(jobs.size());
+    std::vector< char > hasobject(jobs.size());
+    std::vector< std::pair< long long, std::size_t > > tells;
+    for (std::size_t j = 0; j < jobs.size(); ++j) {
+        const auto& job = jobs[j];
+        const auto* fmt = job.fmt.c_str();
+        assert_itemsize(fmt, job.itemsize, job.mode);
+        fixed[j] = fixed_layout(fmt, job.itemsize, job.mode, layouts[j]);
+        hasobject[j] = object_frame(fmt, job.mode);
+        for (const auto tell : job.indices)
+            tells.emplace_back(tell, j);
+    }
+    std::sort(tells.begin(), tells.end());
+
+    std::vector< output > outputs(jobs.size());
+
+    const auto allocate = [&](std::size_t j, std::size_t n) {
+        auto& out = outputs[j];
+        out.obj = jobs[j].alloc(n);
+        out.buffer = py::buffer(out.obj);
+        out.info = out.buffer.request(true);
+        out.capacity = n;
+    };
+
+    /* see read_fdata for why resizing is this clumsy */
+    const auto resize = [&](std::size_t j, std::size_t n) {
+        auto& out = outputs[j];
+        out.info = py::buffer_info {};
+        out.buffer = py::buffer {};
+        out.obj.attr("resize")(n);
+        out.buffer = py::buffer(out.obj);
+        out.info = out.buffer.request(true);
+        out.capacity = n;
+    };
+
+    const auto decode = [&](const slot& s, unsigned char* dst) {
+        const auto& job = jobs[s.job];
+        const auto* fmt = job.fmt.c_str();
+        const auto* begin = s.record.data.data();
+        const auto* ptr = begin + s.begin;
+        const auto* end = begin + s.record.data.size();
+
+        if (fixed[s.job] and layouts[s.job].plain) {
+            decode_frames(fmt, layouts[s.job], ptr, end, dst, job.itemsize);
+            return;
+        }
+
+        while (ptr < end)
+            read_fdata_row(fmt, ptr, end, dst, job.itemsize, job.mode);
+    };
+
+    const std::size_t batch = reader ? 64 * std::size_t(reader->depth()) : 1;
+    std::size_t next = 0;
+    while (next < tells.size()) {
+        /* phase 1: extract a chunk of records in file order, count frames */
+        std::vector< slot > slots;
+        std::vector< std::size_t > chunk_rows(jobs.size(), 0);
+        std::size_t bytes = 0;
+        while (next < tells.size() and bytes < fdata_chunk_bytes) {
+            const auto first = next;
+            const auto last = std::min(tells.size(), next + batch);
+            std::vector< long long > offsets;
+            for (auto i = first; i < last; ++i)
+                offsets.push_back(tells[i].first);
+            next = last;
+
+            auto recs = extract_all(file, reader, offsets, errorhandler);
+            for (std::size_t i = 0; i < recs.size(); ++i) {
+                if (not recs[i].error.empty()) {
+                    handle(recs[i].error);
+                    continue;
+                }
+
+                slot s;
+                s.job = tells[first + i].second;
+                s.record = std::move(recs[i].record);
+                s.failed = false;
+
+                if (s.record.isencrypted()) {
+                    handle("encrypted FDATA record");
+                    continue;
+                }
+
+                const auto* begin = s.record.data.data();
+                const auto* end = begin + s.record.data.size();
+
+                std::int32_t origin;
+                std::uint8_t copy;
+                const auto* ptr = dlis_obname(begin, &origin, &copy,
+                                              nullptr, nullptr);
+
+                const auto& job = jobs[s.job];
+                try {
+                    s.frames = fixed[s.job]
+                             ? count_frames(layouts[s.job], ptr, end)
+                             : count_frames(job.fmt.c_str(), ptr, end);
+                } catch (std::exception& e) {
+                    handle(e.what());
+                    continue;
+                }
+
+                s.begin = ptr - begin;
+                chunk_rows[s.job] += s.frames;
+                bytes += s.record.data.size();
+                slots.push_back(std::move(s));
+            }
+        }
+
+        /* make room for the rows of this chunk */
+        std::vector< std::size_t > start(jobs.size());
+        for (std::size_t j = 0; j < jobs.size(); ++j) {
+            auto& out = outputs[j];
+            start[j] = out.rows;
+            const auto needed = out.rows + chunk_rows[j];
+            if (not out.obj) {
+                if (needed == 0) continue;
+                const auto estimate = next == tells.size()
+                                    ? needed
+                                    : needed * tells.size() / next;
+                allocate(j, estimate);
+            } else if (needed > out.capacity) {
+                resize(j, std::max(needed, 2 * out.capacity));
+            }
+        }
+
+        std::vector< unsigned char* > dsts;
+        for (const auto& out : outputs)
+            dsts.push_back(static_cast< unsigned char* >(out.info.ptr));
+
+        /*
+         * phase 2: decode records into their rows. The pooled records get
+         * their rows up front, the records with objects as they are decoded
+         */
+        std::vector< std::size_t > pooled;
+        std::vector< std::size_t > objects;
+        std::size_t pooled_bytes = 0;
+        for (std::size_t i = 0; i < slots.size(); ++i) {
+            auto& s = slots[i];
+            auto& out = outputs[s.job];
+            if (hasobject[s.job]) {
+                objects.push_back(i);
+            } else {
+                s.row = out.rows;
+                out.rows += s.frames;
+                pooled.push_back(i);
+                pooled_bytes += s.record.data.size();
+            }
+        }
+
+        std::atomic< std::size_t > work_next{ 0 };
+        std::exception_ptr failure;
+        std::mutex failure_lock;
+        const auto work = [&]() {
+            try {
+                while (true) {
+                    const auto i = work_next.fetch_add(1);
+                    if (i >= pooled.size()) return;
+                    auto& s = slots[pooled[i]];
+                    const auto itemsize = jobs[s.job].itemsize;
+                    try {
+                        decode(s, dsts[s.job] + s.row * itemsize);
+                    } catch (std::exception& e) {
+                        s.failed = true;
+                        s.error = e.what();
+                    }
+                }
+            } catch (...) {
+                std::lock_guard< std::mutex > lock(failure_lock);
+                if (not failure) failure = std::current_exception();
+                work_next = pooled.size();
+            }
+        };
+
+        const auto nthreads = fdata_threads(threads,
+                                            pooled.size(),
+                                            pooled_bytes);
+        dl::stats::add(dl::stats::workers, nthreads - 1);
+        std::vector< std::thread > pool;
+        for (int i = 1; i < nthreads; ++i)
+            pool.emplace_back(work);
+
+        /*
+         * The pool does not need the GIL, so the calling thread can decode
+         * the frames with python objects while the pool is running. A record
+         * that fails has its rows overwritten by the next record of the frame
+         */
+        try {
+            for (const auto i : objects) {
+                const auto& s = slots[i];
+                auto& out = outputs[s.job];
+                const auto itemsize = jobs[s.job].itemsize;
+                try {
+                    decode(s, dsts[s.job] + out.rows * itemsize);
+                } catch (std::exception& e) {
+                    handle(e.what());
+                    continue;
+                }
+                out.rows += s.frames;
+            }
+        } catch (...) {
+            work_next = pooled.size();
+            for (auto& t : pool) t.join();
+            throw;
+        }
+
+        {
+            py::gil_scoped_release nogil;
+            work();
+            for (auto& t : pool) t.join();
+        }
+
+        if (failure) std::rethrow_exception(failure);
+
+        /*
+         * Report the pooled records that failed, and move the rows of the
+         * records after them up to close the gap
+         */
+        auto rows = start;
+        for (const auto i : pooled) {
+            const auto& s = slots[i];
+            if (s.failed) {
+                handle(s.error);
+                continue;
+            }
+
+            const auto itemsize = jobs[s.job].itemsize;
+            auto& row = rows[s.job];
+            if (row != s.row) {
+                std::memmove(dsts[s.job] + row * itemsize,
+                             dsts[s.job] + s.row * itemsize,
+                             s.frames * itemsize);
+            }
+            row += s.frames;
+        }
+
+        for (std::size_t j = 0; j < jobs.size(); ++j) {
+            if (not hasobject[j])
+                outputs[j].rows = rows[j];
+        }
+    }
+
+    py::list arrays;
+    for (std::size_t j = 0; j < jobs.size(); ++j) {
+        auto& out = outputs[j];
+        dl::stats::add(dl::stats::frames, out.rows);
+
+        if (not out.obj)
+            allocate(j, out.rows);
+        else if (out.capacity != out.rows)
+            resize(j, out.rows);
+
+        out.info = py::buffer_info {};
+        out.buffer = py::buffer {};
+        arrays.append(out.obj);
+    }
+    return arrays;
+}
+
+/*
+ * Streaming cursor over the frames of a frame type
+ *
+ * read() decodes the next frames into a caller-provided buffer, so that a
+ * frame of any size can be processed in constant memory by reusing the same
+ * buffer for every chunk. Only a single record is held at a time.
+ *
+ * Like read_fdata, a record that fails to decode is skipped in its entirety.
+ * Since frames from a record may span several chunks, records are validated
+ * (the frames are walked with dlis_packflen) when they are loaded, before
+ * any of their frames are decoded.
+ */
+class fdata_cursor {
+public:
+    fdata_cursor(const std::string& fmt,
+                 dl::stream& file,
+                 const std::vector< long long >& indices,
+                 std::size_t itemsize,
+                 const curve_mode& mode,
+                 dl::error_handler& errorhandler)
+        : fmt(fmt)
+        , file(file)
+        , indices(indices)
+        , itemsize(itemsize)
+        , mode(mode)
+        , errorhandler(errorhandler)
+    {
+        assert_itemsize(this->fmt.c_str(), itemsize, mode);
+    }
+
+    /*
+     * Decode up to len(dst) frames into dst, and return the number of frames
+     * decoded. Returns 0 when all frames have been read.
+     */
+    std::size_t read(py::buffer dstb) noexcept (false);
+
+private:
+    std::string fmt;
+    dl::stream& file;
+    std::vector< long long > indices;
+    std::size_t itemsize;
+    curve_mode mode;
+    dl::error_handler& errorhandler;
+
+    std::size_t next = 0;
+    dl::record record;
+    std::size_t pos = 0;
+
+    bool exhausted() const noexcept (true) {
+        return this->pos >= this->record.data.size();
+    }
+
+    void load_record() noexcept (false);
+};
+
+void fdata_cursor::load_record() noexcept (false) {
+    const auto handle = [&]( const std::string& problem ) {
+        const auto context = "dl::fdata_cursor: reading curves";
+        errorhandler.log(dl::error_severity::CRITICAL, context, problem, "",
+                         "Record is skipped");
+    };
+
+    while (this->exhausted() and this->next < this->indices.size()) {
+        const auto tell = this->indices[this->next++];
+        this->record.data.clear();
+        this->pos = 0;
+
+        try {
+            /* re-use the record, so its buffer is only grown, never freed */
+            const auto all = std::numeric_limits< std::int64_t >::max();
+            dl::extract(this->file, tell, all, this->record,
+                        this->errorhandler, verify_checksums);
+        } catch (std::exception& e) {
+            this->record.data.clear();
+            handle(e.what());
+            continue;
+        }
+
+        if (this->record.isencrypted()) {
+            this->record.data.clear();
+            handle("encrypted FDATA record");
+            continue;
+        }
+
+        const auto* begin = this->record.data.data();
+        const auto* end = begin + this->record.data.size();
+
+        std::int32_t origin;
+        std::uint8_t copy;
+        const auto* ptr = dlis_obname(begin, &origin, &copy, nullptr, nullptr);
+        this->pos = ptr - begin;
+
+        try {
+            count_frames(this->fmt.c_str(), ptr, end);
+        } catch (std::exception& e) {
+            this->record.data.clear();
+            this->pos = 0;
+            handle(e.what());
+            continue;
+        }
+    }
+}
+
+std::size_t fdata_cursor::read(py::buffer dstb) noexcept (false) {
+    auto info = dstb.request(true);
+    if (std::size_t(info.itemsize) != this->itemsize) {
+        const auto msg = "fdata_cursor: expected buffer.itemsize == "
+                       + std::to_string(this->itemsize)
+                       + ", was "
+                       + std::to_string(info.itemsize);
+        throw std::invalid_argument(msg);
+    }
+
+    auto* dst = static_cast< unsigned char* >(info.ptr);
+    const auto capacity = std::size_t(info.size);
+
+    std::size_t frames = 0;
+    while (frames < capacity) {
+        this->load_record();
+        if (this->exhausted()) break;
+
+        const auto* begin = this->record.data.data();
+        const auto* ptr = begin + this->pos;
+        const auto* end = begin + this->record.data.size();
+
+        while (ptr < end and frames < capacity) {
+            read_fdata_row(this->fmt.c_str(), ptr, end, dst,
+                           this->itemsize, this->mode);
+            ++frames;
+        }
+
+        this->pos = ptr - begin;
+    }
+
+    return frames;
+}
+
 /** trampoline helper class for dl::matcher bindings
  *
  * Creating the binding code for a abstract c++ class that we want do derive
@@ -806,6 +2228,106 @@ public:
     }
 };
 
+
+/*
+ * numpy views of attribute values
+ *
+ * The numeric attribute values are stored as a vector of the underlying
+ * number type (or a strong typedef of it), so the vector can be exposed to
+ * numpy as-is, without going through a python list. The validated types
+ * (fsing1 etc) are views with the shape (n, 2) or (n, 3).
+ *
+ * Types without an array_traits specialisation are not viewable.
+ */
+template < typename T >
+struct array_traits {
+    static constexpr bool viewable = false;
+};
+
+template < typename T, typename Base, int Width = 1 >
+struct viewable_as {
+    static_assert(sizeof(T) == Width * sizeof(Base),
+                  "viewable type must be an array of its base type");
+    static constexpr bool viewable = true;
+    static constexpr int width = Width;
+    using base = Base;
+};
+
+template <> struct array_traits< dl::fshort > : viewable_as< dl::fshort, float > {};
+template <> struct array_traits< dl::isingl > : viewable_as< dl::isingl, float > {};
+template <> struct array_traits< dl::vsingl > : viewable_as< dl::vsingl, float > {};
+template <> struct array_traits< dl::uvari  > : viewable_as< dl::uvari,  std::int32_t > {};
+template <> struct array_traits< dl::origin > : viewable_as< dl::origin, std::int32_t > {};
+template <> struct array_traits< dl::fsingl > : viewable_as< dl::fsingl, float > {};
+template <> struct array_traits< dl::fdoubl > : viewable_as< dl::fdoubl, double > {};
+template <> struct array_traits< dl::csingl > : viewable_as< dl::csingl, dl::csingl > {};
+template <> struct array_traits< dl::cdoubl > : viewable_as< dl::cdoubl, dl::cdoubl > {};
+template <> struct array_traits< dl::sshort > : viewable_as< dl::sshort, dl::sshort > {};
+template <> struct array_traits< dl::snorm  > : viewable_as< dl::snorm,  dl::snorm > {};
+template <> struct array_traits< dl::slong  > : viewable_as< dl::slong,  dl::slong > {};
+template <> struct array_traits< dl::ushort > : viewable_as< dl::ushort, dl::ushort > {};
+template <> struct array_traits< dl::unorm  > : viewable_as< dl::unorm,  dl::unorm > {};
+template <> struct array_traits< dl::ulong  > : viewable_as< dl::ulong,  dl::ulong > {};
+template <> struct array_traits< dl::fsing1 > : viewable_as< dl::fsing1, float,  2 > {};
+template <> struct array_traits< dl::fsing2 > : viewable_as< dl::fsing2, float,  3 > {};
+template <> struct array_traits< dl::fdoub1 > : viewable_as< dl::fdoub1, double, 2 > {};
+template <> struct array_traits< dl::fdoub2 > : viewable_as< dl::fdoub2, double, 3 > {};
+
+struct attribute_view {
+    /* owner of the vector, kept alive by the array */
+    py::handle owner;
+
+    template < typename T >
+    typename std::enable_if< array_traits< T >::viewable, py::object >::type
+    operator () (const std::vector< T >& xs) const noexcept (false) {
+        using base = typename array_traits< T >::base;
+        constexpr auto width = array_traits< T >::width;
+        const auto* ptr = reinterpret_cast< const base* >(xs.data());
+
+        std::vector< py::ssize_t > shape = { py::ssize_t(xs.size()) };
+        if (width > 1) shape.push_back(width);
+
+        /*
+         * The array is a read-only view of the attribute, since the attribute
+         * is shared between all lookups of the same object
+         */
+        auto array = py::array_t< base >(shape, ptr, this->owner);
+        py::detail::array_proxy(array.ptr())->flags &=
+            ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+        return std::move(array);
+    }
+
+    template < typename T >
+    typename std::enable_if< not array_traits< T >::viewable, py::object >::type
+    operator () (const T&) const noexcept (true) {
+        return py::none();
+    }
+};
+
+/*
+ * The output of dl::indexfdata as two dicts, {frame: tells} and {frame: first
+ * frame numbers}, so that the tells can be used just like the output of
+ * findfdata
+ */
+py::tuple fdata_index(
+    const std::map< dl::ident, std::vector< dl::fdata_record > >& index)
+noexcept (false) {
+    py::dict records;
+    py::dict framenos;
+    for (const auto& frame : index) {
+        py::list xs;
+        py::list ys;
+        for (const auto& rec : frame.second) {
+            xs.append(rec.tell);
+            ys.append(rec.frameno);
+        }
+        const auto key = py::cast(frame.first);
+        records[key] = xs;
+        framenos[key] = ys;
+    }
+    return py::make_tuple(records, framenos);
+}
+
 }
 
 PYBIND11_MAKE_OPAQUE( std::vector< dl::object_set > )
@@ -828,12 +2350,86 @@ PYBIND11_MODULE(core, m) {
     py::bind_vector<std::vector< dl::object_set >>(m, "list(object_set)");
 
     m.def("open", &dl::open, py::arg("path"), py::arg("zero") = 0);
-    m.def("open_rp66", &dl::open_rp66);
-    m.def("open_tif", &dl::open_tapeimage);
+    m.def("open_buffer", [](py::buffer b, std::int64_t zero) {
+        /*
+         * The stream reads the buffer in-place, so the buffer object is kept
+         * alive for as long as the stream is, and the streams opened on top
+         * of it keep it alive in turn. Give a memoryview to also pin the
+         * memory of e.g. a bytearray or mmap while the stream is open
+         */
+        const auto info = b.request();
+        const auto* data = static_cast< const char* >( info.ptr );
+        const auto size = std::size_t( info.size * info.itemsize );
+        return dl::open_memory( data, size, zero );
+    }, py::arg("buffer"), py::arg("zero") = 0, py::keep_alive< 0, 1 >());
+    m.def("open_rp66", &dl::open_rp66, py::keep_alive< 0, 1 >());
+    m.def("open_tif", &dl::open_tapeimage, py::keep_alive< 0, 1 >());
 
     m.def( "storage_label", storage_label );
     m.def("fingerprint", fingerprint);
-    m.def("read_fdata", read_fdata);
+    py::class_< curve_mode >( m, "curve_mode" )
+        .def( py::init<>() )
+        .def_readonly( "native", &curve_mode::native )
+        .def_readonly( "ident_bytes", &curve_mode::ident_bytes )
+        .def_readonly( "big_endian", &curve_mode::big_endian )
+    ;
+    m.def("read_fdata", read_fdata,
+        py::arg("pre_fmt"),
+        py::arg("fmt"),
+        py::arg("post_fmt"),
+        py::arg("file"),
+        py::arg("indices"),
+        py::arg("itemsize"),
+        py::arg("mode"),
+        py::arg("alloc"),
+        py::arg("errorhandler"),
+        py::arg("threads") = 0,
+        py::arg("reader") = nullptr
+    );
+    py::class_< fdata_job >( m, "fdata_job" )
+        .def(py::init([](std::string fmt,
+                         std::vector< long long > indices,
+                         std::size_t itemsize,
+                         const curve_mode& mode,
+                         py::object alloc) {
+            return fdata_job{ std::move(fmt),
+                              std::move(indices),
+                              itemsize,
+                              mode,
+                              std::move(alloc) };
+        }),
+            py::arg("fmt"),
+            py::arg("indices"),
+            py::arg("itemsize"),
+            py::arg("mode"),
+            py::arg("alloc")
+        )
+    ;
+
+    m.def("read_fdata_many", read_fdata_many,
+        py::arg("jobs"),
+        py::arg("file"),
+        py::arg("errorhandler"),
+        py::arg("threads") = 0,
+        py::arg("reader") = nullptr
+    );
+
+    m.def("read_fdata", read_fdata_frames,
+        py::arg("pre_fmt"),
+        py::arg("fmt"),
+        py::arg("post_fmt"),
+        py::arg("file"),
+        py::arg("indices"),
+        py::arg("framenos"),
+        py::arg("first"),
+        py::arg("last"),
+        py::arg("itemsize"),
+        py::arg("mode"),
+        py::arg("alloc"),
+        py::arg("errorhandler"),
+        py::arg("threads") = 0,
+        py::arg("reader") = nullptr
+    );
 
     /*
      * TODO: support constructor with kwargs
@@ -942,6 +2538,10 @@ PYBIND11_MODULE(core, m) {
         .def_readonly("value", &dl::object_attribute::value)
         .def_readonly("units", &dl::object_attribute::units)
         .def_readonly("log",   &dl::object_attribute::log)
+        .def_property_readonly("array", []( py::object self ) {
+            const auto& attr = self.cast< const dl::object_attribute& >();
+            return mpark::visit(attribute_view{ self }, attr.value);
+        })
     ;
 
     py::class_< dl::basic_object >( m, "basic_object" )
@@ -953,10 +2553,11 @@ PYBIND11_MODULE(core, m) {
         })
         .def( "__eq__", &dl::basic_object::operator == )
         .def( "__ne__", &dl::basic_object::operator != )
-        .def( "__getitem__", []( dl::basic_object& o, const std::string& key ) {
+        .def( "__getitem__", []( dl::basic_object& o, const std::string& key )
+            -> const dl::object_attribute& {
             try { return o.at(key); }
             catch (const std::out_of_range& e) { throw py::key_error( e.what() ); }
-        })
+        }, py::return_value_policy::reference_internal)
         .def( "__repr__", []( const dl::basic_object& o ) {
             return "dlisio.core.basic_object(name={})"_s
                     .format(o.object_name);
@@ -984,12 +2585,12 @@ PYBIND11_MODULE(core, m) {
             const std::string&,
             const dl::matcher&,
             const dl::error_handler&
-        )) &dl::pool::get )
+        ) const) &dl::pool::get )
         .def( "get", (dl::object_vector (dl::pool::*) (
             const std::string&,
             const dl::matcher&,
             const dl::error_handler&
-        )) &dl::pool::get )
+        ) const) &dl::pool::get )
     ;
 
     py::enum_< dl::representation_code >( m, "reprc" )
@@ -1040,6 +2641,66 @@ PYBIND11_MODULE(core, m) {
         })
     ;
 
+    /*
+     * record_view exposes the same buffer as record, but the memory is owned
+     * by the source (memory_file) for single-segment records
+     */
+    py::class_< dl::record_view >( m, "record_view", py::buffer_protocol() )
+        .def_property_readonly( "explicit",  &dl::record_view::isexplicit )
+        .def_property_readonly( "encrypted", &dl::record_view::isencrypted )
+        .def_readonly( "consistent", &dl::record_view::consistent )
+        .def_readonly( "type", &dl::record_view::type )
+        .def_buffer( []( dl::record_view& rec ) -> py::buffer_info {
+            const auto fmt = py::format_descriptor< char >::format();
+            return py::buffer_info(
+                const_cast< char* >( rec.data() ),
+                sizeof(char),
+                fmt,
+                1,
+                { rec.size() },
+                { 1 }
+            );
+        })
+    ;
+
+    py::class_< dl::memory_file >( m, "memory_file" )
+        .def( py::init( []( py::buffer b, long long offset ) {
+            /*
+             * The buffer is held (and not just the object) for as long as
+             * any record_view refers to it, so that e.g. an mmap cannot be
+             * closed underneath the views
+             */
+            auto info = std::make_shared< py::buffer_info >( b.request() );
+            if (offset < 0 || offset > info->size) {
+                std::string msg =
+                      "expected 0 <= offset (which is "
+                    + std::to_string( offset ) + ") <= buffer.size "
+                    + "(which is " + std::to_string( info->size ) + ")"
+                ;
+                throw std::out_of_range( msg );
+            }
+
+            const auto* data = static_cast< const char* >( info->ptr );
+            const auto size = std::size_t( info->size - offset );
+            return dl::memory_file( data + offset, size, info );
+        }), py::arg("buffer"), py::arg("offset") = 0 )
+    ;
+
+    py::class_< dl::vr_index >( m, "vr_index" )
+        .def_property_readonly( "end", &dl::vr_index::end )
+        .def( "__len__", &dl::vr_index::size )
+    ;
+
+    py::class_< dl::batch_reader >( m, "batch_reader" )
+        .def( py::init< const std::string&, dl::vr_index, int >(),
+            py::arg("path"),
+            py::arg("vrs"),
+            py::arg("depth") = 16
+        )
+        .def_property_readonly( "depth", &dl::batch_reader::depth )
+        .def( "close", &dl::batch_reader::close )
+    ;
+
     py::class_< dl::stream >( m, "stream" )
         .def_property_readonly("absolute_tell", &dl::stream::absolute_tell)
         .def("seek", &dl::stream::seek)
@@ -1069,7 +2730,7 @@ PYBIND11_MODULE(core, m) {
         for (auto tell : tells) {
             dl::record rec;
             try {
-                rec = dl::extract(s, tell, errorhandler);
+                rec = dl::extract(s, tell, errorhandler, verify_checksums);
             } catch (const std::exception& e) {
                 const auto context =
                     "dl::extract: Reading raw bytes from record";
@@ -1084,6 +2745,51 @@ PYBIND11_MODULE(core, m) {
         return recs;
     });
 
+    m.def( "extract", [](const dl::batch_reader& reader,
+                        const std::vector< long long >& tells,
+                        dl::error_handler& errorhandler) {
+        const auto all = std::numeric_limits< long long >::max();
+        std::vector< dl::record > recs;
+        recs.reserve( tells.size() );
+        for (auto& rec : reader.extract(tells, all, errorhandler,
+                                        verify_checksums)) {
+            if (not rec.error.empty()) {
+                const auto context =
+                    "dl::extract: Reading raw bytes from record";
+                errorhandler.log(dl::error_severity::CRITICAL, context,
+                                 rec.error, "", "Record is skipped");
+                continue;
+            }
+            if (rec.record.data.size() > 0) {
+                recs.push_back( std::move( rec.record ) );
+            }
+        }
+        return recs;
+    });
+
+    m.def( "extract", [](const dl::memory_file& f,
+                        const std::vector< long long >& tells,
+                        dl::error_handler& errorhandler) {
+        std::vector< dl::record_view > recs;
+        recs.reserve( tells.size() );
+        for (auto tell : tells) {
+            dl::record_view rec;
+            try {
+                rec = dl::extract(f, tell, errorhandler);
+            } catch (const std::exception& e) {
+                const auto context =
+                    "dl::extract: Reading raw bytes from record";
+                errorhandler.log(dl::error_severity::CRITICAL, context,
+                                 e.what(), "", "Record is skipped");
+                continue;
+            }
+            if (rec.size() > 0) {
+                recs.push_back( std::move( rec ) );
+            }
+        }
+        return recs;
+    });
+
     m.def( "parse_objects", []( const std::vector< dl::record >& recs,
                                 dl::error_handler& errorhandler ) {
         std::vector< dl::object_set > objects;
@@ -1105,15 +2811,98 @@ PYBIND11_MODULE(core, m) {
 
     m.def( "findsul", dl::findsul );
     m.def( "findvrl", dl::findvrl );
+    m.def( "resyncvrl", dl::resyncvrl,
+        py::arg("stream"),
+        py::arg("from"),
+        py::arg("chain") = 3
+    );
     m.def( "hastapemark", dl::hastapemark );
     m.def("findfdata", dl::findfdata);
+    py::class_< fdata_cursor >( m, "fdata_cursor" )
+        .def( py::init< const std::string&,
+                        dl::stream&,
+                        const std::vector< long long >&,
+                        std::size_t,
+                        const curve_mode&,
+                        dl::error_handler& >(),
+              py::keep_alive< 1, 3 >(),
+              py::keep_alive< 1, 7 >() )
+        .def( "read", &fdata_cursor::read )
+    ;
+
+    m.def("indexvalues", [](dl::stream& file,
+                            const std::vector< long long >& tells,
+                            char fmt,
+                            dl::error_handler& errorhandler) {
+        return dl::indexvalues(file, tells, fmt, errorhandler);
+    });
+    m.def("indexvalues", [](const dl::batch_reader& file,
+                            const std::vector< long long >& tells,
+                            char fmt,
+                            dl::error_handler& errorhandler) {
+        return dl::indexvalues(file, tells, fmt, errorhandler);
+    });
+    m.def("findindex", dl::findindex);
+    m.def("indexfdata", [](dl::stream& file,
+                           const std::vector< long long >& tells,
+                           dl::error_handler& errorhandler) {
+        return fdata_index(dl::indexfdata(file, tells, errorhandler));
+    });
+    m.def("indexfdata", [](const dl::batch_reader& file,
+                           const std::vector< long long >& tells,
+                           dl::error_handler& errorhandler) {
+        return fdata_index(dl::indexfdata(file, tells, errorhandler));
+    });
 
     m.def( "findoffsets", []( dl::stream& file,
                               dl::error_handler& errorhandler) {
-        const auto ofs = dl::findoffsets( file, errorhandler );
+        const auto ofs = dl::findoffsets( file,
+                                          errorhandler,
+                                          verify_checksums );
         return py::make_tuple( ofs.explicits, ofs.implicits, ofs.broken );
     });
 
+    m.def( "findoffsets_vr", []( dl::stream& file,
+                                 long long from,
+                                 dl::error_handler& errorhandler) {
+        long long end = -1;
+        dl::vr_index vrs;
+        const auto ofs = dl::findoffsets( file,
+                                          from,
+                                          end,
+                                          errorhandler,
+                                          verify_checksums,
+                                          &vrs );
+        return py::make_tuple( ofs.explicits,
+                               ofs.implicits,
+                               ofs.broken,
+                               end,
+                               vrs );
+    });
+
+    m.def( "findoffsets_vr", []( const std::string& path,
+                                 long long from,
+                                 dl::error_handler& errorhandler,
+                                 int shards ) {
+        long long end = -1;
+        dl::vr_index vrs;
+        const auto ofs = dl::findoffsets( path,
+                                          from,
+                                          end,
+                                          errorhandler,
+                                          shards,
+                                          verify_checksums,
+                                          &vrs );
+        return py::make_tuple( ofs.explicits,
+                               ofs.implicits,
+                               ofs.broken,
+                               end,
+                               vrs );
+    }, py::arg("path"),
+       py::arg("offset"),
+       py::arg("errorhandler"),
+       py::arg("shards") = 0);
+
     py::enum_< dl::error_severity >( m, "error_severity" )
         .value( "info",     dl::error_severity::INFO )
         .value( "minor",    dl::error_severity::MINOR )
@@ -1136,8 +2925,48 @@ PYBIND11_MODULE(core, m) {
         .def(py::init<>())
     ;
 
+    py::class_< dl::error_sink::problem >( m, "problem" )
+        .def_readonly( "severity",      &dl::error_sink::problem::severity )
+        .def_readonly( "context",       &dl::error_sink::problem::context )
+        .def_readonly( "problem",       &dl::error_sink::problem::problem )
+        .def_readonly( "specification",
+                       &dl::error_sink::problem::specification )
+        .def_readonly( "action",        &dl::error_sink::problem::action )
+        .def_readonly( "count",         &dl::error_sink::problem::count )
+        .def_readonly( "tells",         &dl::error_sink::problem::tells )
+    ;
+
+    py::class_< dl::error_sink, dl::error_handler >( m, "error_sink" )
+        .def(py::init< bool, std::size_t, std::size_t >(),
+            py::arg("raise_critical") = true,
+            py::arg("max_tells") = 64,
+            py::arg("max_problems") = 1024
+        )
+        .def("log",      &dl::error_sink::log)
+        .def("problems", &dl::error_sink::problems)
+        .def("clear",    &dl::error_sink::clear)
+        .def("count",    &dl::error_sink::count)
+        .def("__len__",  &dl::error_sink::size)
+    ;
+
     /* settings */
     m.def("set_encodings", set_encodings);
     m.def("get_encodings", get_encodings);
+    m.def("set_native_curves", set_native_curves);
+    m.def("get_native_curves", get_native_curves);
+    m.def("set_ident_bytes", set_ident_bytes);
+    m.def("get_ident_bytes", get_ident_bytes);
+    m.def("set_big_endian_curves", set_big_endian_curves);
+    m.def("get_big_endian_curves", get_big_endian_curves);
+    m.def("set_verify_checksums", set_verify_checksums);
+    m.def("get_verify_checksums", get_verify_checksums);
+    m.def("set_fdata_thread_bytes", set_fdata_thread_bytes);
+    m.def("get_fdata_thread_bytes", get_fdata_thread_bytes);
+    m.def("set_fdata_chunk_bytes", set_fdata_chunk_bytes);
+    m.def("get_fdata_chunk_bytes", get_fdata_chunk_bytes);
+
+    /* diagnostics */
+    m.def("stats", stats);
+    m.def("reset_stats", reset_stats);
 
 }
@@ -1,4 +1,5 @@
 import logging
+import weakref
 
 from collections import defaultdict, OrderedDict
 from io import StringIO
@@ -6,6 +7,7 @@ from io import StringIO
 from . import core
 from . import plumbing
 from . import settings
+from .dlisutils import framecache, manycurves
 
 class physicalfile(tuple):
     def __enter__(self):
@@ -95,12 +97,29 @@ class logicalfile(object):
     then the users responsibility of ensuring correctness for the custom class.
     """
 
-    def __init__(self, stream, object_pool, fdata_index, sul, error_handler):
+    def __init__(self, stream, object_pool, fdata_index, sul, error_handler,
+                 fdata_framenos = None, shared = None, reader = None):
         self.file = stream
+        # Concurrent reader of the records at known offsets, or None if they
+        # are read through file. See settings.io_depth
+        self.reader = reader
         self.object_pool = object_pool
         self.sul = sul
         self.fdata_index = fdata_index
+        # The frame number of the first frame in every record in fdata_index,
+        # or None if not indexed
+        self.fdata_framenos = fdata_framenos
+        # The index value of the first frame in every record, by frame. Only
+        # computed when needed
+        self.fdata_indexvalues = {}
         self.error_handler = error_handler
+        self.frame_cache = framecache(settings.frame_cache_size)
+        # The file cache entry that the pool and fdata index are shared with,
+        # if loaded with cache=True. The reference is released on close, or
+        # when the handle is garbage collected
+        self.shared = None
+        if shared is not None:
+            self.shared = weakref.finalize(self, shared.release)
 
         if 'UPDATE' in self.object_pool.types:
             msg = ('{} contains UPDATE-object(s) which changes other '
@@ -147,7 +166,12 @@ class logicalfile(object):
         statement, which will close the file for you. Calling methods on a
         previously-closed file will raise `IOError`.
         """
+        self.frame_cache.clear()
         self.file.close()
+        if self.reader is not None:
+            self.reader.close()
+        if self.shared is not None:
+            self.shared()
 
     def __repr__(self):
         try:
@@ -470,6 +494,66 @@ class logicalfile(object):
         raise ValueError(msg.format(type, name))
 
 
+    def read_all_frames(self, frames=None, strict=True, threads=0):
+        """Read the curves of many frames at once
+
+        Like calling :meth:`Frame.curves` for every frame, but the FDATA
+        records of all the frames are read together, in a single pass over the
+        file, and decoded by a pool of threads. For files with many frames
+        this is much faster than reading the frames one by one, as every
+        frame would otherwise be a pass over the file.
+
+        Parameters
+        ----------
+
+        frames : list of Frame, optional
+            The frames to read. Defaults to all frames in the logical file
+
+        strict : boolean, optional
+            See :meth:`Frame.curves`
+
+        threads : int, optional
+            Number of threads to decode with. The default (0) is the number
+            of cores
+
+        Returns
+        -------
+
+        curves : list of np.ndarray
+            The curves of every frame, in the same order as frames
+
+        Raises
+        ------
+
+        ValueError
+            If any of the frames has multiple channels with identical name,
+            origin and copynumber, and strict=True
+
+        Notes
+        -----
+
+        The records are read and decoded a bounded chunk at a time, but the
+        returned arrays hold the curves of all the frames. Use
+        :meth:`Frame.iter_curves` for frames that do not fit in memory.
+
+        Like :meth:`Frame.curves`, a record that fails to decode is reported
+        through the error handler and skipped, without affecting the other
+        records or frames.
+
+        Examples
+        --------
+
+        >>> for frame, curves in zip(f.frames, f.read_all_frames()):
+        ...     print(frame.name, curves.shape)
+        MAIN (5032,)
+        FAST (80512,)
+        """
+        if frames is None:
+            frames = self.frames
+
+        frames = list(frames)
+        return manycurves(self, frames, strict, threads)
+
     def describe(self, width=80, indent=''):
         """Printable summary of the logical file
 
@@ -1,4 +1,5 @@
-from . import core
+from . import core, settings
+from .cache import files as filecache, lfindex
 from .file import physicalfile, logicalfile
 from .errors import ErrorHandler
 
@@ -10,7 +11,8 @@ def open(path):
 
     Parameters
     ----------
-    path : str_like
+    path : str_like or buffer
+        A path, or a file that is already in memory, see dlisio.load
 
     Returns
     -------
@@ -20,9 +22,44 @@ def open(path):
     --------
     dlisio.load
     """
+    if isbuffer(path):
+        return core.open_buffer(memoryview(path))
     return core.open(str(path))
 
-def load(path, error_handler = None):
+def isbuffer(path):
+    """ For internal use.
+    True if path is an in-memory file, i.e. supports the buffer protocol,
+    rather than a path
+    """
+    try:
+        memoryview(path)
+    except TypeError:
+        return False
+    return True
+
+def batchreader(path, vrs):
+    """ For internal use.
+    A reader for concurrent reads of the logical file with the visible record
+    index vrs, or None if it is read through the file handle. See
+    dlisio.settings.io_depth. In-memory files are always read through the
+    file handle.
+    """
+    if vrs is None or settings.io_depth <= 0 or isbuffer(path):
+        return None
+    return core.batch_reader(path, vrs, settings.io_depth)
+
+def findoffsets(stream, path, offset, error_handler):
+    """ For internal use.
+    Index the logical file at offset on the raw file, in parallel shards if
+    asked for, see dlisio.settings.index_shards. In-memory files are always
+    indexed through the file handle.
+    """
+    if settings.index_shards == 1 or isbuffer(path):
+        return core.findoffsets_vr(stream, offset, error_handler)
+    return core.findoffsets_vr(str(path), offset, error_handler,
+                               settings.index_shards)
+
+def load(path, error_handler = None, resync = False, cache = False):
     """ Loads a file and returns one filehandle pr logical file.
 
     The dlis standard have a concept of logical files. A logical file is a
@@ -47,12 +84,38 @@ def load(path, error_handler = None):
     Parameters
     ----------
 
-    path : str_like
+    path : str_like or buffer
+            Path to the file, or the file itself, if it is already in memory.
+            Any contiguous object that supports the buffer protocol can be
+            used, e.g. bytes, bytearray, memoryview or mmap. The bytes are
+            read in-place, without copying them, and must not change while
+            the file is open. Bytearrays and mmaps are locked (cannot be
+            resized or closed) until the file is closed and released.
 
     error_handler : dlisio.errors.ErrorHandler, optional
             Error handling rules. Default rules will apply if none supplied.
             Handler will be added to all the logical files, so users may modify
-            the behavior at any time.
+            the behavior at any time. A dlisio.errors.ErrorCollector can be
+            given instead, to collect the errors rather than acting on them.
+
+    resync : bool, optional
+            By default, no more logical files are read after a logical file
+            that is broken, i.e. where the visible records or logical record
+            segments are corrupted. With resync, the rest of the file is
+            searched for the next sound visible record instead, and loading
+            resumes from there as a new logical file. This is a best-effort
+            recovery, and the recovered logical files may be partial.
+            Not supported for tapeimage (tif) files.
+
+    cache : bool, optional
+            Keep the index and metadata of the file in a process-wide cache,
+            and share them with other loads of the same file with
+            cache=True. Loading a cached file only opens new file handles,
+            which is much cheaper than indexing and parsing it again. The
+            cache is keyed by the canonical path, size and modification time
+            of the file, and bounded by dlisio.settings.file_cache_size.
+            Problems with the file are only reported to the error_handler of
+            the load that reads it first. Not supported for in-memory files.
 
     Examples
     --------
@@ -76,17 +139,42 @@ def load(path, error_handler = None):
     to be stored in tail. Use len(tail) to check how many extra logical files
     there are.
 
+    Load a file that is already in memory, e.g. fetched from object storage
+
+    >>> blob = bucket.get_object(key).read()
+    >>> with dlisio.load(blob) as files:
+    ...     for f in files:
+    ...         header = f.fileheader
+
     Returns
     -------
 
     dlis : dlisio.physicalfile(dlisio.logicalfile)
     """
-    if not error_handler:
+    if error_handler is None:
         error_handler = ErrorHandler()
 
+    if isbuffer(path):
+        path = memoryview(path)
+        if not path.contiguous:
+            raise ValueError('in-memory file must be contiguous')
+        if cache:
+            raise ValueError('in-memory files cannot be cached')
+    else:
+        path = str(path)
+
+    if cache:
+        key = filecache.key(path, resync)
+        shared = filecache.acquire(key)
+        if shared is not None:
+            return reopen(path, shared, error_handler)
+
     sulsize = 80
     tifsize = 12
-    lfs = []
+    streams = []
+    readers = []
+    indices = []
+    nbytes = 0
 
     def rewind(offset, tif):
         """Rewind offset to make sure not to miss VRL when calling findvrl"""
@@ -94,7 +182,6 @@ def load(path, error_handler = None):
         if tif: offset -= 12
         return offset
 
-    path = str(path)
     stream = open(path)
     try:
         offset = core.findsul(stream)
@@ -120,30 +207,79 @@ def load(path, error_handler = None):
         #
         # [1] rp66v1, 2.3.6 Record Structure Requirements:
         #     > ... Visible Records cannot intersect more than one Logical File.
+        #
+        # Files without tapemarks are indexed on the raw file, which reads the
+        # visible records in large blocks and is much faster than going
+        # through the rp66 protocol one segment at a time.
         while True:
-            if tapemarks: offset -= tifsize
-            stream.seek(offset)
-            if tapemarks: stream = core.open_tif(stream)
-            stream = core.open_rp66(stream)
-
-            explicits, implicits, broken = core.findoffsets(stream, error_handler)
-            hint = rewind(stream.absolute_tell, tapemarks)
-
-            recs  = core.extract(stream, explicits, error_handler)
+            vrs = None
+            if not tapemarks:
+                explicits, implicits, broken, end, vrs = findoffsets(
+                    stream,
+                    path,
+                    offset,
+                    error_handler,
+                )
+                hint = rewind(end, tapemarks)
+                stream.seek(offset)
+                stream = core.open_rp66(stream)
+            else:
+                offset -= tifsize
+                stream.seek(offset)
+                stream = core.open_tif(stream)
+                stream = core.open_rp66(stream)
+
+                explicits, implicits, broken = core.findoffsets(
+                    stream,
+                    error_handler,
+                )
+                hint = rewind(stream.absolute_tell, tapemarks)
+
+            # The records at known offsets are read concurrently if asked
+            # for, see settings.io_depth
+            reader = batchreader(path, vrs)
+            readers.append(reader)
+            source = stream if reader is None else reader
+
+            recs  = core.extract(source, explicits, error_handler)
             sets  = core.parse_objects(recs, error_handler)
             pool  = core.pool(sets)
-            fdata = core.findfdata(stream, implicits, error_handler)
+            fdata, framenos = core.indexfdata(source, implicits, error_handler)
 
-            lf = logicalfile(stream, pool, fdata, sul, error_handler)
-            lfs.append(lf)
+            streams.append(stream)
+            indices.append(lfindex(offset, tapemarks, pool, fdata, framenos,
+                                   vrs))
+            if cache:
+                # parsed objects are a few times larger than their records
+                nbytes += 4 * sum(memoryview(rec).nbytes for rec in recs)
+                nbytes += 16 * len(implicits)
 
             if len(broken):
                 # do not attempt to recover or read more logical files
                 # if the error happened in findoffsets
                 # return all logical files we were able to process until now
-                break
+                if not resync or tapemarks: break
+
+                stream = open(path)
+                try:
+                    # always move forward, to not find the broken logical
+                    # file again
+                    resumed = core.resyncvrl(stream, max(hint, offset + 1))
+                except RuntimeError:
+                    stream.close()
+                    break
+
+                error_handler.log(
+                    core.error_severity.major,
+                    'dlisio.load',
+                    'logical file at tell {} is broken'.format(offset),
+                    '',
+                    'resuming at visible record at tell {}'.format(resumed),
+                )
+                offset = resumed
+                continue
 
-            stream = core.open(path)
+            stream = open(path)
 
             try:
                 offset = core.findvrl(stream, hint)
@@ -153,9 +289,55 @@ def load(path, error_handler = None):
                     break
                 raise
 
-        return physicalfile(lfs)
     except:
         stream.close()
+        for s in streams:
+            s.close()
+        for r in readers:
+            if r is not None: r.close()
+        raise
+
+    shared = None
+    if cache:
+        shared = filecache.insert(key, sul, indices, nbytes)
+
+    lfs = []
+    for s, r, index in zip(streams, readers, indices):
+        lfs.append(logicalfile(s, index.pool, index.fdata, sul, error_handler,
+                               fdata_framenos = index.framenos,
+                               shared = shared,
+                               reader = r))
+    return physicalfile(lfs)
+
+def reopen(path, shared, error_handler):
+    """ For internal use.
+    Open new handles to a file in the file cache. The caller must hold a
+    reference for every logical file in shared, which are handed over to the
+    new handles.
+    """
+    lfs = []
+    try:
+        for index in shared.lfs:
+            stream = open(path)
+            try:
+                stream.seek(index.offset)
+                if index.tif: stream = core.open_tif(stream)
+                stream = core.open_rp66(stream)
+                reader = batchreader(path, index.vrs)
+            except:
+                stream.close()
+                raise
+
+            lfs.append(logicalfile(stream, index.pool, index.fdata,
+                                   shared.sul, error_handler,
+                                   fdata_framenos = index.framenos,
+                                   shared = shared,
+                                   reader = reader))
+    except:
         for f in lfs:
             f.close()
+        for _ in range(len(shared.lfs) - len(lfs)):
+            shared.release()
         raise
+
+    return physicalfile(lfs)
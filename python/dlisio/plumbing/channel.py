@@ -1,6 +1,7 @@
 from .basicobject import BasicObject
-from ..reprc import dtype, fmt
-from ..dlisutils import curves
+from .. import core
+from ..reprc import dtype, native_dtype, big_endian_dtype, ident_bytes, fmt
+from ..dlisutils import cachedcurves
 from .valuetypes import scalar, vector, reverse
 from .linkage import *
 from .utils import *
@@ -164,10 +165,24 @@ class Channel(BasicObject):
 
         dtype : np.dtype
         """
+        return self.modedtype(core.curve_mode())
+
+    def modedtype(self, mode):
+        """ For internal use.
+        The dtype of the channel with the curve mode (the curve settings),
+        mode. Curves are decoded with the mode their dtype was made with.
+        """
+        types = native_dtype if mode.native else dtype
+        sample = types[self.reprc]
+        if mode.ident_bytes:
+            sample = ident_bytes(sample)
+        if mode.big_endian:
+            sample = big_endian_dtype.get(self.reprc, sample)
+
         if self.dimension == [1]:
-            return np.dtype(dtype[self.reprc])
+            return np.dtype(sample)
         else:
-            return np.dtype((dtype[self.reprc], tuple(self.dimension)))
+            return np.dtype((sample, tuple(self.dimension)))
 
     def fmtstr(self):
         """Generate format-string for Channel
@@ -205,14 +220,12 @@ class Channel(BasicObject):
         Notes
         -----
 
-        This method should only be used if there is only *one* channel of
-        interest in a particular frame.
-
         Due to the memory-layout of dlis-files, reading a single channel from
-        disk and reading the entire frame is almost equally fast. That means
-        reading channels from the same frame one-by-one with this method is
-        _way_ slower than reading the entire frame with :func:`Frame.curves()`
-        and then indexing on the channels-of-interest.
+        disk and reading the entire frame is almost equally fast, so this
+        method decodes the entire frame. The decoded frame is kept in a cache
+        on the logical file, so reading more channels from the same frame does
+        not decode it again. The size of the cache is controlled by
+        :attr:`dlisio.settings.frame_cache_size`.
 
         Examples
         --------
@@ -244,7 +257,8 @@ class Channel(BasicObject):
         6
         """
         if self.frame is not None:
-            return np.copy(self.frame.curves()[self.fingerprint])
+            curves = cachedcurves(self.frame.logicalfile, self.frame, strict=True)
+            return np.copy(curves[self.fingerprint])
 
         msg = 'There is no recorded curve-data for {}'
         logging.info(msg.format(self))
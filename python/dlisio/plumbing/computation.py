@@ -147,7 +147,7 @@ class Computation(BasicObject):
         Zone('ZONE-A')
         """
         try:
-            values = self.attic['VALUES'].value
+            values = arrayvalue(self.attic['VALUES'])
         except KeyError:
             return np.empty(0)
 
@@ -1,5 +1,5 @@
 from .basicobject import BasicObject
-from ..dlisutils import curves
+from ..dlisutils import curves, itercurves
 from .valuetypes import scalar, vector, boolean
 from .linkage import obname
 from .utils import *
@@ -204,6 +204,12 @@ class Frame(BasicObject):
         >>> frame.dtype()
         (FRAMENO','TIME-0-0', 'TDEP','TIME-1-0')
         """
+        return self.modedtype(core.curve_mode(), strict=strict)
+
+    def modedtype(self, mode, strict=True):
+        """ For internal use.
+        Frame.dtype with the curve mode (the curve settings), mode
+        """
         seen = {}
         types = [('FRAMENO', 'i4')]
 
@@ -213,7 +219,7 @@ class Frame(BasicObject):
 
         fmtlabel = self.dtype_fmt.format
         for i, ch in enumerate(self.channels, start = 1):
-            current = ((ch.fingerprint, ch.name), ch.dtype)
+            current = ((ch.fingerprint, ch.name), ch.modedtype(mode))
 
             # first time for this label, register it as "seen before"
             if ch.name not in seen:
@@ -228,7 +234,7 @@ class Frame(BasicObject):
                 logging.debug(info(ch.name, ch.origin, ch.copynumber))
                 raise
 
-            types.append(((ch.fingerprint, label), ch.dtype))
+            types.append(((ch.fingerprint, label), ch.modedtype(mode)))
 
             # the first-seen curve with this name has already been updated
             if seen[ch.name] is None:
@@ -245,7 +251,8 @@ class Frame(BasicObject):
 
             # update the previous label with this name, and mark (with None)
             # for not needing update again
-            types[prev_index] = ((prev.fingerprint, label), prev.dtype)
+            types[prev_index] = ((prev.fingerprint, label),
+                                 prev.modedtype(mode))
             seen[ch.name] = None
 
         try:
@@ -276,7 +283,7 @@ class Frame(BasicObject):
         # variable-lenght unsigned integer (i).
         return 'i' + ''.join([x.fmtstr() for x in self.channels])
 
-    def curves(self, strict=True):
+    def curves(self, strict=True, frames=None, index_range=None):
         """All curves belonging to this frame
 
         Get all the curves in this frame as a structured numpy array. The frame
@@ -294,6 +301,19 @@ class Frame(BasicObject):
             numerical values (i.e. 0, 1, 2 ..) to the labels used for
             column-names in the returned array.
 
+        frames : (int, int), optional
+            Only return the frames with frame numbers (FRAMENO) in [first,
+            last]. Only the FDATA records that may contain these frames are
+            read, which makes this much faster than slicing the full array
+            for small intervals in big files.
+
+        index_range : (number, number), optional
+            Only return the frames where the index channel is in [top,
+            bottom], in either order and for either :attr:`direction`. Like
+            frames, only the FDATA records that may contain these frames are
+            read. Frames without an index channel are indexed by FRAMENO.
+            Cannot be combined with frames.
+
         Returns
         -------
         curves : np.ndarray
@@ -306,6 +326,10 @@ class Frame(BasicObject):
             If there multiple channels with identical name, origin, copynumber
             in Frame.channels. This can be suppressed by passing strict=False
 
+        ValueError
+            If index_range is given, and the index channel is not a scalar
+            number, or if both frames and index_range are given
+
         See also
         --------
         Channel.curves : Access the curve-data directly through the Channel
@@ -445,13 +469,86 @@ class Frame(BasicObject):
         >>> curves = frame.curves(strict=False)
         >>> curves.dtype.names
         ('FRAMENO', 'TDEP.0.0(0)', 'TDEP.0.0(1)', 'GR')
+
+        Read a subset of the frames, by frame number
+
+        >>> curves = frame.curves(frames=(1000000, 1001000))
+        >>> curves['FRAMENO'][[0, -1]]
+        array([1000000, 1001000], dtype=int32)
+
+        Read a depth interval
+
+        >>> frame.index
+        'TDEP'
+        >>> curves = frame.curves(index_range=(1500.0, 1600.0))
+        >>> curves['TDEP'][[0, -1]]
+        array([1500., 1600.])
         """
+        mode = core.curve_mode()
         return curves(self.logicalfile,
                       self,
-                      self.dtype(strict=strict),
+                      self.modedtype(mode, strict=strict),
+                      mode,
                       "",
                       self.fmtstr(),
-                      "")
+                      "",
+                      frames=frames,
+                      index_range=index_range)
+
+    def iter_curves(self, chunk_frames=4096, strict=True):
+        """Iterate over the curves in this frame, in chunks of frames
+
+        Like :func:`curves`, but instead of reading all the frames into a
+        single array, the frames are read in chunks of (at most) chunk_frames
+        frames. Only a single chunk, and a single FDATA record, is kept in
+        memory at any time, so frames of any size can be processed in
+        constant memory.
+
+        Parameters
+        ----------
+
+        chunk_frames : int, optional
+            The maximum number of frames in each chunk
+
+        strict : boolean, optional
+            See :func:`curves`
+
+        Yields
+        ------
+        curves : np.ndarray
+            curves with dtype = self.dtype
+
+        Warnings
+        --------
+        The same array is re-used for every chunk, which means a chunk is
+        overwritten when the next one is read. Use np.copy to keep a chunk
+        around.
+
+        The curve settings (see dlisio.set_native_curves and friends)
+        are read when the iterator is created, and every chunk is decoded
+        with them, even if the settings change during the iteration.
+
+        See also
+        --------
+        Frame.curves : Read all the frames at once
+
+        Examples
+        --------
+        Compute the mean of a curve too big to fit in memory
+
+        >>> total, count = 0, 0
+        >>> for chunk in frame.iter_curves(chunk_frames=10000):
+        ...     total += chunk['GR'].sum()
+        ...     count += len(chunk)
+        >>> mean = total / count
+        """
+        mode = core.curve_mode()
+        return itercurves(self.logicalfile,
+                          self,
+                          self.modedtype(mode, strict=strict),
+                          mode,
+                          self.fmtstr(),
+                          chunk_frames)
 
     def fmtstrchannel(self, channel):
         """Generate format-strings for one Frame channel
@@ -127,7 +127,7 @@ class Measurement(BasicObject):
         may be either a scalar or ndarray
         """
         try:
-            samples = self.attic['MEASUREMENT'].value
+            samples = arrayvalue(self.attic['MEASUREMENT'])
         except KeyError:
             return np.empty(0)
 
@@ -147,7 +147,7 @@ class Measurement(BasicObject):
         structure as the samples in the sample attribute.
         """
         try:
-            dev = self.attic['MAXIMUM-DEVIATION'].value
+            dev = arrayvalue(self.attic['MAXIMUM-DEVIATION'])
         except KeyError:
             return np.empty(0)
 
@@ -166,7 +166,7 @@ class Measurement(BasicObject):
         structure as the samples in the sample attribute.
         """
         try:
-            dev = self.attic['STANDARD-DEVIATION'].value
+            dev = arrayvalue(self.attic['STANDARD-DEVIATION'])
         except KeyError:
             return np.empty(0)
 
@@ -181,7 +181,7 @@ class Measurement(BasicObject):
         structure as the samples in the sample attribute.
         """
         try:
-            ref = self.attic['REFERENCE'].value
+            ref = arrayvalue(self.attic['REFERENCE'])
         except KeyError:
             return np.empty(0)
 
@@ -199,7 +199,7 @@ class Measurement(BasicObject):
         structure as the samples in the sample attribute.
         """
         try:
-            tolerance = self.attic['PLUS-TOLERANCE'].value
+            tolerance = arrayvalue(self.attic['PLUS-TOLERANCE'])
         except KeyError:
             return np.empty(0)
 
@@ -217,7 +217,7 @@ class Measurement(BasicObject):
         structure as the samples in the sample attribute.
         """
         try:
-            tolerance   = self.attic['MINUS-TOLERANCE'].value
+            tolerance   = arrayvalue(self.attic['MINUS-TOLERANCE'])
         except KeyError:
             return np.empty(0)
 
@@ -127,7 +127,7 @@ class Parameter(BasicObject):
         Zone('ZONE-A')
         """
         try:
-            values = self.attic['VALUES'].value
+            values = arrayvalue(self.attic['VALUES'])
         except KeyError:
             return np.empty(0)
 
@@ -62,6 +62,27 @@ def validshape(data, shape, samplecount=None):
     if not size % samplesize: return shape
     raise ValueError(error.format(size, shape))
 
+def arrayvalue(attribute):
+    """The value of an attribute, as a numpy array if possible
+
+    Numeric attribute values are copied from the read-only numpy view of the
+    attribute (core.object_attribute.array), without going through a python
+    list. The copy is writable, and promoted to float64, int64 or complex128,
+    so that it is the same array as np.array(attribute.value) on 64-bit
+    linux. Integers are int64 on every platform, not np.int_, which is int32
+    on windows. Other values are lists, like object_attribute.value.
+    """
+    array = attribute.array
+    if array is None: return attribute.value
+
+    promoted = {
+        'f': np.float64,
+        'i': np.int64,
+        'u': np.int64,
+        'c': np.complex128,
+    }
+    return array.astype(promoted.get(array.dtype.kind, array.dtype))
+
 def sampling(data, shape, single=False):
     """Samplify takes a flat array and returns a structured numpy array, where
     each sample is shaped by shape, i.e. each sample may be scalar or ndarray.
@@ -116,12 +137,14 @@ def sampling(data, shape, single=False):
     samplecount = size // samplesize
 
     #TODO: Properly handle types that evaluates to dtype(object) by numpy
-    if isinstance(data[0], tuple):
+    if isinstance(data, np.ndarray):
+        elem_shape = data.shape[1:]
+    elif isinstance(data[0], tuple):
         elem_shape = (len(data[0]), )
     else:
         elem_shape = ()
 
-    data = np.array(data)
+    data = np.asarray(data)
     elem_dtype = np.dtype((data.dtype, elem_shape))
 
     if shape == [1]: dtype = np.dtype(elem_dtype)
@@ -302,7 +325,7 @@ def describe_sampled_attrs(buf, attic, dims, valuekey, extras, width, indent,
 
     valids, invs = OrderedDict(), OrderedDict()
     try:
-        value = attic[valuekey].value
+        value = arrayvalue(attic[valuekey])
         units = attic[valuekey].units
         shape = validshape(value, dims)
         valids['Value(s)'] = object_attribute(sampling(value, shape), units)
@@ -314,7 +337,7 @@ def describe_sampled_attrs(buf, attic, dims, valuekey, extras, width, indent,
     if extras:
         for label, key in extras.items():
             try:
-                value = attic[key].value
+                value = arrayvalue(attic[key])
                 units = attic[key].units
                 shape = validshape(value, dims)
                 valids[label] = object_attribute(
@@ -70,3 +70,50 @@ dtype = {
     26     : '?',                    #Boolean status
     27     : 'U255',                 #Units expression
 }
+
+""" reprc -> native type-string
+Conversion from dlis' representation codes to type-strings, for the codes
+that are represented by python objects in the default dtype table, when
+native curves are enabled (see dlisio.set_native_curves). The others are the
+same as in the default table.
+"""
+native_dtype = dict(dtype)
+native_dtype.update({
+    3      : [('V', 'f4'), ('A', 'f4')],
+    4      : [('V', 'f4'), ('A', 'f4'), ('B', 'f4')],
+    8      : [('V', 'f8'), ('A', 'f8')],
+    9      : [('V', 'f8'), ('A', 'f8'), ('B', 'f8')],
+    21     : 'M8[ms]',
+    23     : [('origin', 'u4'), ('copynumber', 'u1'), ('id', 'U255')],
+    24     : [('type', 'U255'), ('origin', 'u4'), ('copynumber', 'u1'),
+              ('id', 'U255')],
+})
+
+""" reprc -> big-endian type-string
+Conversion from dlis' representation codes to type-strings, for the codes that
+are copied as-is from disk when big-endian curves are enabled (see
+dlisio.set_big_endian_curves).
+"""
+big_endian_dtype = {
+    2      : '>f4',
+    7      : '>f8',
+    10     : '>c8',
+    11     : '>c16',
+    12     : 'i1',
+    13     : '>i2',
+    14     : '>i4',
+    15     : 'u1',
+    16     : '>u2',
+    17     : '>u4',
+}
+
+def ident_bytes(t):
+    """Replace U255 with S255 in a type-string from the dtype tables
+
+    Used when ident curves are decoded to bytes (see dlisio.set_ident_bytes),
+    which applies to the ids in native OBNAME and OBJREF samples too.
+    """
+    if t == 'U255': return 'S255'
+    if isinstance(t, list):
+        return [(name, ident_bytes(x)) for name, x in t]
+    return t
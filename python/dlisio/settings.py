@@ -13,6 +13,61 @@ Although possible, these globals are not intended to be changed by the end user
 regex = plumbing.regex_matcher(re.IGNORECASE)
 exact = plumbing.exact_matcher()
 
+""" Memory budget (in bytes) of the decoded-frame cache of every logical file.
+
+Channel.curves() decodes the full frame and slices out a single channel. To
+avoid decoding the same frame over and over when reading several channels
+from it, the decoded frames are kept in a least-recently-used cache, bounded by
+this budget. Set to 0 to disable the cache. Frames with python objects are
+charged an estimate of the size of the objects, not only of the array.
+
+The budget is read when the logical file is loaded. To change it for an
+already loaded file, set logicalfile.frame_cache.budget.
+"""
+frame_cache_size = 256 * 1024 * 1024
+
+""" Memory budget (in bytes) of the process-wide cache of loaded files.
+
+Files loaded with dlisio.load(path, cache=True) keep their index and metadata
+in a cache that is shared by all loads of the same file, until the file is
+changed on disk. Files that are still open are never evicted, so the cache
+may temporarily go over budget. Otherwise, the least recently used files are
+evicted first. The size of a file in the cache is an estimate.
+
+Set to 0 to not keep any files that are not open.
+"""
+file_cache_size = 512 * 1024 * 1024
+
+""" Number of concurrent reads per logical file, for reading records.
+
+By default, records are read one at a time through the file handle. With
+io_depth > 0, the records at known offsets (the metadata when loading, the
+FDATA index, and curves) are instead read by a pool of io_depth threads with
+positional reads, so that many reads are in flight at once. This makes good
+use of fast disks (NVMe) and hides the latency of network file systems, but
+is usually no faster on spinning disks or for small files. The results are
+the same either way.
+
+The depth is read when the file is loaded. Tapeimage (tif) files are always
+read one record at a time.
+"""
+io_depth = 0
+
+""" Number of shards to index every logical file in, in parallel.
+
+Before anything is read, the logical records of a logical file are found by
+walking all the visible records and segment headers, which for very large
+files takes a while on a single thread. With index_shards != 1, the file is
+split into shards that are indexed at the same time and stitched together
+afterwards. Set to 0 for a shard per core, but no smaller than 64MB. The
+results are the same either way, and files that are not well-formed are
+always indexed on a single thread.
+
+Tapeimage (tif) files and files that are already in memory are always indexed
+on a single thread.
+"""
+index_shards = 1
+
 def get_encodings():
     """Get codepages to use for decoding strings
 
@@ -103,3 +158,224 @@ def set_encodings(encodings):
     '畣瑳浯甠楮끴'
     """
     core.set_encodings(list(encodings))
+
+def get_native_curves():
+    """Are object-typed curve samples decoded to native numpy types
+
+    Returns
+    -------
+    native : bool
+
+    See also
+    --------
+    set_native_curves
+    """
+    return core.get_native_curves()
+
+def set_native_curves(native):
+    """Decode object-typed curve samples to native numpy types
+
+    By default, curve samples of some representation codes are decoded to
+    python objects, one per sample, in an object array. When native curves are
+    enabled, they are decoded to plain numpy types instead, which needs no
+    python allocations at all and is much faster for big frames:
+
+    ===================  ==================  ==============================
+    Representation code  Default             Native
+    ===================  ==================  ==============================
+    FSING1, FDOUB1       tuple (V, A)        (V, A) float
+    FSING2, FDOUB2       tuple (V, A, B)     (V, A, B) float
+    DTIME                datetime.datetime   datetime64[ms]
+    OBNAME               dlisio.core.obname  (origin, copynumber, id)
+    OBJREF               dlisio.core.objref  (type, origin, copynumber, id)
+    ===================  ==================  ==============================
+
+    The float types are structured sub-dtypes with the fields V, A and B. The
+    ids and types are U255, like IDENT samples. ASCII and ATTREF samples are
+    always python objects.
+
+    Parameters
+    ----------
+    native : bool
+
+    Warnings
+    --------
+    Like the encodings, this is a global setting that affects all curves read
+    after the change. Arrays read before the change are unaffected, and so are
+    the iterators from Frame.iter_curves made before the change.
+
+    Notes
+    -----
+    Time zones are ignored in datetime64, like in the default
+    datetime.datetime. Invalid dates are NaT.
+
+    Examples
+    --------
+    >>> dlisio.set_native_curves(True)
+    >>> curves = frame.curves()
+    >>> curves['TIME'].dtype
+    dtype('<M8[ms]')
+    """
+    core.set_native_curves(bool(native))
+
+def get_ident_bytes():
+    """Are IDENT and UNITS curve samples decoded to bytes
+
+    Returns
+    -------
+    bytes : bool
+
+    See also
+    --------
+    set_ident_bytes
+    """
+    return core.get_ident_bytes()
+
+def set_ident_bytes(bytes):
+    """Decode IDENT and UNITS curve samples to bytes (S255)
+
+    By default, IDENT and UNITS samples are decoded to U255, numpy's
+    fixed-width unicode type, which is 4 bytes per character. A single ident
+    sample then takes 1020 bytes, and an ident channel takes four times the
+    memory of the same channel decoded to S255. When enabled, samples are
+    copied as-is into S255 instead, which also skips widening the characters.
+
+    This applies to the ids and types of OBNAME and OBJREF samples when
+    native curves are enabled, too.
+
+    Parameters
+    ----------
+    bytes : bool
+
+    Warnings
+    --------
+    Like the encodings, this is a global setting that affects all curves read
+    after the change. Arrays read before the change are unaffected, and so are
+    the iterators from Frame.iter_curves made before the change.
+
+    Notes
+    -----
+    The encodings set with set_encodings are not applied to curves. In
+    unicode mode, every byte is widened to the code point of the same value,
+    i.e. the bytes are interpreted as latin-1.
+
+    Examples
+    --------
+    >>> dlisio.set_ident_bytes(True)
+    >>> curves = frame.curves()
+    >>> curves['NAME'].dtype
+    dtype('S255')
+    >>> curves['NAME'][0]
+    b'VALUE'
+    """
+    core.set_ident_bytes(bool(bytes))
+
+def get_big_endian_curves():
+    """Are IEEE floats and integers left in their on-disk byte order
+
+    Returns
+    -------
+    big_endian : bool
+
+    See also
+    --------
+    set_big_endian_curves
+    """
+    return core.get_big_endian_curves()
+
+def set_big_endian_curves(big_endian):
+    """Leave IEEE float and integer curves in their on-disk byte order
+
+    dlis stores numbers as big-endian, so on most machines every sample has to
+    be byte-swapped when the curves are read. When enabled, these channels get
+    big-endian dtypes instead, and the samples are copied straight from disk.
+    Frames where all channels are of these types are read with a single copy
+    per frame, which is limited by memory bandwidth rather than decoding.
+
+    ===================  ==================  ==============================
+    Representation code  Default             Big-endian
+    ===================  ==================  ==============================
+    FSINGL, FDOUBL       f4, f8              >f4, >f8
+    CSINGL, CDOUBL       c8, c16             >c8, >c16
+    SNORM, SLONG         i2, i4              >i2, >i4
+    UNORM, ULONG         u2, u4              >u2, >u4
+    ===================  ==================  ==============================
+
+    SSHORT and USHORT are single bytes, and are copied as-is too. FRAMENO is
+    always in native byte order.
+
+    Parameters
+    ----------
+    big_endian : bool
+
+    Warnings
+    --------
+    Like the encodings, this is a global setting that affects all curves read
+    after the change. Arrays read before the change are unaffected, and so are
+    the iterators from Frame.iter_curves made before the change.
+
+    Notes
+    -----
+    numpy computes on big-endian arrays just fine, but swaps the bytes on
+    every access. To swap once, use ``curves.astype(curves.dtype.newbyteorder('='))``.
+
+    Examples
+    --------
+    >>> dlisio.set_big_endian_curves(True)
+    >>> curves = frame.curves()
+    >>> curves['DEPTH'].dtype
+    dtype('>f8')
+    """
+    core.set_big_endian_curves(bool(big_endian))
+
+def get_verify_checksums():
+    """Are logical record segment checksums verified
+
+    Returns
+    -------
+    verify : bool
+
+    See also
+    --------
+    set_verify_checksums
+    """
+    return core.get_verify_checksums()
+
+def set_verify_checksums(verify):
+    """Verify the checksums of logical record segments
+
+    Logical record segments may have a 16-bit checksum in their trailer. By
+    default, dlisio strips them without looking at them. When enabled, the
+    checksum of every segment that has one is computed and compared, both
+    when the file is indexed by load, and when records are read later (e.g.
+    metadata and curves). A mismatch is reported to the error handler as a
+    major error, and the record is read as-is.
+
+    Segments without checksums, and encrypted segments, are not verified.
+
+    Parameters
+    ----------
+    verify : bool
+
+    Warnings
+    --------
+    Like the encodings, this is a global setting that affects all files
+    loaded and records read after the change.
+
+    Notes
+    -----
+    Indexing a file with checksums reads it in full, rather than only reading
+    the segment headers. Files without checksums are not affected.
+
+    Examples
+    --------
+    >>> from dlisio.errors import ErrorHandler, Actions
+    >>> dlisio.set_verify_checksums(True)
+    >>> handler = ErrorHandler(major=Actions.RAISE)
+    >>> f, *_ = dlisio.load('corrupted.dlis', error_handler=handler)
+    Traceback (most recent call last):
+    ...
+    RuntimeError:
+    ...
+    """
+    core.set_verify_checksums(bool(verify))
@@ -0,0 +1,92 @@
+import contextlib
+import copy
+
+from . import core
+
+def read():
+    """Hot-path counters and stage timers
+
+    dlisio counts the bytes read, seeks, segments, records, objects, frames
+    and the threads started to decode curves (workers), and times the stages
+    of loading and reading a file, for the whole process. The numbers are
+    cumulative since the extension was loaded, or since the last reset.
+
+    Stage times are wall-clock and inclusive, so nested stages (e.g. extract
+    inside findfdata) are counted in both.
+
+    Returns
+    -------
+    stats : dict
+
+    Notes
+    -----
+    The counters are a compile-time option (DLISIO_STATS), which is on by
+    default. When dlisio is built without it, stats['enabled'] is False, and
+    everything is zero.
+
+    Examples
+    --------
+    >>> stats = dlisio.stats.read()
+    >>> stats['bytes_read']
+    1048576
+    >>> stats['stages']['findoffsets']
+    {'calls': 1, 'seconds': 0.0021}
+    """
+    return core.stats()
+
+def reset():
+    """Reset all counters and stage timers to zero
+
+    See also
+    --------
+    read
+    """
+    core.reset_stats()
+
+def delta(before, after):
+    """The difference between two snapshots from read()
+
+    Parameters
+    ----------
+    before : dict
+    after : dict
+
+    Returns
+    -------
+    stats : dict
+    """
+    diff = copy.deepcopy(after)
+    for key, value in after.items():
+        if key in ('enabled', 'stages'): continue
+        diff[key] = value - before[key]
+
+    for name, stage in after['stages'].items():
+        for key, value in stage.items():
+            diff['stages'][name][key] = value - before['stages'][name][key]
+
+    return diff
+
+@contextlib.contextmanager
+def collect():
+    """Collect the counters and timers of a block
+
+    Yields a dict that is filled with what happened inside the with-block
+    when the block exits. Other threads using dlisio at the same time are
+    counted too.
+
+    Examples
+    --------
+    >>> with dlisio.stats.collect() as stats:
+    ...     with dlisio.load(path) as files:
+    ...         curves = files[0].frames[0].curves()
+    >>> stats['frames']
+    1200
+    >>> stats['stages']['read_fdata']['seconds']
+    0.0135
+    """
+    result = {}
+    before = read()
+    try:
+        yield result
+    finally:
+        result.update(delta(before, read()))
@@ -61,6 +61,88 @@ def test_curves_values(f):
     np.testing.assert_array_equal(curves['CHANN2'][2], val)
     np.testing.assert_array_equal(curves[2]['CHANN2'], val)
 
+def test_curves_same_for_any_number_of_threads(f):
+    frame = f.object('FRAME', 'FRAME1', 10, 0)
+    dtype = frame.dtype()
+    alloc = lambda size: np.empty(shape = size, dtype = dtype)
+
+    args = (
+        '',
+        frame.fmtstr(),
+        '',
+        f.file,
+        f.fdata_index[frame.fingerprint],
+        dtype.itemsize,
+        core.curve_mode(),
+        alloc,
+        f.error_handler,
+    )
+    single = core.read_fdata(*args, threads = 1)
+
+    # the file is tiny, so curves would otherwise be decoded in the calling
+    # thread no matter the number of threads asked for
+    thread_bytes = core.get_fdata_thread_bytes()
+    core.set_fdata_thread_bytes(0)
+    try:
+        with dlisio.stats.collect() as stats:
+            many = core.read_fdata(*args, threads = 4)
+    finally:
+        core.set_fdata_thread_bytes(thread_bytes)
+
+    if stats['enabled']:
+        assert stats['workers'] > 0
+
+    np.testing.assert_array_equal(single, many)
+    np.testing.assert_array_equal(single, frame.curves())
+
+@pytest.mark.parametrize('fpath, key', [
+    # plain numbers
+    ('data/chap4-7/iflr/multidimensions-multifdata.dlis',
+        ('FRAME', 'FRAME-DIMENSION', 11, 0)),
+    # fixed-size on disk, but python objects in the array
+    ('data/chap4-7/iflr/multidimensions-validated.dlis',
+        ('FRAME', 'FRAME-VALIDATE', 10, 0)),
+])
+@pytest.mark.parametrize('chunk_bytes', [16 << 20, 1])
+def test_fixed_size_frames_are_allocated_once(fpath, key, chunk_bytes):
+    # With chunk_bytes = 1, every record is a chunk of its own, like the
+    # records of a frame much larger than the default chunk
+    class counting(np.ndarray):
+        resizes = 0
+        def resize(self, *args, **kwargs):
+            counting.resizes += 1
+            return super().resize(*args, **kwargs)
+
+    with dlisio.load(fpath) as (f, *_):
+        frame = f.object(*key)
+        dtype = frame.dtype()
+        allocs = []
+        def alloc(size):
+            allocs.append(size)
+            return np.empty(shape = size, dtype = dtype).view(counting)
+
+        indices = f.fdata_index[frame.fingerprint]
+        default = core.get_fdata_chunk_bytes()
+        core.set_fdata_chunk_bytes(chunk_bytes)
+        try:
+            curves = core.read_fdata(
+                '',
+                frame.fmtstr(),
+                '',
+                f.file,
+                indices,
+                dtype.itemsize,
+                core.curve_mode(),
+                alloc,
+                f.error_handler,
+            )
+        finally:
+            core.set_fdata_chunk_bytes(default)
+
+        assert allocs == [len(curves)]
+        assert counting.resizes == 0
+        np.testing.assert_array_equal(curves, frame.curves())
+
 def test_two_various_fdata_in_one_iflr():
     fpath = 'data/chap4-7/iflr/two-various-fdata-in-one-iflr.dlis'
 
@@ -95,6 +177,113 @@ def test_framenos_out_of_order_two_frames_multidata():
     assert curves[2][1] == False
     assert curves[3][1] == True
 
+def test_curves_frame_range():
+    fpath = 'data/chap4-7/iflr/multidimensions-multifdata.dlis'
+    with dlisio.load(fpath) as (f, *_):
+        frame = f.object('FRAME', 'FRAME-DIMENSION', 11, 0)
+        curves = frame.curves()
+
+        # both frames are in the same record
+        assert f.fdata_framenos[frame.fingerprint] == [curves['FRAMENO'][0]]
+
+        first = curves['FRAMENO'][1]
+        subset = frame.curves(frames = (first, first))
+        np.testing.assert_array_equal(subset, curves[1:2])
+
+        subset = frame.curves(frames = (first + 100, first + 200))
+        assert len(subset) == 0
+
+def test_curves_frame_range_out_of_order():
+    fpath = 'data/chap4-7/iflr/out-of-order-framenos-two-frames-multifdata.dlis'
+    with dlisio.load(fpath) as (f, *_):
+        frame = f.object('FRAME', 'FRAME-REPRCODE', 10, 0)
+        curves = frame.curves(frames = (2, 3))
+        np.testing.assert_array_equal(curves['FRAMENO'], [3, 2])
+
+def test_curves_index_range_without_index_channel():
+    fpath = 'data/chap4-7/iflr/multidimensions-multifdata.dlis'
+    with dlisio.load(fpath) as (f, *_):
+        frame = f.object('FRAME', 'FRAME-DIMENSION', 11, 0)
+        assert frame.index == 'FRAMENO'
+        curves = frame.curves()
+
+        # Without an index channel, frames are indexed by FRAMENO
+        first = curves['FRAMENO'][1]
+        subset = frame.curves(index_range = (first + 0.5, first - 0.5))
+        np.testing.assert_array_equal(subset, curves[1:2])
+
+        with pytest.raises(ValueError):
+            _ = frame.curves(frames = (0, 1), index_range = (0, 1))
+
+def test_curves_index_range_multidimensional_index(f):
+    frame = f.object('FRAME', 'FRAME1', 10, 0)
+    assert frame.index_type == 'BOREHOLE-DEPTH'
+
+    with pytest.raises(ValueError) as exc:
+        _ = frame.curves(index_range = (1, 100))
+    assert 'scalar, numeric index channel' in str(exc.value)
+
+@pytest.mark.parametrize('chunk_frames', [1, 2, 3, 100])
+def test_iter_curves(chunk_frames):
+    fpath = 'data/chap4-7/iflr/out-of-order-framenos-two-frames-multifdata.dlis'
+    with dlisio.load(fpath) as (f, *_):
+        frame = f.object('FRAME', 'FRAME-REPRCODE', 10, 0)
+        curves = frame.curves()
+
+        chunks = [np.copy(x) for x in frame.iter_curves(chunk_frames)]
+        assert all(len(x) <= chunk_frames for x in chunks)
+        np.testing.assert_array_equal(np.concatenate(chunks), curves)
+
+def test_iter_curves_reuses_buffer():
+    fpath = 'data/chap4-7/iflr/out-of-order-framenos-two-frames-multifdata.dlis'
+    with dlisio.load(fpath) as (f, *_):
+        frame = f.object('FRAME', 'FRAME-REPRCODE', 10, 0)
+        chunks = list(frame.iter_curves(chunk_frames = 2))
+        assert len(chunks) == 2
+        assert np.shares_memory(chunks[0], chunks[1])
+
+def test_iter_curves_object_samples():
+    fpath = 'data/chap4-7/iflr/two-various-fdata-in-one-iflr.dlis'
+    with dlisio.load(fpath) as (f, *_):
+        frame = f.object('FRAME', 'FRAME-REPRCODE', 10, 0)
+        curves = frame.curves()
+        chunks = [np.copy(x) for x in frame.iter_curves(chunk_frames = 1)]
+        assert len(chunks) == 2
+        assert chunks[0][0][2] == "VALUE"
+        assert chunks[1][0][2] == "SECOND-VALUE"
+        np.testing.assert_array_equal(np.concatenate(chunks), curves)
+
+def test_iter_curves_invalid_chunk_size():
+    fpath = 'data/chap4-7/iflr/two-various-fdata-in-one-iflr.dlis'
+    with dlisio.load(fpath) as (f, *_):
+        frame = f.object('FRAME', 'FRAME-REPRCODE', 10, 0)
+        with pytest.raises(ValueError):
+            _ = frame.iter_curves(chunk_frames = 0)
+
+@pytest.mark.parametrize('threads', [1, 2, 0])
+def test_read_all_frames(f, threads):
+    frames = [f.object('FRAME', 'FRAME1'), f.object('FRAME', 'FRAME2')]
+    curves = f.read_all_frames(frames = frames, threads = threads)
+    assert len(curves) == len(frames)
+    for frame, data in zip(frames, curves):
+        assert data.dtype == frame.dtype()
+        np.testing.assert_array_equal(data, frame.curves())
+
+def test_read_all_frames_subset(f):
+    frame = f.object('FRAME', 'FRAME2')
+    curves = f.read_all_frames(frames = [frame])
+    assert len(curves) == 1
+    np.testing.assert_array_equal(curves[0], frame.curves())
+
+def test_read_all_frames_object_samples():
+    fpath = 'data/chap4-7/iflr/two-various-fdata-in-one-iflr.dlis'
+    with dlisio.load(fpath) as (f, *_):
+        frame = f.object('FRAME', 'FRAME-REPRCODE', 10, 0)
+        curves = f.read_all_frames(frames = [frame])
+        assert curves[0][0][2] == "VALUE"
+        assert curves[0][1][2] == "SECOND-VALUE"
+        np.testing.assert_array_equal(curves[0], frame.curves())
+
 def test_framenos_missing_numbers():
     fpath = 'data/chap4-7/iflr/missing-framenos.dlis'
     curves = load_curves(fpath)
@@ -315,6 +504,63 @@ def test_channel_curves():
         frame_curves = load_curves(fpath)
         assert frame_curves['CH22'] == curves22
 
+def test_channel_curves_decode_frame_once(monkeypatch):
+    calls = []
+    read_fdata = core.read_fdata
+    def counting_read_fdata(*args, **kwargs):
+        calls.append(args[1])
+        return read_fdata(*args, **kwargs)
+
+    fpath = 'data/chap4-7/iflr/all-reprcodes.dlis'
+    with dlisio.load(fpath) as (f, *_):
+        monkeypatch.setattr(core, 'read_fdata', counting_read_fdata)
+        frame = f.object('FRAME', 'FRAME-REPRCODE', 10, 0)
+        curves = [ch.curves() for ch in frame.channels]
+        assert len(calls) == 1
+
+        # channel curves are copies, and must not affect the cache
+        original = np.copy(curves[0])
+        curves[0].fill(0)
+        np.testing.assert_array_equal(frame.channels[0].curves(), original)
+        assert len(calls) == 1
+
+        # Frame.curves() always decodes
+        _ = frame.curves()
+        assert len(calls) == 2
+
+def test_channel_curves_cache_budget(monkeypatch):
+    calls = []
+    read_fdata = core.read_fdata
+    def counting_read_fdata(*args, **kwargs):
+        calls.append(args[1])
+        return read_fdata(*args, **kwargs)
+
+    fpath = 'data/chap4-7/iflr/all-reprcodes.dlis'
+    with dlisio.load(fpath) as (f, *_):
+        monkeypatch.setattr(core, 'read_fdata', counting_read_fdata)
+        f.frame_cache.budget = 0
+        channel = f.object('CHANNEL', 'CH22', 10, 0)
+        _ = channel.curves()
+        _ = channel.curves()
+        assert len(calls) == 2
+        assert f.frame_cache.size == 0
+
+def test_channel_curves_cache_counts_objects():
+    fpath = 'data/chap4-7/iflr/all-reprcodes.dlis'
+    with dlisio.load(fpath) as (f, *_):
+        frame = f.object('FRAME', 'FRAME-REPRCODE', 10, 0)
+        curves = frame.curves()
+        assert curves.dtype.hasobject
+
+        _ = frame.channels[0].curves()
+        assert f.frame_cache.size > curves.nbytes
+
+        # the estimate is above the budget, so the frame is not cached
+        f.frame_cache.clear()
+        f.frame_cache.budget = curves.nbytes
+        _ = frame.channels[0].curves()
+        assert f.frame_cache.size == 0
+
 def test_channel_curves_duplicated_mnemonics():
     fpath = "data/chap4-7/eflr/frames-and-channels/mainframe.dlis"
     with dlisio.load(fpath) as (f, *_):
@@ -408,3 +654,39 @@ def test_frame_index_nochannels(assert_info, tmpdir_factory,
         frame = f.object("FRAME", "INDEXED_NO_CHANNELS")
         assert frame.index is None
         assert_info('Frame has no channels')
+
+def test_curves_are_counted_in_stats():
+    fpath = 'data/chap4-7/iflr/out-of-order-framenos-two-frames-multifdata.dlis'
+    with dlisio.stats.collect() as stats:
+        with dlisio.load(fpath) as (f, *_):
+            frame = f.object('FRAME', 'FRAME-REPRCODE', 10, 0)
+            curves = frame.curves()
+
+    if not stats['enabled']:
+        assert stats['frames'] == 0
+        assert stats['stages']['read_fdata']['calls'] == 0
+        return
+
+    assert stats['frames'] == len(curves)
+    assert stats['records'] > 0
+    assert stats['bytes_read'] > 0
+    assert stats['stages']['findoffsets']['calls'] >= 1
+    assert stats['stages']['read_fdata']['calls'] >= 1
+    assert stats['stages']['read_fdata']['seconds'] > 0
+
+def test_curves_are_the_same_with_io_depth(monkeypatch):
+    fpath = 'data/chap4-7/iflr/out-of-order-framenos-two-frames-multifdata.dlis'
+    with dlisio.load(fpath) as (f, *_):
+        assert f.reader is None
+        expected = [frame.curves() for frame in f.frames]
+        expected_fdata = f.fdata_index
+
+    monkeypatch.setattr(dlisio.settings, 'io_depth', 4)
+    with dlisio.load(fpath) as (f, *_):
+        assert f.reader.depth == 4
+        assert f.fdata_index == expected_fdata
+        for frame, curves in zip(f.frames, expected):
+            np.testing.assert_array_equal(frame.curves(), curves)
+
+        for curves, many in zip(expected, f.read_all_frames()):
+            np.testing.assert_array_equal(many, curves)
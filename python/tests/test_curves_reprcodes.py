@@ -368,6 +368,193 @@ def test_all_reprcodes():
     assert c[26] == True
     assert c[27] == "unit"
 
+@pytest.fixture
+def native_curves():
+    dlisio.set_native_curves(True)
+    try:
+        yield
+    finally:
+        # make sure the default is restored, to not interfere with other tests
+        dlisio.set_native_curves(False)
+
+def test_all_reprcodes_native(native_curves):
+    fpath = 'data/chap4-7/iflr/all-reprcodes.dlis'
+    curves = load_curves(fpath)
+    assert curves.dtype.hasobject
+
+    c = curves[0]
+    assert c[3]['V'] == -2
+    assert c[3]['A'] == 2
+    assert (c[4]['V'], c[4]['A'], c[4]['B']) == (117, -13.25, 32444)
+    assert (c[8]['V'], c[8]['A']) == (-13.5, -27670)
+    assert (c[9]['V'], c[9]['A'], c[9]['B']) == (6728332223, -45.75, -0.0625)
+    assert c[21] == np.datetime64('1971-03-21T18:04:14.386')
+    assert curves.dtype[21] == np.dtype('M8[ms]')
+    assert (c[23]['origin'], c[23]['copynumber'], c[23]['id']) == (
+        18, 5, "OBNAME_I"
+    )
+    assert (c[24]['type'], c[24]['origin'],
+            c[24]['copynumber'], c[24]['id']) == (
+        "OBJREF_I", 25, 3, "OBJREF_OBNAME"
+    )
+
+    # ascii and attref are still python objects
+    assert c[20] == "ASCII VALUE"
+    assert c[25] == ("FIRST_INDENT", (3, 2, "ATTREF_OBNAME"), "SECOND_INDENT")
+
+    # the other codes are unchanged
+    assert c[2]  == 5.5
+    assert c[19] == "VALUE"
+    assert c[27] == "unit"
+
+def test_native_curves_fixed_frames(native_curves):
+    fpath = 'data/chap4-7/iflr/multidimensions-validated.dlis'
+    with dlisio.load(fpath) as (f, *_):
+        frame = f.object('FRAME', 'FRAME-VALIDATE', 10, 0)
+        curves = frame.curves()
+        assert not curves.dtype.hasobject
+
+        sample = curves[0][1]
+        assert sample.size == 3
+        np.testing.assert_array_equal(sample['V'], [56, 43, 71])
+        np.testing.assert_array_equal(sample['A'], [0.0625, 0.0625, 0.5])
+        np.testing.assert_array_equal(sample['B'], [0.0625, 0.0625, 0.5])
+
+def test_native_curves_dtime(native_curves):
+    fpath = 'data/chap4-7/iflr/reprcodes/21-dtime.dlis'
+    curves = load_curves(fpath)
+    assert curves.dtype[1] == np.dtype('M8[ms]')
+    assert curves[0][1] == np.datetime64('1971-03-21T18:04:14.386')
+
+    with dlisio.load(fpath) as (f, *_):
+        frame = f.object('FRAME', 'FRAME-REPRCODE', 10, 0)
+        chunks = list(frame.iter_curves(chunk_frames = 100))
+        assert chunks[0].dtype[1] == np.dtype('M8[ms]')
+        np.testing.assert_array_equal(chunks[0], curves)
+
+def test_native_curves_changed_during_iter_curves():
+    fpath = 'data/chap4-7/iflr/reprcodes-x2/04-fsing2.dlis'
+    with dlisio.load(fpath) as (f, *_):
+        frame = f.object('FRAME', 'FRAME-REPRCODE', 10, 0)
+        expected = frame.curves()
+        chunks = frame.iter_curves(chunk_frames = 1)
+        first = np.copy(next(chunks))
+
+        dlisio.set_native_curves(True)
+        try:
+            rest = [np.copy(chunk) for chunk in chunks]
+        finally:
+            dlisio.set_native_curves(False)
+
+    curves = np.concatenate([first] + rest)
+    assert curves.dtype == expected.dtype
+    assert len(curves) == 2
+    np.testing.assert_array_equal(curves, expected)
+
+@pytest.fixture
+def ident_bytes():
+    dlisio.set_ident_bytes(True)
+    try:
+        yield
+    finally:
+        # make sure the default is restored, to not interfere with other tests
+        dlisio.set_ident_bytes(False)
+
+def test_ident_bytes(ident_bytes):
+    fpath = 'data/chap4-7/iflr/reprcodes/19-ident.dlis'
+    curves = load_curves(fpath)
+    assert curves.dtype[1] == np.dtype('S255')
+    assert curves[0].dtype.itemsize == 4 + 255
+    assert curves[0][1] == b'VALUE'
+
+    fpath = 'data/chap4-7/iflr/reprcodes/27-units.dlis'
+    curves = load_curves(fpath)
+    assert curves[0][1] == b'unit'
+
+def test_ident_bytes_native(native_curves, ident_bytes):
+    fpath = 'data/chap4-7/iflr/all-reprcodes.dlis'
+    curves = load_curves(fpath)
+
+    c = curves[0]
+    assert c[19] == b'VALUE'
+    assert c[23]['id'] == b'OBNAME_I'
+    assert (c[24]['type'], c[24]['id']) == (b'OBJREF_I', b'OBJREF_OBNAME')
+
+def test_ident_bytes_changed_during_iter_curves():
+    fpath = 'data/chap4-7/iflr/reprcodes-x2/19-ident.dlis'
+    with dlisio.load(fpath) as (f, *_):
+        frame = f.object('FRAME', 'FRAME-REPRCODE', 10, 0)
+        expected = frame.curves()
+        chunks = frame.iter_curves(chunk_frames = 1)
+        first = np.copy(next(chunks))
+
+        dlisio.set_ident_bytes(True)
+        try:
+            rest = [np.copy(chunk) for chunk in chunks]
+        finally:
+            dlisio.set_ident_bytes(False)
+
+    curves = np.concatenate([first] + rest)
+    assert curves.dtype[1] == np.dtype('U255')
+    assert len(curves) == 2
+    np.testing.assert_array_equal(curves, expected)
+
+@pytest.fixture
+def big_endian_curves():
+    dlisio.set_big_endian_curves(True)
+    try:
+        yield
+    finally:
+        # make sure the default is restored, to not interfere with other tests
+        dlisio.set_big_endian_curves(False)
+
+def test_big_endian_fixed_frames(big_endian_curves):
+    fpath = 'data/chap4-7/iflr/reprcodes-x2/02-fsingl.dlis'
+    curves = load_curves(fpath)
+    assert curves.dtype[0] == np.dtype('i4')
+    assert curves.dtype[1] == np.dtype('>f4')
+    assert curves[0][0] == 1
+    assert curves[0][1] == 5.5
+    assert curves[1][1] == -13.75
+
+    with dlisio.load(fpath) as (f, *_):
+        frame = f.object('FRAME', 'FRAME-REPRCODE', 10, 0)
+        chunks = list(frame.iter_curves(chunk_frames = 1))
+        np.testing.assert_array_equal(np.concatenate(chunks), curves)
+
+def test_big_endian_mixed_frames(big_endian_curves):
+    fpath = 'data/chap4-7/iflr/all-reprcodes.dlis'
+    curves = load_curves(fpath)
+    assert curves.dtype[2] == np.dtype('>f4')
+    assert curves.dtype[14] == np.dtype('>i4')
+
+    with dlisio.load(fpath) as (f, *_):
+        dlisio.set_big_endian_curves(False)
+        frame = f.object('FRAME', 'FRAME-REPRCODE', 10, 0)
+        expected = frame.curves()
+
+    for i in range(1, len(expected.dtype)):
+        assert curves[0][i] == expected[0][i]
+
+def test_big_endian_changed_during_iter_curves():
+    fpath = 'data/chap4-7/iflr/reprcodes-x2/07-fdoubl.dlis'
+    with dlisio.load(fpath) as (f, *_):
+        frame = f.object('FRAME', 'FRAME-REPRCODE', 10, 0)
+        expected = frame.curves()
+        chunks = frame.iter_curves(chunk_frames = 1)
+        first = np.copy(next(chunks))
+
+        dlisio.set_big_endian_curves(True)
+        try:
+            rest = [np.copy(chunk) for chunk in chunks]
+        finally:
+            dlisio.set_big_endian_curves(False)
+
+    curves = np.concatenate([first] + rest)
+    assert curves.dtype == expected.dtype
+    assert len(curves) == 2
+    np.testing.assert_array_equal(curves, expected)
+
 def test_ascii_big():
     fpath = 'data/chap4-7/iflr/big-ascii.dlis'
     curves = load_curves(fpath)
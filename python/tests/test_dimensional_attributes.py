@@ -347,6 +347,58 @@ def test_parameter_computation_repcode(tmpdir, merge_files_oneLR, settype,
         obj  = f.object(settype, 'OBJECT', 10, 0)
         assert np.array_equal(obj.values[0], value)
 
+@pytest.mark.parametrize('value, valuefilename', [
+    ([0.5, 1.5], '0.5-1.5.dlis.part'),
+    ([1, 2], '1-2.dlis.part'),
+    ([(0.5, 1.5), (2.5, 3.5)], 'validated-(0.5-1.5),(2.5-3.5).dlis.part'),
+    ([complex(0.5, 1.5), complex(2.5, 3.5)],
+         'complex-(0.5-1.5),(2.5-3.5).dlis.part'),
+])
+def test_values_are_copies_of_attribute_views(tmpdir, merge_files_oneLR, value,
+                                    valuefilename):
+    path = os.path.join(str(tmpdir), 'values-views.dlis')
+    content = [
+        *assemble_set('PARAMETER'),
+        'data/chap4-7/eflr/ndattrs/objattr/' + valuefilename,
+        'data/chap4-7/eflr/ndattrs/objattr/2.dlis.part',
+        'data/chap4-7/eflr/ndattrs/objattr/empty-OBNAME.dlis.part',
+    ]
+    merge_files_oneLR(path, content)
+
+    with dlisio.load(path) as (f, *_):
+        obj = f.object('PARAMETER', 'OBJECT', 10, 0)
+        array = obj.attic['VALUES'].array
+        assert np.array_equal(array, value)
+        assert not array.flags.writeable
+
+        # the values are a writable copy, promoted like np.array would do
+        # for the python values on 64-bit linux, on every platform
+        values = obj.values
+        assert not np.shares_memory(values, array)
+        assert values.flags.writeable
+        assert values.dtype in (np.float64, np.int64, np.complex128)
+        assert values.dtype.kind == np.array([value]).dtype.kind
+        assert np.array_equal(values[0], value)
+
+        # the view outlives the object it was made from
+        del obj
+        assert np.array_equal(array, value)
+
+def test_values_string_attribute_is_not_viewable(tmpdir, merge_files_oneLR):
+    path = os.path.join(str(tmpdir), 'values-string-view.dlis')
+    content = [
+        *assemble_set('PARAMETER'),
+        'data/chap4-7/eflr/ndattrs/objattr/string-val1,val2.dlis.part',
+        'data/chap4-7/eflr/ndattrs/objattr/2.dlis.part',
+        'data/chap4-7/eflr/ndattrs/objattr/empty-OBNAME.dlis.part',
+    ]
+    merge_files_oneLR(path, content)
+
+    with dlisio.load(path) as (f, *_):
+        obj = f.object('PARAMETER', 'OBJECT', 10, 0)
+        assert obj.attic['VALUES'].array is None
+        assert list(obj.values[0]) == ['val1', 'val2']
+
 def test_measurement_empty(tmpdir, merge_files_oneLR):
     path = os.path.join(str(tmpdir), 'measurement-empty.dlis')
     content = [
@@ -6,10 +6,11 @@ Testing error handler on various levels of representation
 import pytest
 import os
 import numpy as np
+from datetime import datetime
 
 import dlisio
 
-from dlisio.errors import ErrorHandler, Actions
+from dlisio.errors import ErrorHandler, ErrorCollector, Actions
 
 errorhandler = ErrorHandler(critical = Actions.LOG_ERROR)
 
@@ -92,6 +93,46 @@ def test_curves_broken_fmt(assert_error):
         assert_error("fmtstr would read past end")
         assert np.array_equal(curves['FRAMENO'], np.array([1, 3]))
 
+def broken_dtime_file():
+    """ A frame with a single DTIME channel, and three FDATA records, where
+    the month of frame 2 is 13
+    """
+    with open('data/chap4-7/iflr/reprcodes/21-dtime.dlis', 'rb') as f:
+        data = bytearray(f.read())
+
+    # the FDATA record: the obname, frame number 1, and an 8-byte DTIME,
+    # where the second byte is the time zone and the month
+    fdata = data[-30:]
+    def record(frameno, month):
+        seg = bytearray(fdata)
+        seg[21] = frameno
+        seg[23] = month
+        return seg
+
+    vr = record(2, 13) + record(3, 3)
+    data += (len(vr) + 4).to_bytes(2, 'big') + b'\xff\x01' + vr
+    return bytes(data)
+
+def test_curves_broken_dtime(assert_error):
+    path = broken_dtime_file()
+    with dlisio.load(path, error_handler=errorhandler) as (f, *_):
+        frame = f.object('FRAME', 'FRAME-REPRCODE', 10, 0)
+        curves = frame.curves()
+        assert_error("Record is skipped")
+        assert np.array_equal(curves['FRAMENO'], np.array([1, 3]))
+        assert curves['CH21'][0] == datetime(1971, 3, 21, 18, 4, 14, 386000)
+        assert curves['CH21'][1] == datetime(1971, 3, 21, 18, 4, 14, 386000)
+
+def test_read_all_frames_broken_dtime(assert_error):
+    path = broken_dtime_file()
+    with dlisio.load(path, error_handler=errorhandler) as (f, *_):
+        frame = f.object('FRAME', 'FRAME-REPRCODE', 10, 0)
+        curves, = f.read_all_frames(frames=[frame])
+        assert_error("Record is skipped")
+        assert np.array_equal(curves['FRAMENO'], np.array([1, 3]))
+        assert curves['CH21'][0] == datetime(1971, 3, 21, 18, 4, 14, 386000)
+        assert curves['CH21'][1] == datetime(1971, 3, 21, 18, 4, 14, 386000)
+
 def test_parse_objects_unexpected_attribute_in_set(assert_error):
     path = 'data/chap3/explicit/broken-in-set.dlis'
     with dlisio.load(path, error_handler=errorhandler) as (f, *_):
@@ -203,6 +244,26 @@ def test_many_logical_files():
             files[1].load()
 
 
+def test_many_logical_files_resync(tmpdir):
+    path = os.path.join(str(tmpdir), 'resync.dlis')
+    with open('data/chap4-7/many-logical-files.dlis', 'rb') as f:
+        data = bytearray(f.read())
+
+    # Break the second segment of the second logical file, which is in the
+    # visible record at tell 1210, after a 124-byte FILE-HEADER segment. The
+    # third logical file is in the next visible record
+    data[1210 + 4 + 124:1210 + 4 + 124 + 2] = (2).to_bytes(2, 'big')
+    with open(path, 'wb') as f:
+        f.write(data)
+
+    errorhandler = ErrorHandler(critical = Actions.LOG_ERROR)
+    with dlisio.load(path, error_handler=errorhandler) as files:
+        assert len(files) == 2
+
+    with dlisio.load(path, error_handler=errorhandler, resync=True) as files:
+        assert len(files) == 3
+        assert files[2].fileheader is not None
+
 @pytest.fixture
 def create_very_broken_file(tmpdir, merge_files_oneLR, merge_files_manyLR):
     valid = os.path.join(str(tmpdir), 'valid.dlis')
@@ -267,3 +328,65 @@ def test_complex(create_very_broken_file, tmpdir):
         # retrieve whatever value from errored attribute
         errorhandler.critical = Actions.LOG_ERROR
         _ = obj['INVALID']
+
+@pytest.fixture
+def verify_checksums():
+    dlisio.set_verify_checksums(True)
+    try:
+        yield
+    finally:
+        dlisio.set_verify_checksums(False)
+
+def test_checksum_mismatch(verify_checksums, assert_log):
+    path = 'data/chap2/checksum-mismatch.dlis'
+    with dlisio.load(path) as (f, *_):
+        assert_log("checksum mismatch")
+        assert len(f.channels) == 2
+
+    handler = ErrorHandler(major=Actions.RAISE)
+    with pytest.raises(RuntimeError) as excinfo:
+        _ = dlisio.load(path, error_handler=handler)
+    assert "checksum mismatch" in str(excinfo.value)
+
+def test_checksum_not_verified_by_default(caplog):
+    path = 'data/chap2/checksum-mismatch.dlis'
+    with dlisio.load(path) as (f, *_):
+        assert len(f.channels) == 2
+    assert not any("checksum" in r.message for r in caplog.records)
+
+def test_checksum_mismatch_collected(verify_checksums):
+    path = 'data/chap2/checksum-mismatch.dlis'
+    errors = ErrorCollector()
+    with dlisio.load(path, error_handler=errors) as (f, *_):
+        assert len(f.channels) == 2
+
+    # the CHANNEL record is both indexed and extracted by load
+    assert len(errors) == 2
+    indexed, extracted = errors.problems()
+    assert indexed.severity == dlisio.core.error_severity.major
+    assert indexed.context == 'dl::findoffsets (checksum)'
+    assert extracted.context == 'extract (checksum)'
+    assert "checksum mismatch" in indexed.problem
+    assert indexed.count == 1
+    assert indexed.tells == extracted.tells
+
+    msgs = errors.messages()
+    assert len(msgs) == 2
+    assert "checksum mismatch" in msgs[0]
+    assert "Occurrences:  1" in msgs[0]
+
+def test_error_collector_raises_critical():
+    path = 'data/chap2/truncated-in-lrsh-vr-over.dlis'
+    errors = ErrorCollector()
+    with pytest.raises(RuntimeError) as excinfo:
+        _ = dlisio.load(path, error_handler=errors)
+    assert "File truncated in Logical Record Header" in str(excinfo.value)
+    assert len(errors) == 1
+
+    errors = ErrorCollector(raise_critical=False)
+    with dlisio.load(path, error_handler=errors):
+        pass
+    critical = [p for p in errors.problems()
+                if p.severity == dlisio.core.error_severity.critical]
+    assert len(critical) == 1
+    assert "File truncated in Logical Record Header" in critical[0].problem
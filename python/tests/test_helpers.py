@@ -85,3 +85,36 @@ def test_record_attributes():
 
     stream.close()
 
+
+@pytest.mark.parametrize('path', [
+    'data/chap2/3lr-in-vr-one-encrypted.dlis',
+    'data/chap2/1lr-in-2vrs.dlis',
+    'data/chap2/padbytes-large-as-seg-explict.dlis',
+])
+def test_record_view_matches_record(path):
+    errorhandler = dlisio.errors.ErrorHandler()
+    stream = core.open(path, zero=80)
+    stream = core.open_rp66(stream)
+    explicits, implicits, _ = core.findoffsets(stream, errorhandler)
+    tells = explicits + implicits
+    recs = core.extract(stream, tells, errorhandler)
+
+    with open(path, 'rb') as f:
+        data = f.read()
+    mem = core.memory_file(data, offset = 80)
+    views = core.extract(mem, tells, errorhandler)
+
+    assert len(views) == len(recs)
+    for rec, view in zip(recs, views):
+        assert view.type == rec.type
+        assert view.explicit == rec.explicit
+        assert view.encrypted == rec.encrypted
+        assert view.consistent == rec.consistent
+        assert bytes(memoryview(view)) == bytes(memoryview(rec))
+
+    # views keep the source alive
+    del data, mem
+    assert [bytes(memoryview(v)) for v in views] == \
+           [bytes(memoryview(r)) for r in recs]
+
+    stream.close()
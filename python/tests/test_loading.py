@@ -6,6 +6,7 @@ import pytest
 
 import shutil
 import os
+import numpy as np
 
 import dlisio
 
@@ -160,3 +161,134 @@ def test_invalid_attribute_in_load():
     path = 'data/chap4-7/invalid-date-in-origin.dlis'
     with dlisio.load(path):
         pass
+
+def test_cached_load_shares_index_and_metadata(tmpdir):
+    path = str(tmpdir.join('many-logical-files.dlis'))
+    shutil.copyfile('data/chap4-7/many-logical-files.dlis', path)
+    dlisio.cache.files.clear()
+
+    with dlisio.load(path, cache=True) as first:
+        with dlisio.load(path, cache=True) as second:
+            assert len(first) == len(second)
+            for f, g in zip(first, second):
+                assert f.object_pool is g.object_pool
+                assert f.fdata_index is g.fdata_index
+                assert f.file is not g.file
+                assert repr(f) == repr(g)
+                assert ([x.fingerprint for x in f.channels] ==
+                        [x.fingerprint for x in g.channels])
+
+        # closing the second load must not affect the first
+        fingerprints = [x.fingerprint for x in first[0].channels]
+        assert fingerprints == [x.fingerprint for x in second[0].channels]
+
+    with dlisio.load(path) as uncached:
+        assert uncached[0].object_pool is not first[0].object_pool
+
+def test_cached_load_reloads_changed_file(tmpdir):
+    path = str(tmpdir.join('file.dlis'))
+    shutil.copyfile('data/chap4-7/many-logical-files.dlis', path)
+    dlisio.cache.files.clear()
+
+    with dlisio.load(path, cache=True) as files:
+        before = files[0].object_pool
+
+    shutil.copyfile('data/206_05a-_3_DWL_DWL_WIRE_258276498.DLIS', path)
+    with dlisio.load(path, cache=True) as files:
+        assert files[0].object_pool is not before
+
+def test_file_cache_evicts_unused_files(tmpdir):
+    path = str(tmpdir.join('many-logical-files.dlis'))
+    shutil.copyfile('data/chap4-7/many-logical-files.dlis', path)
+    dlisio.cache.files.clear()
+
+    budget = dlisio.settings.file_cache_size
+    try:
+        dlisio.settings.file_cache_size = 0
+        with dlisio.load(path, cache=True) as files:
+            pool = files[0].object_pool
+        assert len(dlisio.cache.files.entries) == 0
+
+        with dlisio.load(path, cache=True) as files:
+            assert files[0].object_pool is not pool
+    finally:
+        dlisio.settings.file_cache_size = budget
+
+def assert_loads_like(source, path):
+    with dlisio.load(path) as expected, dlisio.load(source) as files:
+        assert len(files) == len(expected)
+        for f, g in zip(files, expected):
+            assert repr(f) == repr(g)
+            assert ([x.fingerprint for x in f.channels] ==
+                    [x.fingerprint for x in g.channels])
+            for x, y in zip(f.frames, g.frames):
+                np.testing.assert_array_equal(x.curves(), y.curves())
+
+@pytest.mark.parametrize('path', [
+    'data/chap4-7/many-logical-files.dlis',
+    'data/chap4-7/iflr/out-of-order-framenos-two-frames-multifdata.dlis',
+    'data/tif/templates/1.dlis',
+])
+def test_load_from_memory(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    assert_loads_like(data, path)
+    assert_loads_like(bytearray(data), path)
+    assert_loads_like(memoryview(data), path)
+
+def test_load_from_mmap():
+    import gc
+    import mmap
+    path = 'data/chap4-7/many-logical-files.dlis'
+    with open(path, 'rb') as f:
+        with mmap.mmap(f.fileno(), 0, access = mmap.ACCESS_READ) as m:
+            assert_loads_like(m, path)
+            # the mmap cannot be closed until the files are released
+            gc.collect()
+
+def test_in_memory_file_is_locked_while_open():
+    with open('data/chap4-7/many-logical-files.dlis', 'rb') as f:
+        data = bytearray(f.read())
+
+    files = dlisio.load(data)
+    with pytest.raises(BufferError):
+        data.extend(b'\x00')
+    _ = files[0].fileheader
+    files.close()
+
+def test_in_memory_file_cannot_be_cached():
+    with open('data/chap4-7/many-logical-files.dlis', 'rb') as f:
+        data = f.read()
+
+    with pytest.raises(ValueError):
+        _ = dlisio.load(data, cache=True)
+
+@pytest.mark.parametrize('path', [
+    'data/chap2/7K-file.dlis',
+    'data/chap4-7/many-logical-files.dlis',
+    'data/chap4-7/iflr/out-of-order-framenos-two-frames-multifdata.dlis',
+])
+@pytest.mark.parametrize('shards', [0, 2, 7])
+def test_load_with_index_shards(path, shards, monkeypatch):
+    def snapshot(files):
+        return [(repr(f),
+                 [x.fingerprint for x in f.channels],
+                 f.fdata_index,
+                 [x.curves() for x in f.frames])
+                for f in files]
+
+    with dlisio.load(path) as files:
+        expected = snapshot(files)
+
+    monkeypatch.setattr(dlisio.settings, 'index_shards', shards)
+    with dlisio.load(path) as files:
+        result = snapshot(files)
+
+    assert len(result) == len(expected)
+    for (r, c, i, curves), (er, ec, ei, ecurves) in zip(result, expected):
+        assert r == er
+        assert c == ec
+        assert i == ei
+        for x, y in zip(curves, ecurves):
+            np.testing.assert_array_equal(x, y)